@@ -0,0 +1,114 @@
+#pragma once
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <latch>
+#include <optional>
+#include <span>
+#include "./CpuFeatures.hpp"
+#include "./SudokuMatrix.hpp"
+#include "./WorkStealingPool.hpp"
+#include "./solvers/ISolver.hpp"
+#include "./solvers/SolveResult.hpp"
+
+struct BatchOptions
+{
+    std::uint64_t maxSteps = 10'000'000;
+    std::size_t chunkSize = 16;
+    // Puzzles still running when the deadline passes or the stop token is
+    // triggered stop with DeadlineExceeded or Cancelled, and the ones not
+    // started yet stop before their first step.
+    std::chrono::steady_clock::time_point deadline = NoDeadline;
+    std::stop_token stopToken{};
+    // If not empty, deadlines[i] also bounds puzzles[i], for callers that
+    // batch requests with deadlines of their own.
+    std::span<const std::chrono::steady_clock::time_point> deadlines{};
+    // If not empty, latencies[i] receives the time puzzles[i] took, in
+    // nanoseconds, solver setup included.
+    std::span<std::uint64_t> latencies{};
+};
+
+template <std::size_t N, template <std::size_t> class Solver>
+SUDOKU_MULTIVERSION inline SolveResult RunSolver(Solver<N> &solver, const SolveLimits &limits)
+{
+    return solver.Solve(limits);
+}
+
+// Every pool thread keeps one solver per instantiation alive between puzzles
+// and batches. Solvers exposing Reset() are reused in place.
+template <std::size_t N, template <std::size_t> class Solver>
+inline Solver<N> &AcquireThreadSolver(const SudokuMatrix<N> &puzzle)
+{
+    thread_local std::optional<Solver<N>> solver;
+    if constexpr (requires(Solver<N> &s) { s.Reset(puzzle); })
+    {
+        if (solver.has_value())
+        {
+            solver->Reset(puzzle);
+            return *solver;
+        }
+    }
+    return solver.emplace(puzzle);
+}
+
+// Solves every puzzle independently on the pool, writing the final board and
+// status of puzzles[i] to solutions[i] and statuses[i]. Blocks until the batch
+// is done, so it must not be called from a task of `pool`.
+template <std::size_t N, template <std::size_t> class Solver, typename std::enable_if<std::is_base_of<ISolver<N>, Solver<N>>::value>::type * = nullptr>
+void SolveBatch(WorkStealingPool &pool, std::span<const SudokuMatrix<N>> puzzles, std::span<SudokuMatrix<N>> solutions, std::span<SolveStatus> statuses, const BatchOptions &options = {})
+{
+    assert(!pool.IsWorkerThread());
+    assert(solutions.size() >= puzzles.size());
+    assert(statuses.size() >= puzzles.size());
+    assert(options.latencies.empty() || options.latencies.size() >= puzzles.size());
+    assert(options.deadlines.empty() || options.deadlines.size() >= puzzles.size());
+    if (puzzles.empty())
+    {
+        return;
+    }
+    const std::size_t chunkSize = std::max<std::size_t>(options.chunkSize, 1);
+    const std::size_t chunkCount = (puzzles.size() + chunkSize - 1) / chunkSize;
+    const SolveLimits limits{options.maxSteps, options.deadline, options.stopToken};
+    const std::span<const std::chrono::steady_clock::time_point> deadlines = options.deadlines;
+    const std::span<std::uint64_t> latencies = options.latencies;
+    std::latch done(static_cast<std::ptrdiff_t>(chunkCount));
+    for (std::size_t chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        const std::size_t begin = chunk * chunkSize;
+        const std::size_t end = std::min(begin + chunkSize, puzzles.size());
+        // Contiguous ranges of chunks start on the same worker; stealing evens out the rest.
+        const std::size_t worker = chunk * pool.Size() / chunkCount;
+        pool.Submit(worker, [=, &done]
+                    {
+                        for (std::size_t i = begin; i < end; ++i)
+                        {
+                            const auto start = latencies.empty() ? std::chrono::steady_clock::time_point{} : std::chrono::steady_clock::now();
+                            Solver<N> &solver = AcquireThreadSolver<N, Solver>(puzzles[i]);
+                            if (deadlines.empty())
+                            {
+                                statuses[i] = RunSolver<N, Solver>(solver, limits).status;
+                            }
+                            else
+                            {
+                                SolveLimits puzzleLimits = limits;
+                                puzzleLimits.deadline = std::min(limits.deadline, deadlines[i]);
+                                statuses[i] = RunSolver<N, Solver>(solver, puzzleLimits).status;
+                            }
+                            if (!latencies.empty())
+                            {
+                                latencies[i] = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+                            }
+                            solutions[i] = solver.GetBoard();
+                        }
+                        done.count_down(); });
+    }
+    done.wait();
+}
+
+template <std::size_t N, template <std::size_t> class Solver, typename std::enable_if<std::is_base_of<ISolver<N>, Solver<N>>::value>::type * = nullptr>
+std::vector<SolveStatus> SolveBatch(WorkStealingPool &pool, std::span<const SudokuMatrix<N>> puzzles, std::span<SudokuMatrix<N>> solutions, const BatchOptions &options = {})
+{
+    std::vector<SolveStatus> statuses(puzzles.size());
+    SolveBatch<N, Solver>(pool, puzzles, solutions, std::span<SolveStatus>(statuses), options);
+    return statuses;
+}
@@ -0,0 +1,265 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <immintrin.h>
+#include "./CpuFeatures.hpp"
+
+// Kernels over arrays of 64-bit words, in scalar, AVX2 and AVX-512 flavours.
+// ActiveBitKernels() picks the widest variant the CPU supports on first use.
+namespace BitKernels
+{
+    // Index of the lowest set bit, or count * 64 if every word is zero.
+    inline constexpr std::size_t FindFirstSetScalar(const std::uint64_t *words, std::size_t count) noexcept
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (words[i] != 0)
+            {
+                return i * 64 + static_cast<std::size_t>(std::countr_zero(words[i]));
+            }
+        }
+        return count * 64;
+    }
+
+    inline constexpr std::size_t PopCountScalar(const std::uint64_t *words, std::size_t count) noexcept
+    {
+        std::size_t result = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            result += static_cast<std::size_t>(std::popcount(words[i]));
+        }
+        return result;
+    }
+
+    SUDOKU_TARGET_AVX2 inline std::size_t FindFirstSetAvx2(const std::uint64_t *words, std::size_t count) noexcept
+    {
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + i));
+            if (_mm256_testz_si256(v, v) != 0)
+            {
+                continue;
+            }
+            const __m256i zero = _mm256_cmpeq_epi64(v, _mm256_setzero_si256());
+            const unsigned nonZero = ~static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(zero))) & 0xF;
+            const std::size_t word = i + static_cast<std::size_t>(std::countr_zero(nonZero));
+            return word * 64 + static_cast<std::size_t>(_tzcnt_u64(words[word]));
+        }
+        for (; i < count; ++i)
+        {
+            if (words[i] != 0)
+            {
+                return i * 64 + static_cast<std::size_t>(_tzcnt_u64(words[i]));
+            }
+        }
+        return count * 64;
+    }
+
+    // Nibble lookup popcount: per-byte counts from two shuffles, summed with SAD.
+    SUDOKU_TARGET_AVX2 inline std::size_t PopCountAvx2(const std::uint64_t *words, std::size_t count) noexcept
+    {
+        const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i lowNibbles = _mm256_set1_epi8(0x0F);
+        __m256i total = _mm256_setzero_si256();
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + i));
+            const __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, lowNibbles));
+            const __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), lowNibbles));
+            total = _mm256_add_epi64(total, _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256()));
+        }
+        std::size_t result = static_cast<std::size_t>(_mm256_extract_epi64(total, 0) + _mm256_extract_epi64(total, 1) +
+                                                      _mm256_extract_epi64(total, 2) + _mm256_extract_epi64(total, 3));
+        for (; i < count; ++i)
+        {
+            result += static_cast<std::size_t>(_mm_popcnt_u64(words[i]));
+        }
+        return result;
+    }
+
+    // Below eight words a masked 512-bit load loses to the AVX2 loop.
+    SUDOKU_TARGET_AVX512 inline std::size_t FindFirstSetAvx512(const std::uint64_t *words, std::size_t count) noexcept
+    {
+        if (count < 8)
+        {
+            return FindFirstSetAvx2(words, count);
+        }
+        for (std::size_t i = 0; i < count; i += 8)
+        {
+            const __mmask8 load = count - i >= 8 ? __mmask8(0xFF) : static_cast<__mmask8>((1u << (count - i)) - 1);
+            const __m512i v = _mm512_maskz_loadu_epi64(load, words + i);
+            const __mmask8 nonZero = _mm512_test_epi64_mask(v, v);
+            if (nonZero != 0)
+            {
+                const std::size_t word = i + static_cast<std::size_t>(std::countr_zero(static_cast<unsigned>(nonZero)));
+                return word * 64 + static_cast<std::size_t>(_tzcnt_u64(words[word]));
+            }
+        }
+        return count * 64;
+    }
+
+    SUDOKU_TARGET_AVX512 inline std::size_t PopCountAvx512(const std::uint64_t *words, std::size_t count) noexcept
+    {
+        if (count < 8)
+        {
+            return PopCountAvx2(words, count);
+        }
+        // Same nibble table as PopCountAvx2, in every 128-bit lane.
+        const long long lookupLow = 0x0302020102010100;
+        const long long lookupHigh = 0x0403030203020201;
+        const __m512i lookup = _mm512_set_epi64(lookupHigh, lookupLow, lookupHigh, lookupLow, lookupHigh, lookupLow, lookupHigh, lookupLow);
+        const __m512i lowNibbles = _mm512_set1_epi8(0x0F);
+        __m512i total = _mm512_setzero_si512();
+        for (std::size_t i = 0; i < count; i += 8)
+        {
+            const __mmask8 load = count - i >= 8 ? __mmask8(0xFF) : static_cast<__mmask8>((1u << (count - i)) - 1);
+            const __m512i v = _mm512_maskz_loadu_epi64(load, words + i);
+            const __m512i low = _mm512_shuffle_epi8(lookup, _mm512_and_si512(v, lowNibbles));
+            const __m512i high = _mm512_shuffle_epi8(lookup, _mm512_and_si512(_mm512_srli_epi16(v, 4), lowNibbles));
+            total = _mm512_add_epi64(total, _mm512_sad_epu8(_mm512_add_epi8(low, high), _mm512_setzero_si512()));
+        }
+        alignas(64) std::uint64_t lanes[8];
+        _mm512_store_si512(lanes, total);
+        return static_cast<std::size_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7]);
+    }
+
+    namespace Detail
+    {
+        // Lane i holds masks[i / Stride] for i < Count and zero above.
+        template <std::size_t Stride, std::size_t Count, std::size_t... Lanes>
+        SUDOKU_TARGET_AVX2 inline __m256i SpreadMasks16(const std::uint16_t *masks, std::index_sequence<Lanes...>) noexcept
+        {
+            return _mm256_setr_epi16(static_cast<short>(Lanes < Count ? masks[Lanes / Stride] : 0)...);
+        }
+    }
+
+    // Candidate masks of a whole board with 16-bit unit masks (box size 2 to
+    // 4), one row per vector: for every empty cell the values missing from
+    // its row, column and square, zero for filled cells. `units` holds the
+    // row, column and square masks in SudokuBits order and `counts`, if not
+    // null, receives the popcount of every mask.
+    template <std::size_t Box>
+    SUDOKU_TARGET_AVX2 inline void ComputeCandidates16Avx2(const std::uint16_t *units, const std::uint8_t *cells,
+                                                           std::uint16_t all, std::uint16_t *out, std::uint8_t *counts) noexcept
+    {
+        static_assert(Box >= 2 && Box <= 4);
+        constexpr std::size_t size = Box * Box;
+        constexpr auto lanes = std::make_index_sequence<16>{};
+        const __m256i columns = Detail::SpreadMasks16<1, size>(units + size, lanes);
+        const __m256i allValues = _mm256_set1_epi16(static_cast<short>(all));
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i lowNibbles = _mm256_set1_epi8(0x0F);
+        const __m256i ones = _mm256_set1_epi8(1);
+        for (std::size_t band = 0; band < Box; ++band)
+        {
+            const __m256i squares = Detail::SpreadMasks16<Box, size>(units + 2 * size + band * Box, lanes);
+            const __m256i bandUsed = _mm256_or_si256(columns, squares);
+            for (std::size_t row = band * Box; row < (band + 1) * Box; ++row)
+            {
+                const std::size_t base = row * size;
+                // Rows are loaded and stored at their exact width; a wider
+                // access would run past the last row.
+                __m128i rowCells;
+                if constexpr (size == 16)
+                {
+                    rowCells = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cells + base));
+                }
+                else if constexpr (size == 9)
+                {
+                    rowCells = _mm_insert_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(cells + base)), cells[base + 8], 8);
+                }
+                else
+                {
+                    std::uint32_t word;
+                    std::memcpy(&word, cells + base, sizeof(word));
+                    rowCells = _mm_cvtsi32_si128(static_cast<int>(word));
+                }
+                const __m256i empty = _mm256_cmpeq_epi16(_mm256_cvtepu8_epi16(rowCells), zero);
+                const __m256i used = _mm256_or_si256(bandUsed, _mm256_set1_epi16(static_cast<short>(units[row])));
+                const __m256i candidates = _mm256_and_si256(_mm256_andnot_si256(used, allValues), empty);
+                if constexpr (size == 16)
+                {
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + base), candidates);
+                }
+                else if constexpr (size == 9)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + base), _mm256_castsi256_si128(candidates));
+                    out[base + 8] = static_cast<std::uint16_t>(_mm256_extract_epi16(candidates, 8));
+                }
+                else
+                {
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(out + base), _mm256_castsi256_si128(candidates));
+                }
+                if (counts == nullptr)
+                {
+                    continue;
+                }
+                // Per-byte nibble lookup as in PopCountAvx2, then byte pairs summed into 16-bit lanes.
+                const __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(candidates, lowNibbles));
+                const __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(candidates, 4), lowNibbles));
+                const __m256i laneCounts = _mm256_maddubs_epi16(_mm256_add_epi8(low, high), ones);
+                const __m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(laneCounts), _mm256_extracti128_si256(laneCounts, 1));
+                if constexpr (size == 16)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(counts + base), packed);
+                }
+                else if constexpr (size == 9)
+                {
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(counts + base), packed);
+                    counts[base + 8] = static_cast<std::uint8_t>(_mm_extract_epi8(packed, 8));
+                }
+                else
+                {
+                    const std::uint32_t word = static_cast<std::uint32_t>(_mm_cvtsi128_si32(packed));
+                    std::memcpy(counts + base, &word, sizeof(word));
+                }
+            }
+        }
+    }
+
+    struct KernelTable
+    {
+        SimdLevel level;
+        std::size_t (*findFirstSet)(const std::uint64_t *, std::size_t) noexcept;
+        std::size_t (*popCount)(const std::uint64_t *, std::size_t) noexcept;
+    };
+
+    inline std::size_t FindFirstSetScalarKernel(const std::uint64_t *words, std::size_t count) noexcept
+    {
+        return FindFirstSetScalar(words, count);
+    }
+
+    inline std::size_t PopCountScalarKernel(const std::uint64_t *words, std::size_t count) noexcept
+    {
+        return PopCountScalar(words, count);
+    }
+
+    // The caller checks that the CPU supports `level`.
+    inline constexpr KernelTable GetKernels(SimdLevel level) noexcept
+    {
+        switch (level)
+        {
+        case SimdLevel::Avx512:
+            return {SimdLevel::Avx512, &FindFirstSetAvx512, &PopCountAvx512};
+        case SimdLevel::Avx2:
+            return {SimdLevel::Avx2, &FindFirstSetAvx2, &PopCountAvx2};
+        case SimdLevel::Scalar:
+            break;
+        }
+        return {SimdLevel::Scalar, &FindFirstSetScalarKernel, &PopCountScalarKernel};
+    }
+}
+
+inline const BitKernels::KernelTable &ActiveBitKernels() noexcept
+{
+    static const BitKernels::KernelTable kernels = BitKernels::GetKernels(GetSimdLevel());
+    return kernels;
+}
\ No newline at end of file
@@ -0,0 +1,250 @@
+#pragma once
+#include "./SudokuMatrix.hpp"
+
+// Candidate mask and count of every cell of a SudokuMatrix<N>, updated
+// incrementally through the peers of each changed cell. Empty cells sit in
+// one cell bitset per candidate count, so the cell with the fewest candidates
+// (MRV) is found without scanning the board; ties go to the lowest index.
+// The cache follows one board: change it through SetValue/RemoveValue below,
+// or call Reset after changing the board directly. Placements made with a
+// SudokuTrail record the peers they eliminated from, so RollbackTo undoes the
+// cache along with the board instead of a search keeping copies of it.
+template <std::size_t N>
+class CandidateCache
+{
+public:
+    using MaskType = UnitMask<N>;
+    using DataType = typename SudokuMatrix<N>::DataType;
+    static constexpr std::size_t Size = N * N;
+    static constexpr std::size_t CellCount = Size * Size;
+    // Cells sharing a row, column or square with a cell, the cell excluded.
+    static constexpr std::size_t PeerCount = 3 * Size - 2 * N - 1;
+    // Returned by GetMinCell when every cell is filled.
+    static constexpr std::size_t NoCell = CellCount;
+    using CellSet = FastBitset<CellCount>;
+
+private:
+    using Traits = UnitMaskTraits<N>;
+    using IndexType = std::conditional_t<(CellCount < std::numeric_limits<std::uint16_t>::max()), std::uint16_t, std::uint32_t>;
+
+    // Cells of a square outside a given cell's row and column, as offsets
+    // from the square's top-left cell, by the cell's position in the square.
+    // Row and column peers follow from the index alone.
+    static constexpr std::array<std::array<IndexType, (N - 1) * (N - 1)>, N * N> SquarePeerOffsets = []()
+    {
+        std::array<std::array<IndexType, (N - 1) * (N - 1)>, N * N> offsets{};
+        for (std::size_t row = 0; row < N; ++row)
+        {
+            for (std::size_t col = 0; col < N; ++col)
+            {
+                std::size_t count = 0;
+                for (std::size_t i = 0; i < N; ++i)
+                {
+                    for (std::size_t j = 0; j < N; ++j)
+                    {
+                        if (i != row && j != col)
+                        {
+                            offsets[row * N + col][count++] = static_cast<IndexType>(i * Size + j);
+                        }
+                    }
+                }
+            }
+        }
+        return offsets;
+    }();
+
+    std::array<MaskType, CellCount> m_candidates{};
+    std::array<DataType, CellCount> m_counts{};
+    // Bucket c holds the empty cells with exactly c candidates.
+    std::array<CellSet, Size + 1> m_buckets{};
+    std::size_t m_emptyCells = 0;
+    // Set by Reset when two givens share a value in a row, column or square.
+    bool m_conflict = false;
+
+    inline constexpr void Update(std::size_t cell, MaskType candidates, std::size_t count) noexcept
+    {
+        m_buckets[m_counts[cell]].reset(cell);
+        m_buckets[count].set(cell);
+        m_candidates[cell] = candidates;
+        m_counts[cell] = static_cast<DataType>(count);
+    }
+
+    // Cache side of SetValue, once the board holds `value` at `index`. Calls
+    // eliminated(peer) for each peer that loses the value.
+    template <class Eliminated>
+    inline constexpr std::size_t Fill(std::size_t index, DataType value, Eliminated &&eliminated)
+    {
+        m_buckets[m_counts[index]].reset(index);
+        m_candidates[index] = MaskType{};
+        m_counts[index] = 0;
+        m_emptyCells--;
+        // Filled peers have no candidates, so the bit test skips them too.
+        const std::size_t bit = value - 1;
+        std::size_t count = 0;
+        ForEachPeer(index, [&](std::size_t peer)
+                    {
+                        if (Traits::Test(m_candidates[peer], bit))
+                        {
+                            MaskType candidates = m_candidates[peer];
+                            Traits::Reset(candidates, bit);
+                            Update(peer, candidates, m_counts[peer] - 1u);
+                            eliminated(peer);
+                            count++;
+                        } });
+        return count;
+    }
+
+public:
+    constexpr CandidateCache() = default;
+    constexpr CandidateCache(const SudokuMatrix<N> &board) { Reset(board); }
+
+    inline constexpr void Reset(const SudokuMatrix<N> &board)
+    {
+        board.ComputeAllCandidates(m_candidates, m_counts);
+        for (CellSet &bucket : m_buckets)
+        {
+            bucket.reset();
+        }
+        m_emptyCells = 0;
+        for (std::size_t cell = 0; cell < CellCount; ++cell)
+        {
+            if (board.GetValue(cell) == 0)
+            {
+                m_buckets[m_counts[cell]].set(cell);
+                m_emptyCells++;
+            }
+        }
+        m_conflict = board.HasRepeatedValue();
+    }
+
+    // Places `value` in an empty cell and drops it from the peers' candidates.
+    // Returns how many peers had it.
+    inline constexpr std::size_t SetValue(SudokuMatrix<N> &board, std::size_t index, DataType value)
+    {
+        const std::size_t row = index / Size;
+        const std::size_t col = index % Size;
+        board.SetValue(row, col, index, SudokuMatrix<N>::SquareIndex(row, col), value);
+        return Fill(index, value, [](std::size_t) {});
+    }
+
+    // Same, with the board change and the peers it eliminated from recorded
+    // in `trail` for RollbackTo.
+    inline constexpr std::size_t SetValue(SudokuMatrix<N> &board, SudokuTrail<N> &trail, std::size_t index, DataType value)
+    {
+        const std::size_t row = index / Size;
+        const std::size_t col = index % Size;
+        trail.SetValue(board, row, col, index, SudokuMatrix<N>::SquareIndex(row, col), value);
+        return Fill(index, value, [&](std::size_t peer)
+                    { trail.RecordPeer(peer); });
+    }
+
+    // Undoes the placements into empty cells recorded in `trail` since
+    // `checkpoint`, on the board and in the cache. The value goes back to the
+    // recorded peers, and the emptied cell gets the candidates of the board's
+    // unit masks, which it had when the value was placed.
+    inline constexpr void RollbackTo(SudokuMatrix<N> &board, SudokuTrail<N> &trail, std::size_t checkpoint)
+    {
+        trail.RollbackTo(board, checkpoint, [&](std::size_t index, DataType value, std::span<const typename SudokuTrail<N>::IndexType> peers)
+                         {
+                             const MaskType bit = Traits::Bit(value - 1);
+                             for (const auto peer : peers)
+                             {
+                                 Update(peer, static_cast<MaskType>(m_candidates[peer] | bit), m_counts[peer] + 1u);
+                             }
+                             const MaskType candidates = board.GetPossibleValues(index / Size, index % Size).GetFlag();
+                             m_candidates[index] = candidates;
+                             m_counts[index] = static_cast<DataType>(Traits::Count(candidates));
+                             m_buckets[m_counts[index]].set(index);
+                             m_emptyCells++; });
+    }
+
+    // Empties a filled cell. Its value may come back to the peers, so they are
+    // recomputed from the board's unit masks.
+    inline constexpr void RemoveValue(SudokuMatrix<N> &board, std::size_t index)
+    {
+        const std::size_t row = index / Size;
+        const std::size_t col = index % Size;
+        board.RemoveValue(row, col, index, SudokuMatrix<N>::SquareIndex(row, col));
+        m_candidates[index] = board.GetPossibleValues(row, col).GetFlag();
+        m_counts[index] = static_cast<DataType>(Traits::Count(m_candidates[index]));
+        m_buckets[m_counts[index]].set(index);
+        m_emptyCells++;
+        ForEachPeer(index, [&](std::size_t peer)
+                    {
+                        if (board.GetValue(peer) == 0)
+                        {
+                            const MaskType candidates = board.GetPossibleValues(peer / Size, peer % Size).GetFlag();
+                            Update(peer, candidates, static_cast<std::size_t>(Traits::Count(candidates)));
+                        } });
+    }
+
+    inline constexpr const MaskType &GetCandidates(std::size_t index) const noexcept
+    {
+        return m_candidates[index];
+    }
+
+    inline constexpr std::size_t GetCount(std::size_t index) const noexcept
+    {
+        return m_counts[index];
+    }
+
+    inline constexpr std::size_t GetEmptyCount() const noexcept
+    {
+        return m_emptyCells;
+    }
+
+    // Whether the board given to Reset repeats a value in a unit, which no
+    // search can repair.
+    inline constexpr bool HasConflict() const noexcept
+    {
+        return m_conflict;
+    }
+
+    // Fewest candidates of any empty cell, or Size + 1 if there is none.
+    inline constexpr std::size_t GetMinCount() const noexcept
+    {
+        std::size_t count = 0;
+        while (count <= Size && m_buckets[count].none())
+        {
+            count++;
+        }
+        return count;
+    }
+
+    // Lowest-index empty cell with GetMinCount() candidates, or NoCell.
+    inline constexpr std::size_t GetMinCell() const noexcept
+    {
+        const std::size_t count = GetMinCount();
+        return count <= Size ? m_buckets[count].findLSB() : NoCell;
+    }
+
+    // Empty cells with exactly `count` candidates.
+    inline constexpr const CellSet &GetCells(std::size_t count) const noexcept
+    {
+        return m_buckets[count];
+    }
+
+    // Calls visit(peer) once for each of the PeerCount peers of `index`.
+    template <class Visitor>
+    static inline constexpr void ForEachPeer(std::size_t index, Visitor &&visit)
+    {
+        const std::size_t row = index / Size;
+        const std::size_t col = index % Size;
+        for (std::size_t k = 0; k < Size; ++k)
+        {
+            if (k != col)
+            {
+                visit(row * Size + k);
+            }
+            if (k != row)
+            {
+                visit(k * Size + col);
+            }
+        }
+        const std::size_t corner = (row / N) * N * Size + (col / N) * N;
+        for (const IndexType offset : SquarePeerOffsets[(row % N) * N + col % N])
+        {
+            visit(corner + offset);
+        }
+    }
+};
\ No newline at end of file
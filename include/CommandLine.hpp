@@ -0,0 +1,50 @@
+#pragma once
+#include <charconv>
+#include <optional>
+#include <string_view>
+#include <system_error>
+
+// Argument helpers of the command-line tools, which take "--name=value"
+// options and at most a few positional arguments.
+
+struct CommandLineOption
+{
+    std::string_view name;
+    // Empty if the argument has no '='.
+    std::string_view value;
+};
+
+inline constexpr CommandLineOption SplitOption(std::string_view argument) noexcept
+{
+    const std::size_t equals = argument.find('=');
+    if (equals == std::string_view::npos)
+    {
+        return {argument, {}};
+    }
+    return {argument.substr(0, equals), argument.substr(equals + 1)};
+}
+
+// The whole of `text` as a number, or std::nullopt.
+template <typename T>
+inline std::optional<T> ParseNumber(std::string_view text) noexcept
+{
+    T value{};
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{} || end != text.data() + text.size())
+    {
+        return std::nullopt;
+    }
+    return value;
+}
+
+inline bool HasArgument(int argc, char **argv, std::string_view argument) noexcept
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (argv[i] == argument)
+        {
+            return true;
+        }
+    }
+    return false;
+}
\ No newline at end of file
@@ -0,0 +1,165 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#endif
+
+// Functions using wider instructions than the build baseline are compiled for
+// their target with these macros and only called after checking the CPU.
+#if defined(__clang__)
+#define SUDOKU_TARGET_AVX2 __attribute__((target("avx2,bmi,bmi2,popcnt,lzcnt")))
+#define SUDOKU_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx2,bmi,bmi2,popcnt,lzcnt")))
+#define SUDOKU_BEGIN_TARGET_AVX2 _Pragma("clang attribute push(__attribute__((target(\"avx2,bmi,bmi2,popcnt,lzcnt\"))), apply_to = function)")
+#define SUDOKU_END_TARGET _Pragma("clang attribute pop")
+#elif defined(__GNUC__)
+#define SUDOKU_TARGET_AVX2 __attribute__((target("avx2,bmi,bmi2,popcnt,lzcnt")))
+#define SUDOKU_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx2,bmi,bmi2,popcnt,lzcnt")))
+#define SUDOKU_BEGIN_TARGET_AVX2 _Pragma("GCC push_options") _Pragma("GCC target(\"avx2,bmi,bmi2,popcnt,lzcnt\")")
+#define SUDOKU_END_TARGET _Pragma("GCC pop_options")
+#else
+// MSVC accepts every intrinsic regardless of /arch.
+#define SUDOKU_TARGET_AVX2
+#define SUDOKU_TARGET_AVX512
+#define SUDOKU_BEGIN_TARGET_AVX2
+#define SUDOKU_END_TARGET
+#endif
+
+// Hot loops built from inline solver code are cloned for AVX2-class CPUs and
+// the clone is picked by the loader (ifunc) at startup. Needs an ELF target;
+// define SUDOKU_NO_MULTIVERSIONING to opt out.
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__ELF__) && defined(__x86_64__) && !defined(SUDOKU_NO_MULTIVERSIONING)
+#define SUDOKU_MULTIVERSION __attribute__((target_clones("arch=haswell", "default")))
+#else
+#define SUDOKU_MULTIVERSION
+#endif
+
+enum class SimdLevel : std::uint8_t
+{
+    Scalar,
+    Avx2,
+    Avx512
+};
+
+struct CpuFeatures
+{
+    bool popcnt = false;
+    bool bmi1 = false;
+    bool bmi2 = false;
+    bool lzcnt = false;
+    // AVX2 together with every other extension SUDOKU_TARGET_AVX2 enables.
+    bool avx2 = false;
+    // AVX-512 foundation and byte/word instructions, with OS support for the
+    // wider register state.
+    bool avx512 = false;
+};
+
+inline CpuFeatures DetectCpuFeatures() noexcept
+{
+    CpuFeatures features;
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    features.popcnt = (info[2] & (1 << 23)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    const std::uint64_t xcr0 = osxsave ? _xgetbv(0) : 0;
+    const bool ymmState = (xcr0 & 0x6) == 0x6;
+    const bool zmmState = (xcr0 & 0xE6) == 0xE6;
+    __cpuid(info, 0x80000000);
+    if (static_cast<unsigned>(info[0]) >= 0x80000001u)
+    {
+        __cpuid(info, 0x80000001);
+        features.lzcnt = (info[2] & (1 << 5)) != 0;
+    }
+    if (maxLeaf >= 7)
+    {
+        __cpuidex(info, 7, 0);
+        features.bmi1 = (info[1] & (1 << 3)) != 0;
+        features.bmi2 = (info[1] & (1 << 8)) != 0;
+        features.avx2 = avx && ymmState && (info[1] & (1 << 5)) != 0 && features.bmi1 && features.bmi2 && features.popcnt && features.lzcnt;
+        features.avx512 = features.avx2 && zmmState && (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0;
+    }
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    // libgcc checks XCR0 before reporting AVX and AVX-512 as supported.
+    __builtin_cpu_init();
+    features.popcnt = __builtin_cpu_supports("popcnt");
+    features.bmi1 = __builtin_cpu_supports("bmi");
+    features.bmi2 = __builtin_cpu_supports("bmi2");
+    // LZCNT (ABM on AMD) is CPUID 0x80000001 ECX bit 5.
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    features.lzcnt = __get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx) && (ecx & (1u << 5)) != 0;
+    features.avx2 = __builtin_cpu_supports("avx2") && features.bmi1 && features.bmi2 && features.popcnt && features.lzcnt;
+    features.avx512 = features.avx2 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+    return features;
+}
+
+// Detected once per process.
+inline const CpuFeatures &GetCpuFeatures() noexcept
+{
+    static const CpuFeatures features = DetectCpuFeatures();
+    return features;
+}
+
+inline constexpr bool IsSupported(SimdLevel level, const CpuFeatures &features) noexcept
+{
+    switch (level)
+    {
+    case SimdLevel::Scalar:
+        return true;
+    case SimdLevel::Avx2:
+        return features.avx2;
+    case SimdLevel::Avx512:
+        return features.avx512;
+    }
+    return false;
+}
+
+inline constexpr std::string_view ToString(SimdLevel level) noexcept
+{
+    switch (level)
+    {
+    case SimdLevel::Scalar:
+        return "scalar";
+    case SimdLevel::Avx2:
+        return "avx2";
+    case SimdLevel::Avx512:
+        return "avx512";
+    }
+    return "unknown";
+}
+
+// Widest level the CPU supports. SUDOKU_SIMD=scalar|avx2|avx512 caps it,
+// e.g. to compare variants or rule out a kernel.
+inline SimdLevel DetectSimdLevel() noexcept
+{
+    const CpuFeatures &features = GetCpuFeatures();
+    SimdLevel level = features.avx512 ? SimdLevel::Avx512 : features.avx2 ? SimdLevel::Avx2
+                                                                          : SimdLevel::Scalar;
+#if defined(_MSC_VER)
+#pragma warning(suppress : 4996)
+#endif
+    if (const char *requested = std::getenv("SUDOKU_SIMD"))
+    {
+        for (SimdLevel cap : {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512})
+        {
+            if (ToString(cap) == requested && cap < level)
+            {
+                level = cap;
+            }
+        }
+    }
+    return level;
+}
+
+inline SimdLevel GetSimdLevel() noexcept
+{
+    static const SimdLevel level = DetectSimdLevel();
+    return level;
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// HDR-style histogram of non-negative integer samples (nanoseconds, say).
+// Values below 128 get a bucket each; above that every power of two is split
+// into 64 linear buckets, so any value is reported within 1/64 (1.6%) of what
+// was recorded, from one nanosecond to the full 64-bit range, in 30 KB.
+// Recording is a bit scan and an increment.
+class LatencyHistogram
+{
+public:
+    static constexpr std::size_t SubBucketBits = 7;
+    static constexpr std::size_t SubBucketCount = std::size_t{1} << SubBucketBits;
+    static constexpr std::size_t SubBucketHalf = SubBucketCount / 2;
+    static constexpr std::size_t BucketCount = SubBucketCount + (64 - SubBucketBits) * SubBucketHalf;
+
+private:
+    std::vector<std::uint64_t> m_counts;
+    std::uint64_t m_total = 0;
+    std::uint64_t m_min = std::numeric_limits<std::uint64_t>::max();
+    std::uint64_t m_max = 0;
+    // Sum of the recorded values, for the mean; a double never overflows.
+    double m_sum = 0;
+
+public:
+    LatencyHistogram() : m_counts(BucketCount, 0) {}
+
+    static inline constexpr std::size_t BucketIndex(std::uint64_t value) noexcept
+    {
+        if (value < SubBucketCount)
+        {
+            return static_cast<std::size_t>(value);
+        }
+        const std::size_t shift = static_cast<std::size_t>(std::bit_width(value)) - SubBucketBits;
+        return SubBucketCount + (shift - 1) * SubBucketHalf + static_cast<std::size_t>(value >> shift) - SubBucketHalf;
+    }
+
+    // Highest value that lands in `index`.
+    static inline constexpr std::uint64_t BucketUpperBound(std::size_t index) noexcept
+    {
+        if (index < SubBucketCount)
+        {
+            return index;
+        }
+        const std::size_t shift = (index - SubBucketCount) / SubBucketHalf + 1;
+        const std::uint64_t sub = (index - SubBucketCount) % SubBucketHalf + SubBucketHalf;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    inline void Record(std::uint64_t value) noexcept
+    {
+        m_counts[BucketIndex(value)]++;
+        m_total++;
+        m_min = std::min(m_min, value);
+        m_max = std::max(m_max, value);
+        m_sum += static_cast<double>(value);
+    }
+
+    inline void Merge(const LatencyHistogram &other) noexcept
+    {
+        for (std::size_t i = 0; i < BucketCount; ++i)
+        {
+            m_counts[i] += other.m_counts[i];
+        }
+        m_total += other.m_total;
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+        m_sum += other.m_sum;
+    }
+
+    inline void Reset() noexcept
+    {
+        std::fill(m_counts.begin(), m_counts.end(), 0);
+        m_total = 0;
+        m_min = std::numeric_limits<std::uint64_t>::max();
+        m_max = 0;
+        m_sum = 0;
+    }
+
+    // Smallest recorded value (up to the bucket precision) that at least
+    // `percentile` percent of the samples do not exceed. 0 when empty.
+    inline std::uint64_t ValueAtPercentile(double percentile) const noexcept
+    {
+        if (m_total == 0)
+        {
+            return 0;
+        }
+        const double clamped = std::clamp(percentile, 0.0, 100.0);
+        const std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(clamped / 100.0 * static_cast<double>(m_total) + 0.5));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < BucketCount; ++i)
+        {
+            seen += m_counts[i];
+            if (seen >= rank)
+            {
+                return std::clamp(BucketUpperBound(i), m_min, m_max);
+            }
+        }
+        return m_max;
+    }
+
+    inline std::uint64_t GetCount() const noexcept { return m_total; }
+    inline std::uint64_t GetMin() const noexcept { return m_total == 0 ? 0 : m_min; }
+    inline std::uint64_t GetMax() const noexcept { return m_max; }
+    inline double GetMean() const noexcept { return m_total == 0 ? 0.0 : m_sum / static_cast<double>(m_total); }
+};
\ No newline at end of file
@@ -0,0 +1,140 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <utility>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only view of a whole file mapped into memory, so a parser reads the
+// page cache in place instead of copying it through a stream buffer. The
+// mapping is hinted as sequential and lives as long as the object.
+class MappedFile
+{
+    const char *m_data = nullptr;
+    std::size_t m_size = 0;
+
+    MappedFile(const char *data, std::size_t size) : m_data(data), m_size(size) {}
+
+    inline void Release() noexcept
+    {
+        if (m_data == nullptr)
+        {
+            return;
+        }
+#if defined(_WIN32)
+        UnmapViewOfFile(m_data);
+#else
+        munmap(const_cast<char *>(m_data), m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)) {}
+    MappedFile &operator=(MappedFile &&other) noexcept
+    {
+        if (this != &other)
+        {
+            Release();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+        }
+        return *this;
+    }
+    ~MappedFile() { Release(); }
+
+    // std::nullopt if the file cannot be opened or mapped. An empty file maps
+    // to an empty view.
+    static std::optional<MappedFile> Open(const std::filesystem::path &path)
+    {
+#if defined(_WIN32)
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return std::nullopt;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size))
+        {
+            CloseHandle(file);
+            return std::nullopt;
+        }
+        if (size.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return MappedFile{};
+        }
+        // The view keeps the mapping and the file open once both handles are closed.
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr)
+        {
+            return std::nullopt;
+        }
+        const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (view == nullptr)
+        {
+            return std::nullopt;
+        }
+        return MappedFile{static_cast<const char *>(view), static_cast<std::size_t>(size.QuadPart)};
+#else
+        const int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0)
+        {
+            return std::nullopt;
+        }
+        struct stat status;
+        if (fstat(file, &status) != 0 || !S_ISREG(status.st_mode))
+        {
+            close(file);
+            return std::nullopt;
+        }
+        const std::size_t size = static_cast<std::size_t>(status.st_size);
+        if (size == 0)
+        {
+            close(file);
+            return MappedFile{};
+        }
+        void *view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+        // The mapping keeps its own reference to the file.
+        close(file);
+        if (view == MAP_FAILED)
+        {
+            return std::nullopt;
+        }
+        madvise(view, size, MADV_SEQUENTIAL);
+        return MappedFile{static_cast<const char *>(view), size};
+#endif
+    }
+
+    inline std::string_view GetView() const noexcept
+    {
+        return {m_data, m_size};
+    }
+
+    inline std::size_t GetSize() const noexcept
+    {
+        return m_size;
+    }
+};
\ No newline at end of file
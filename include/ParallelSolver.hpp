@@ -0,0 +1,158 @@
+#pragma once
+#include <cassert>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <vector>
+#include "./BatchSolver.hpp"
+
+struct ParallelOptions
+{
+    // Step budget of every subtree.
+    std::uint64_t maxSteps = 10'000'000;
+    // The tree is split until there are this many subtrees per pool thread...
+    std::size_t subtreesPerThread = 4;
+    // ...or this many cells have been branched on.
+    std::size_t maxSplitDepth = 4;
+    // Steps every subtree runs in the first round; later rounds double it.
+    std::uint64_t initialSliceSteps = 4096;
+    // Steps between two checks of the cancellation flag.
+    std::uint64_t cancelCheckInterval = 1024;
+};
+
+// Branches on the empty cell with the fewest candidates (MRV), one child board
+// per candidate. Returns false if the board has no empty cell.
+template <std::size_t N>
+inline bool SplitOnBestCell(const SudokuMatrix<N> &board, std::vector<SudokuMatrix<N>> &children)
+{
+    constexpr std::size_t cellCount = N * N * N * N;
+    std::array<typename SudokuMatrix<N>::MaskType, cellCount> candidates;
+    std::array<typename SudokuMatrix<N>::DataType, cellCount> counts;
+    board.ComputeAllCandidates(candidates, counts);
+    std::size_t best = cellCount;
+    std::size_t minCount = std::numeric_limits<std::size_t>::max();
+    for (std::size_t index = 0; index < cellCount && minCount != 0; ++index)
+    {
+        if (board.GetValue(index) != 0 || counts[index] >= minCount)
+        {
+            continue;
+        }
+        minCount = counts[index];
+        best = index;
+    }
+    if (best == cellCount)
+    {
+        return false;
+    }
+    const std::size_t bestRow = best / (N * N);
+    const std::size_t bestCol = best % (N * N);
+    for (auto value : BitSetIterator<N>{candidates[best]})
+    {
+        SudokuMatrix<N> &child = children.emplace_back(board);
+        child.SetValue(bestRow, bestCol, value);
+    }
+    return true;
+}
+
+// Solves one puzzle by splitting its search tree at shallow depth and running
+// the subtrees on the pool. The first subtree to find a solution cancels the
+// others, so `solution` is any solution of the puzzle, not necessarily the one
+// a sequential search would return. Blocks on the pool between rounds, so it
+// must not be called from a task of `pool`.
+template <std::size_t N, template <std::size_t> class Solver, typename std::enable_if<std::is_base_of<ISolver<N>, Solver<N>>::value>::type * = nullptr>
+SolveStatus SolveParallel(WorkStealingPool &pool, const SudokuMatrix<N> &puzzle, SudokuMatrix<N> &solution, const ParallelOptions &options = {})
+{
+    assert(!pool.IsWorkerThread());
+    const std::size_t targetSubtrees = pool.Size() * std::max<std::size_t>(options.subtreesPerThread, 1);
+    std::vector<SudokuMatrix<N>> subtrees{puzzle};
+    std::vector<SudokuMatrix<N>> next;
+    for (std::size_t depth = 0; depth < options.maxSplitDepth && subtrees.size() < targetSubtrees; ++depth)
+    {
+        next.clear();
+        bool split = false;
+        for (const SudokuMatrix<N> &board : subtrees)
+        {
+            if (!SplitOnBestCell<N>(board, next))
+            {
+                next.push_back(board);
+                continue;
+            }
+            split = true;
+        }
+        subtrees.swap(next);
+        if (!split || subtrees.empty())
+        {
+            break;
+        }
+    }
+    if (subtrees.empty())
+    {
+        // Some empty cell has no candidate.
+        solution = puzzle;
+        return SolveStatus::Unsolvable;
+    }
+
+    // Subtrees run in rounds with a step slice that doubles every round, so a
+    // single huge dead-end subtree cannot hold a worker while the others wait.
+    const std::size_t subtreeCount = subtrees.size();
+    std::vector<std::unique_ptr<Solver<N>>> solvers(subtreeCount);
+    std::vector<SolveStatus> statuses(subtreeCount, SolveStatus::BudgetExhausted);
+    std::vector<std::uint64_t> steps(subtreeCount, 0);
+    std::vector<std::size_t> open;
+    std::stop_source stopSource;
+    std::once_flag found;
+    std::uint64_t slice = std::max<std::uint64_t>(options.initialSliceSteps, 1);
+    while (!stopSource.stop_requested())
+    {
+        open.clear();
+        for (std::size_t i = 0; i < subtreeCount; ++i)
+        {
+            if (statuses[i] == SolveStatus::BudgetExhausted && steps[i] < options.maxSteps)
+            {
+                open.push_back(i);
+            }
+        }
+        if (open.empty())
+        {
+            break;
+        }
+        std::latch done(static_cast<std::ptrdiff_t>(open.size()));
+        for (std::size_t k = 0; k < open.size(); ++k)
+        {
+            // Neighbouring subtrees start on the same worker; idle workers steal the rest.
+            const std::size_t worker = k * pool.Size() / open.size();
+            pool.Submit(worker, [&, i = open[k]]
+                        {
+                            if (!stopSource.stop_requested())
+                            {
+                                if (!solvers[i])
+                                {
+                                    solvers[i] = std::make_unique<Solver<N>>(subtrees[i]);
+                                }
+                                const SolveLimits limits{std::min(slice, options.maxSteps - steps[i]), NoDeadline, stopSource.get_token(), options.cancelCheckInterval};
+                                const SolveResult result = RunSolver<N, Solver>(*solvers[i], limits);
+                                statuses[i] = result.status;
+                                steps[i] += result.steps;
+                                if (statuses[i] == SolveStatus::Solved)
+                                {
+                                    std::call_once(found, [&]
+                                                   {
+                                                       solution = solvers[i]->GetBoard();
+                                                       stopSource.request_stop(); });
+                                }
+                            }
+                            done.count_down(); });
+        }
+        done.wait();
+        slice *= 2;
+    }
+    if (stopSource.stop_requested())
+    {
+        return SolveStatus::Solved;
+    }
+    solution = puzzle;
+    const bool exhausted = std::ranges::any_of(statuses, [](SolveStatus status)
+                                               { return status == SolveStatus::BudgetExhausted; });
+    return exhausted ? SolveStatus::BudgetExhausted : SolveStatus::Unsolvable;
+}
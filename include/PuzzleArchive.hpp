@@ -0,0 +1,342 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "./MappedFile.hpp"
+#include "./SudokuMatrix.hpp"
+
+// Packed puzzle archives: a 32-byte little-endian header followed by
+// fixed-size records, so record i sits at a known offset and a mapped file is
+// read in place.
+//
+//   0  char[4]  magic "SDKP"
+//   4  u16      version (1)
+//   6  u16      box size N
+//   8  u32      flags: bit 0 set if every record holds a solution after the puzzle
+//  12  u32      record size in bytes
+//  16  u64      record count
+//  24  u64      reserved, zero
+//
+// A board takes ceil(log2(N*N + 1)) bits per cell, the first cell in the
+// lowest bits of the first byte, and is padded to a whole byte: 41 bytes for
+// 9x9 and 391 for 25x25, against 82 and 626 as text lines.
+namespace PuzzleArchiveFormat
+{
+    inline constexpr std::array<char, 4> Magic = {'S', 'D', 'K', 'P'};
+    inline constexpr std::uint16_t Version = 1;
+    inline constexpr std::size_t HeaderSize = 32;
+    inline constexpr std::uint32_t HasSolutions = 1;
+
+    template <class T>
+    inline constexpr void Store(std::uint8_t *out, T value) noexcept
+    {
+        for (std::size_t i = 0; i < sizeof(T); ++i)
+        {
+            out[i] = static_cast<std::uint8_t>(static_cast<std::uint64_t>(value) >> (8 * i));
+        }
+    }
+
+    template <class T>
+    inline constexpr T Load(const std::uint8_t *in) noexcept
+    {
+        std::uint64_t value = 0;
+        for (std::size_t i = 0; i < sizeof(T); ++i)
+        {
+            value |= static_cast<std::uint64_t>(in[i]) << (8 * i);
+        }
+        return static_cast<T>(value);
+    }
+}
+
+template <std::size_t N>
+struct PackedBoard
+{
+    static constexpr std::size_t CellCount = N * N * N * N;
+    static constexpr std::size_t BitsPerCell = static_cast<std::size_t>(std::bit_width(N * N));
+    static constexpr std::size_t Bytes = (CellCount * BitsPerCell + 7) / 8;
+};
+
+template <std::size_t N>
+inline constexpr void PackBoard(const SudokuMatrix<N> &board, std::uint8_t *out) noexcept
+{
+    using Packed = PackedBoard<N>;
+    const auto &cells = board.GetData();
+    if constexpr (Packed::BitsPerCell == 4)
+    {
+        for (std::size_t i = 0; i + 1 < Packed::CellCount; i += 2)
+        {
+            out[i / 2] = static_cast<std::uint8_t>(cells[i] | (cells[i + 1] << 4));
+        }
+        if constexpr (Packed::CellCount % 2 != 0)
+        {
+            out[Packed::Bytes - 1] = static_cast<std::uint8_t>(cells[Packed::CellCount - 1]);
+        }
+    }
+    else
+    {
+        std::uint64_t pending = 0;
+        std::size_t pendingBits = 0;
+        for (const auto value : cells)
+        {
+            pending |= static_cast<std::uint64_t>(value) << pendingBits;
+            pendingBits += Packed::BitsPerCell;
+            while (pendingBits >= 8)
+            {
+                *out++ = static_cast<std::uint8_t>(pending);
+                pending >>= 8;
+                pendingBits -= 8;
+            }
+        }
+        if (pendingBits != 0)
+        {
+            *out = static_cast<std::uint8_t>(pending);
+        }
+    }
+}
+
+// std::nullopt if a cell holds a value above N*N.
+template <std::size_t N>
+inline constexpr std::optional<SudokuMatrix<N>> UnpackBoard(const std::uint8_t *in) noexcept
+{
+    using Packed = PackedBoard<N>;
+    using DataType = typename SudokuMatrix<N>::DataType;
+    std::array<DataType, Packed::CellCount> cells{};
+    if constexpr (Packed::BitsPerCell == 4)
+    {
+        for (std::size_t i = 0; i + 1 < Packed::CellCount; i += 2)
+        {
+            cells[i] = static_cast<DataType>(in[i / 2] & 0xF);
+            cells[i + 1] = static_cast<DataType>(in[i / 2] >> 4);
+        }
+        if constexpr (Packed::CellCount % 2 != 0)
+        {
+            cells[Packed::CellCount - 1] = static_cast<DataType>(in[Packed::Bytes - 1] & 0xF);
+        }
+    }
+    else
+    {
+        constexpr std::uint64_t cellMask = (std::uint64_t{1} << Packed::BitsPerCell) - 1;
+        std::uint64_t pending = 0;
+        std::size_t pendingBits = 0;
+        for (auto &value : cells)
+        {
+            while (pendingBits < Packed::BitsPerCell)
+            {
+                pending |= static_cast<std::uint64_t>(*in++) << pendingBits;
+                pendingBits += 8;
+            }
+            value = static_cast<DataType>(pending & cellMask);
+            pending >>= Packed::BitsPerCell;
+            pendingBits -= Packed::BitsPerCell;
+        }
+    }
+    // One pass over all cells instead of a branch per cell.
+    DataType largest = 0;
+    for (const DataType value : cells)
+    {
+        largest = value > largest ? value : largest;
+    }
+    if (largest > N * N)
+    {
+        return std::nullopt;
+    }
+    return SudokuMatrix<N>{std::move(cells)};
+}
+
+// Packs boards.size() boards back to back into `out`, which holds at least
+// boards.size() * PackedBoard<N>::Bytes bytes.
+template <std::size_t N>
+inline void PackBoards(std::span<const SudokuMatrix<N>> boards, std::uint8_t *out) noexcept
+{
+    for (const SudokuMatrix<N> &board : boards)
+    {
+        PackBoard<N>(board, out);
+        out += PackedBoard<N>::Bytes;
+    }
+}
+
+// Unpacks `count` boards packed back to back. std::nullopt if one is invalid.
+template <std::size_t N>
+inline std::optional<std::vector<SudokuMatrix<N>>> UnpackBoards(const std::uint8_t *in, std::size_t count)
+{
+    std::vector<SudokuMatrix<N>> boards;
+    boards.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto board = UnpackBoard<N>(in + i * PackedBoard<N>::Bytes);
+        if (!board.has_value())
+        {
+            return std::nullopt;
+        }
+        boards.push_back(std::move(*board));
+    }
+    return boards;
+}
+
+// Writes an archive of `puzzles`, each followed by its solution when
+// `solutions` is not empty, in which case it has one board per puzzle.
+// Returns false if the stream failed.
+template <std::size_t N>
+inline bool WritePuzzleArchive(std::ostream &output, std::span<const SudokuMatrix<N>> puzzles, std::span<const SudokuMatrix<N>> solutions = {})
+{
+    namespace Format = PuzzleArchiveFormat;
+    assert(solutions.empty() || solutions.size() == puzzles.size());
+    const bool withSolutions = !solutions.empty();
+    const std::size_t recordSize = PackedBoard<N>::Bytes * (withSolutions ? 2 : 1);
+    std::array<std::uint8_t, Format::HeaderSize> header{};
+    std::memcpy(header.data(), Format::Magic.data(), Format::Magic.size());
+    Format::Store<std::uint16_t>(header.data() + 4, Format::Version);
+    Format::Store<std::uint16_t>(header.data() + 6, static_cast<std::uint16_t>(N));
+    Format::Store<std::uint32_t>(header.data() + 8, withSolutions ? Format::HasSolutions : 0);
+    Format::Store<std::uint32_t>(header.data() + 12, static_cast<std::uint32_t>(recordSize));
+    Format::Store<std::uint64_t>(header.data() + 16, static_cast<std::uint64_t>(puzzles.size()));
+    output.write(reinterpret_cast<const char *>(header.data()), static_cast<std::streamsize>(header.size()));
+    // Records go out a few thousand at a time.
+    constexpr std::size_t batch = 4096;
+    std::vector<std::uint8_t> records(std::min(puzzles.size(), batch) * recordSize);
+    for (std::size_t begin = 0; begin < puzzles.size(); begin += batch)
+    {
+        const std::size_t end = std::min(begin + batch, puzzles.size());
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            std::uint8_t *record = records.data() + (i - begin) * recordSize;
+            PackBoard<N>(puzzles[i], record);
+            if (withSolutions)
+            {
+                PackBoard<N>(solutions[i], record + PackedBoard<N>::Bytes);
+            }
+        }
+        output.write(reinterpret_cast<const char *>(records.data()), static_cast<std::streamsize>((end - begin) * recordSize));
+    }
+    return static_cast<bool>(output);
+}
+
+template <std::size_t N>
+inline bool SavePuzzleArchive(const std::filesystem::path &path, std::span<const SudokuMatrix<N>> puzzles, std::span<const SudokuMatrix<N>> solutions = {})
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    return file && WritePuzzleArchive<N>(file, puzzles, solutions) && file.flush();
+}
+
+// Random access to the records of an archive, either mapped from a file it
+// owns or over bytes the caller keeps alive.
+template <std::size_t N>
+class PuzzleArchive
+{
+    MappedFile m_file;
+    const std::uint8_t *m_records = nullptr;
+    std::size_t m_count = 0;
+    std::size_t m_recordSize = 0;
+    bool m_hasSolutions = false;
+
+public:
+    PuzzleArchive() = default;
+
+    // std::nullopt unless `bytes` hold a version 1 archive of N boxes with
+    // every record it announces.
+    static std::optional<PuzzleArchive> Parse(std::string_view bytes)
+    {
+        namespace Format = PuzzleArchiveFormat;
+        if (bytes.size() < Format::HeaderSize || std::memcmp(bytes.data(), Format::Magic.data(), Format::Magic.size()) != 0)
+        {
+            return std::nullopt;
+        }
+        const auto *header = reinterpret_cast<const std::uint8_t *>(bytes.data());
+        const std::uint32_t flags = Format::Load<std::uint32_t>(header + 8);
+        const bool hasSolutions = (flags & Format::HasSolutions) != 0;
+        const std::uint64_t count = Format::Load<std::uint64_t>(header + 16);
+        const std::size_t recordSize = PackedBoard<N>::Bytes * (hasSolutions ? 2 : 1);
+        if (Format::Load<std::uint16_t>(header + 4) != Format::Version || Format::Load<std::uint16_t>(header + 6) != N ||
+            (flags & ~Format::HasSolutions) != 0 || Format::Load<std::uint32_t>(header + 12) != recordSize ||
+            count > (bytes.size() - Format::HeaderSize) / recordSize)
+        {
+            return std::nullopt;
+        }
+        PuzzleArchive archive;
+        archive.m_records = header + Format::HeaderSize;
+        archive.m_count = static_cast<std::size_t>(count);
+        archive.m_recordSize = recordSize;
+        archive.m_hasSolutions = hasSolutions;
+        return archive;
+    }
+
+    static std::optional<PuzzleArchive> Open(const std::filesystem::path &path)
+    {
+        std::optional<MappedFile> file = MappedFile::Open(path);
+        if (!file.has_value())
+        {
+            return std::nullopt;
+        }
+        std::optional<PuzzleArchive> archive = Parse(file->GetView());
+        if (archive.has_value())
+        {
+            // The mapping keeps its address when moved.
+            archive->m_file = std::move(*file);
+        }
+        return archive;
+    }
+
+    inline std::size_t GetCount() const noexcept
+    {
+        return m_count;
+    }
+
+    inline bool HasSolutions() const noexcept
+    {
+        return m_hasSolutions;
+    }
+
+    inline std::optional<SudokuMatrix<N>> GetPuzzle(std::size_t index) const noexcept
+    {
+        assert(index < m_count);
+        return UnpackBoard<N>(m_records + index * m_recordSize);
+    }
+
+    inline std::optional<SudokuMatrix<N>> GetSolution(std::size_t index) const noexcept
+    {
+        assert(m_hasSolutions && index < m_count);
+        return UnpackBoard<N>(m_records + index * m_recordSize + PackedBoard<N>::Bytes);
+    }
+
+    // Every puzzle, or std::nullopt if one is invalid.
+    inline std::optional<std::vector<SudokuMatrix<N>>> GetPuzzles() const
+    {
+        if (!m_hasSolutions)
+        {
+            return UnpackBoards<N>(m_records, m_count);
+        }
+        std::vector<SudokuMatrix<N>> puzzles;
+        puzzles.reserve(m_count);
+        for (std::size_t i = 0; i < m_count; ++i)
+        {
+            auto puzzle = GetPuzzle(i);
+            if (!puzzle.has_value())
+            {
+                return std::nullopt;
+            }
+            puzzles.push_back(std::move(*puzzle));
+        }
+        return puzzles;
+    }
+};
+
+template <std::size_t N>
+inline std::optional<std::vector<SudokuMatrix<N>>> LoadPuzzleArchive(const std::filesystem::path &path)
+{
+    const auto archive = PuzzleArchive<N>::Open(path);
+    if (!archive.has_value())
+    {
+        return std::nullopt;
+    }
+    return archive->GetPuzzles();
+}
\ No newline at end of file
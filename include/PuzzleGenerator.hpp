@@ -0,0 +1,257 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <latch>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <string_view>
+#include <vector>
+#include <pcg_random.hpp>
+#include "./CandidateCache.hpp"
+#include "./SudokuMatrix.hpp"
+#include "./WorkStealingPool.hpp"
+#include "./solvers/PropagationSolver.hpp"
+
+// Difficulty of a puzzle by how much search PropagationSolver needs after
+// singles: none, a few guesses, or a real search.
+enum class PuzzleDifficulty
+{
+    Singles,
+    Guesses,
+    Search
+};
+
+inline constexpr std::string_view DifficultyName(PuzzleDifficulty difficulty) noexcept
+{
+    switch (difficulty)
+    {
+    case PuzzleDifficulty::Singles:
+        return "singles";
+    case PuzzleDifficulty::Guesses:
+        return "guesses";
+    default:
+        return "search";
+    }
+}
+
+// std::nullopt if the puzzle has no solution or takes more than `maxSteps`.
+template <std::size_t N>
+inline std::optional<PuzzleDifficulty> RateDifficulty(const SudokuMatrix<N> &puzzle, std::uint64_t maxSteps = 10'000'000)
+{
+    PropagationSolver<N> solver{puzzle};
+    const SolveResult result = solver.Solve(maxSteps);
+    if (result.status != SolveStatus::Solved)
+    {
+        return std::nullopt;
+    }
+    if (result.steps == 0)
+    {
+        return PuzzleDifficulty::Singles;
+    }
+    return result.steps <= 16 ? PuzzleDifficulty::Guesses : PuzzleDifficulty::Search;
+}
+
+struct GeneratorOptions
+{
+    // Clue removal stops at this many clues. With the default of 0 it goes
+    // through every cell, which leaves a minimal puzzle: one where no clue
+    // can be removed without losing uniqueness.
+    std::size_t targetClues = 0;
+    // Step budget of each uniqueness check. A check that runs out keeps its
+    // clue, so it costs clues on the larger boards but never uniqueness.
+    std::uint64_t maxCheckSteps = 1'000;
+    // Grids whose puzzle rates differently are thrown away, up to maxAttempts.
+    std::optional<PuzzleDifficulty> difficulty;
+    std::size_t maxAttempts = 1000;
+};
+
+// Dead ends, per cell, after which CreateRandomGrid starts over.
+inline constexpr std::size_t RandomGridRestartBacktracks = 4;
+
+// A randomized MRV search over the empty board: every choice takes a
+// random candidate of the cell with the fewest, and a dead end undoes the
+// newest choice and takes another of its candidates. Bad early choices can
+// trap the larger boards in a long search, so it restarts from scratch after
+// RandomGridRestartBacktracks dead ends per cell.
+template <std::size_t N>
+inline SudokuMatrix<N> CreateRandomGrid(pcg64 &rng)
+{
+    using DataType = typename SudokuMatrix<N>::DataType;
+    using MaskType = UnitMask<N>;
+    using Traits = UnitMaskTraits<N>;
+    struct Choice
+    {
+        std::size_t cell;
+        MaskType remaining;
+    };
+
+    SudokuMatrix<N> grid{};
+    CandidateCache<N> cache{grid};
+    std::vector<Choice> choices;
+    choices.reserve(CandidateCache<N>::CellCount);
+    std::size_t backtracks = 0;
+    // Takes a random value out of choice.remaining and places it.
+    const auto place = [&](Choice &choice)
+    {
+        std::uniform_int_distribution<int> indexDist(0, Traits::Count(choice.remaining) - 1);
+        BitSetIterator<N> values{choice.remaining};
+        for (int i = indexDist(rng); i > 0; --i)
+        {
+            ++values;
+        }
+        const DataType value = *values;
+        Traits::Reset(choice.remaining, value - 1u);
+        cache.SetValue(grid, choice.cell, value);
+    };
+    while (cache.GetEmptyCount() != 0)
+    {
+        const std::size_t cell = cache.GetMinCell();
+        if (cache.GetCount(cell) != 0)
+        {
+            choices.push_back({cell, cache.GetCandidates(cell)});
+            place(choices.back());
+            continue;
+        }
+        if (++backtracks > RandomGridRestartBacktracks * CandidateCache<N>::CellCount)
+        {
+            grid = {};
+            cache.Reset(grid);
+            choices.clear();
+            backtracks = 0;
+            continue;
+        }
+        while (true)
+        {
+            Choice &choice = choices.back();
+            cache.RemoveValue(grid, choice.cell);
+            if (Traits::Any(choice.remaining))
+            {
+                place(choice);
+                break;
+            }
+            choices.pop_back();
+        }
+    }
+    return grid;
+}
+
+// Removes the clues of a solved grid in random order, keeping each removal
+// only if the puzzle still has one solution. A unique puzzle stays unique
+// without the clue at `cell` exactly when no other candidate of `cell` leads
+// to a solution, so each check is one solve per alternative, most of them
+// refuted by propagation alone, rather than counting up to two solutions.
+// A removal that fails once fails for good, since later removals only loosen
+// the puzzle, so a single pass is enough.
+template <std::size_t N>
+inline SudokuMatrix<N> RemoveClues(const SudokuMatrix<N> &grid, pcg64 &rng, const GeneratorOptions &options = {})
+{
+    using DataType = typename SudokuMatrix<N>::DataType;
+    using Traits = UnitMaskTraits<N>;
+    constexpr std::size_t size = N * N;
+    constexpr std::size_t cellCount = size * size;
+
+    std::array<std::size_t, cellCount> order{};
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::shuffle(order.begin(), order.end(), rng);
+
+    SudokuMatrix<N> puzzle = grid;
+    PropagationSolver<N> solver;
+    std::size_t clues = cellCount;
+    for (const std::size_t cell : order)
+    {
+        if (clues <= options.targetClues)
+        {
+            break;
+        }
+        const std::size_t row = cell / size;
+        const std::size_t col = cell % size;
+        const DataType value = puzzle.GetValue(cell);
+        puzzle.RemoveValue(row, col);
+        auto alternatives = puzzle.GetPossibleValues(row, col).GetFlag();
+        Traits::Reset(alternatives, value - 1u);
+        bool unique = true;
+        for (const DataType alternative : BitSetIterator<N>{alternatives})
+        {
+            SudokuMatrix<N> candidate = puzzle;
+            candidate.SetValue(row, col, alternative);
+            solver.Reset(candidate);
+            if (solver.Solve(options.maxCheckSteps).status != SolveStatus::Unsolvable)
+            {
+                unique = false;
+                break;
+            }
+        }
+        if (unique)
+        {
+            clues--;
+        }
+        else
+        {
+            puzzle.SetValue(row, col, value);
+        }
+    }
+    return puzzle;
+}
+
+// A puzzle with exactly one solution, or std::nullopt if none of
+// options.maxAttempts grids gave one of options.difficulty.
+template <std::size_t N>
+inline std::optional<SudokuMatrix<N>> GeneratePuzzle(pcg64 &rng, const GeneratorOptions &options = {})
+{
+    for (std::size_t attempt = 0; attempt < options.maxAttempts; ++attempt)
+    {
+        SudokuMatrix<N> puzzle = RemoveClues<N>(CreateRandomGrid<N>(rng), rng, options);
+        if (!options.difficulty.has_value() || RateDifficulty<N>(puzzle) == options.difficulty)
+        {
+            return puzzle;
+        }
+    }
+    return std::nullopt;
+}
+
+// Generates up to `count` puzzles on the pool. Chunk k of chunkSize puzzles
+// draws from its own pcg64 stream, pcg64(seed, k), so the output depends on
+// the seed alone and not on the pool size or on which thread ran the chunk.
+// Puzzles that missed options.difficulty are left out. Blocks until every
+// chunk is done, so it must not be called from a task of `pool`.
+template <std::size_t N>
+std::vector<SudokuMatrix<N>> GeneratePuzzles(WorkStealingPool &pool, std::size_t count, std::uint64_t seed, const GeneratorOptions &options = {}, std::size_t chunkSize = 16)
+{
+    assert(!pool.IsWorkerThread());
+    if (count == 0)
+    {
+        return {};
+    }
+    chunkSize = std::max<std::size_t>(chunkSize, 1);
+    const std::size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+    std::vector<std::optional<SudokuMatrix<N>>> slots(count);
+    std::latch done(static_cast<std::ptrdiff_t>(chunkCount));
+    for (std::size_t chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        const std::size_t begin = chunk * chunkSize;
+        const std::size_t end = std::min(begin + chunkSize, count);
+        const std::size_t worker = chunk * pool.Size() / chunkCount;
+        pool.Submit(worker, [=, &slots, &options, &done]
+                    {
+                        pcg64 rng(seed, chunk);
+                        for (std::size_t i = begin; i < end; ++i)
+                        {
+                            slots[i] = GeneratePuzzle<N>(rng, options);
+                        }
+                        done.count_down(); });
+    }
+    done.wait();
+    std::vector<SudokuMatrix<N>> puzzles;
+    puzzles.reserve(count);
+    for (auto &slot : slots)
+    {
+        if (slot.has_value())
+        {
+            puzzles.push_back(std::move(*slot));
+        }
+    }
+    return puzzles;
+}
\ No newline at end of file
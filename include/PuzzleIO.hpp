@@ -0,0 +1,354 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <immintrin.h>
+#include "./CpuFeatures.hpp"
+#include "./MappedFile.hpp"
+#include "./SudokuMatrix.hpp"
+
+// Puzzle files hold one puzzle per line: the N^4 cells in row-major order,
+// '0' or '.' for an empty cell and 1-9 then A-Z for the digits, so a 9x9
+// puzzle is the usual 81-character line. Anything after the cells that
+// follows a space, tab or comma (a solution, a rating) is ignored, and so are
+// blank lines and lines starting with '#'.
+
+// 1-9 and A-Z spell up to 35 values, so boxes up to 5 (25x25 boards).
+inline constexpr std::size_t MaxTextBoardSize = 5;
+
+// Value of a cell character, or std::nullopt if it is not a cell of an N box.
+template <std::size_t N>
+inline constexpr std::optional<typename SudokuMatrix<N>::DataType> ParseCell(char cell) noexcept
+{
+    using DataType = typename SudokuMatrix<N>::DataType;
+    std::size_t value;
+    if (cell == '.' || cell == '0')
+    {
+        return DataType{0};
+    }
+    if (cell >= '1' && cell <= '9')
+    {
+        value = static_cast<std::size_t>(cell - '0');
+    }
+    else if (cell >= 'A' && cell <= 'Z')
+    {
+        value = static_cast<std::size_t>(cell - 'A') + 10;
+    }
+    else if (cell >= 'a' && cell <= 'z')
+    {
+        value = static_cast<std::size_t>(cell - 'a') + 10;
+    }
+    else
+    {
+        return std::nullopt;
+    }
+    if (value > N * N)
+    {
+        return std::nullopt;
+    }
+    return static_cast<DataType>(value);
+}
+
+template <std::size_t N>
+inline constexpr char FormatCell(typename SudokuMatrix<N>::DataType value) noexcept
+{
+    static_assert(N <= MaxTextBoardSize, "values above 35 have no cell character");
+    if (value == 0)
+    {
+        return '.';
+    }
+    return value < 10 ? static_cast<char>('0' + value) : static_cast<char>('A' + (value - 10));
+}
+
+// ParseCell over `count` >= 32 characters, 32 at a time, the last block
+// overlapping the one before. Digits, letters of either case and '.' are
+// told apart by range compares and turned into values in the same pass.
+// Returns false if any character is not a cell with a value up to `maxValue`.
+SUDOKU_TARGET_AVX2 inline bool ParseCellsAvx2(const char *text, std::size_t count, std::uint8_t *cells, std::uint8_t maxValue) noexcept
+{
+    const __m256i zeroChar = _mm256_set1_epi8('0');
+    const __m256i nine = _mm256_set1_epi8(9);
+    const __m256i dot = _mm256_set1_epi8('.');
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+    const __m256i lowerA = _mm256_set1_epi8('a');
+    const __m256i lastLetter = _mm256_set1_epi8(25);
+    const __m256i ten = _mm256_set1_epi8(10);
+    const __m256i maxValues = _mm256_set1_epi8(static_cast<char>(maxValue));
+    __m256i valid = _mm256_set1_epi8(-1);
+    std::size_t offset = 0;
+    while (true)
+    {
+        const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text + offset));
+        const __m256i digit = _mm256_sub_epi8(chars, zeroChar);
+        const __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, nine), digit);
+        const __m256i letter = _mm256_sub_epi8(_mm256_or_si256(chars, caseBit), lowerA);
+        const __m256i isLetter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, lastLetter), letter);
+        const __m256i isDot = _mm256_cmpeq_epi8(chars, dot);
+        const __m256i values = _mm256_or_si256(_mm256_and_si256(isDigit, digit), _mm256_and_si256(isLetter, _mm256_add_epi8(letter, ten)));
+        const __m256i inRange = _mm256_cmpeq_epi8(_mm256_min_epu8(values, maxValues), values);
+        valid = _mm256_and_si256(valid, _mm256_and_si256(inRange, _mm256_or_si256(_mm256_or_si256(isDigit, isLetter), isDot)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(cells + offset), values);
+        if (offset + 32 == count)
+        {
+            break;
+        }
+        offset = std::min(offset + 32, count - 32);
+    }
+    return _mm256_movemask_epi8(valid) == -1;
+}
+
+// Parses one puzzle line. The givens are not checked against each other.
+template <std::size_t N>
+inline constexpr std::optional<SudokuMatrix<N>> ParsePuzzle(std::string_view line)
+{
+    using DataType = typename SudokuMatrix<N>::DataType;
+    constexpr std::size_t cellCount = N * N * N * N;
+    if (line.size() < cellCount)
+    {
+        return std::nullopt;
+    }
+    if (line.size() > cellCount && line[cellCount] != ' ' && line[cellCount] != '\t' && line[cellCount] != ',' && line[cellCount] != '\r')
+    {
+        return std::nullopt;
+    }
+    std::array<DataType, cellCount> cells{};
+    if constexpr (sizeof(DataType) == 1 && cellCount >= 32)
+    {
+        if (!std::is_constant_evaluated() && GetSimdLevel() != SimdLevel::Scalar)
+        {
+            if (!ParseCellsAvx2(line.data(), cellCount, cells.data(), static_cast<std::uint8_t>(N * N)))
+            {
+                return std::nullopt;
+            }
+            return SudokuMatrix<N>{cells};
+        }
+    }
+    for (std::size_t i = 0; i < cellCount; ++i)
+    {
+        const auto value = ParseCell<N>(line[i]);
+        if (!value.has_value())
+        {
+            return std::nullopt;
+        }
+        cells[i] = *value;
+    }
+    return SudokuMatrix<N>{cells};
+}
+
+template <std::size_t N>
+inline std::string FormatPuzzle(const SudokuMatrix<N> &board)
+{
+    std::string line;
+    line.reserve(N * N * N * N);
+    for (const auto value : board.GetData())
+    {
+        line.push_back(FormatCell<N>(value));
+    }
+    return line;
+}
+
+// A line with its leading blanks dropped, or an empty view for a blank or
+// comment line.
+inline constexpr std::string_view StripPuzzleLine(std::string_view line) noexcept
+{
+    const std::size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string_view::npos || line[start] == '#')
+    {
+        return {};
+    }
+    return line.substr(start);
+}
+
+// Reads every puzzle of `input`. Returns std::nullopt if a line is neither a
+// puzzle nor skipped, rather than dropping it from the set.
+template <std::size_t N>
+inline std::optional<std::vector<SudokuMatrix<N>>> LoadPuzzles(std::istream &input)
+{
+    std::vector<SudokuMatrix<N>> puzzles;
+    std::string line;
+    while (std::getline(input, line))
+    {
+        const std::string_view stripped = StripPuzzleLine(line);
+        if (stripped.empty())
+        {
+            continue;
+        }
+        auto puzzle = ParsePuzzle<N>(stripped);
+        if (!puzzle.has_value())
+        {
+            return std::nullopt;
+        }
+        puzzles.push_back(std::move(*puzzle));
+    }
+    return puzzles;
+}
+
+// Walks the puzzles of a text held in memory, typically a MappedFile's view,
+// without copying the lines out of it.
+template <std::size_t N>
+class PuzzleReader
+{
+    std::string_view m_text;
+    std::size_t m_offset = 0;
+    std::size_t m_lineNumber = 0;
+    bool m_failed = false;
+
+public:
+    explicit PuzzleReader(std::string_view text) : m_text(text) {}
+
+    // The next puzzle, or std::nullopt at the end of the text or at a line
+    // that is neither a puzzle nor skipped; Failed() tells the two apart, and
+    // a failed reader stays at the bad line.
+    inline std::optional<SudokuMatrix<N>> Next()
+    {
+        while (!m_failed && m_offset < m_text.size())
+        {
+            const char *start = m_text.data() + m_offset;
+            const std::size_t remaining = m_text.size() - m_offset;
+            const void *newline = std::memchr(start, '\n', remaining);
+            const std::size_t length = newline != nullptr ? static_cast<std::size_t>(static_cast<const char *>(newline) - start) : remaining;
+            m_offset += length + 1;
+            m_lineNumber++;
+            const std::string_view line = StripPuzzleLine(std::string_view(start, length));
+            if (line.empty())
+            {
+                continue;
+            }
+            auto puzzle = ParsePuzzle<N>(line);
+            if (!puzzle.has_value())
+            {
+                m_failed = true;
+            }
+            return puzzle;
+        }
+        return std::nullopt;
+    }
+
+    inline bool Failed() const noexcept
+    {
+        return m_failed;
+    }
+
+    // 1-based number of the last line read.
+    inline std::size_t GetLineNumber() const noexcept
+    {
+        return m_lineNumber;
+    }
+};
+
+// Maps the file and reads it with a PuzzleReader.
+template <std::size_t N>
+inline std::optional<std::vector<SudokuMatrix<N>>> LoadPuzzleFile(const std::filesystem::path &path)
+{
+    const std::optional<MappedFile> file = MappedFile::Open(path);
+    if (!file.has_value())
+    {
+        return std::nullopt;
+    }
+    std::vector<SudokuMatrix<N>> puzzles;
+    puzzles.reserve(file->GetSize() / (N * N * N * N + 1));
+    PuzzleReader<N> reader(file->GetView());
+    while (auto puzzle = reader.Next())
+    {
+        puzzles.push_back(std::move(*puzzle));
+    }
+    if (reader.Failed())
+    {
+        return std::nullopt;
+    }
+    return puzzles;
+}
+
+// Formats boards one per line into a buffer that goes to the stream in
+// writes of about `bufferSize` bytes, and on Flush() or destruction.
+template <std::size_t N>
+class PuzzleWriter
+{
+    static_assert(N <= MaxTextBoardSize, "values above 35 have no cell character");
+    using DataType = typename SudokuMatrix<N>::DataType;
+    static constexpr std::size_t CellCount = N * N * N * N;
+    static constexpr std::array<char, N * N + 1> Cells = []()
+    {
+        std::array<char, N * N + 1> cells{};
+        for (std::size_t value = 0; value <= N * N; ++value)
+        {
+            cells[value] = FormatCell<N>(static_cast<DataType>(value));
+        }
+        return cells;
+    }();
+
+    std::ostream &m_output;
+    std::string m_buffer;
+    std::size_t m_bufferSize;
+
+    inline void Append(const SudokuMatrix<N> &board)
+    {
+        const std::size_t start = m_buffer.size();
+        m_buffer.resize(start + CellCount);
+        char *out = m_buffer.data() + start;
+        for (const DataType value : board.GetData())
+        {
+            *out++ = Cells[value];
+        }
+    }
+
+    inline void EndLine()
+    {
+        m_buffer.push_back('\n');
+        if (m_buffer.size() >= m_bufferSize)
+        {
+            Flush();
+        }
+    }
+
+public:
+    explicit PuzzleWriter(std::ostream &output, std::size_t bufferSize = std::size_t{1} << 20)
+        : m_output(output), m_bufferSize(bufferSize)
+    {
+        m_buffer.reserve(bufferSize + 2 * CellCount + 2);
+    }
+    PuzzleWriter(const PuzzleWriter &) = delete;
+    PuzzleWriter &operator=(const PuzzleWriter &) = delete;
+    ~PuzzleWriter() { Flush(); }
+
+    inline void Write(const SudokuMatrix<N> &board)
+    {
+        Append(board);
+        EndLine();
+    }
+
+    // "board note"; ParsePuzzle reads the board back and skips the note.
+    inline void Write(const SudokuMatrix<N> &board, std::string_view note)
+    {
+        Append(board);
+        m_buffer.push_back(' ');
+        m_buffer.append(note);
+        EndLine();
+    }
+
+    // "puzzle,solution", which ParsePuzzle reads back as the puzzle.
+    inline void Write(const SudokuMatrix<N> &puzzle, const SudokuMatrix<N> &solution)
+    {
+        Append(puzzle);
+        m_buffer.push_back(',');
+        Append(solution);
+        EndLine();
+    }
+
+    inline void Flush()
+    {
+        if (!m_buffer.empty())
+        {
+            m_output.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+            m_buffer.clear();
+        }
+    }
+};
\ No newline at end of file
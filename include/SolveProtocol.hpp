@@ -0,0 +1,200 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+#include "./PuzzleArchive.hpp"
+#include "./SudokuMatrix.hpp"
+#include "./solvers/AnySolver.hpp"
+#include "./solvers/SolveStatus.hpp"
+
+// Frames of the local solve service. Integers are little-endian and boards
+// are packed as in a PuzzleArchive record, 41 bytes for a 9x9 board.
+//
+// Request: a 12-byte header, then the puzzle.
+//   u32 id        echoed in the response
+//   u8  box size  N of the puzzle
+//   u8  solver    SolverKind
+//   u16 reserved
+//   u32 deadline  microseconds after the server read the request, 0 for none
+//
+// Response: an 8-byte header, then the final board unless the request was
+// rejected. Responses on a connection come in any order.
+//   u32 id
+//   u8  status    SolveStatus, or Rejected
+//   u8  box size
+//   u16 reserved
+namespace SolveProtocol
+{
+    inline constexpr std::size_t RequestHeaderSize = 12;
+    inline constexpr std::size_t ResponseHeaderSize = 8;
+    // Status of a request for a box size the server does not serve, an
+    // unknown solver, one the server cannot run or a cell out of range.
+    inline constexpr std::uint8_t Rejected = 0xFF;
+
+    // Bytes of a packed board of box size `boxSize`, 0 if it has no framing.
+    inline constexpr std::size_t PackedBoardSize(std::size_t boxSize) noexcept
+    {
+        if (boxSize == 0 || boxSize > MaxDynamicBoardSize)
+        {
+            return 0;
+        }
+        const std::size_t cellCount = boxSize * boxSize * boxSize * boxSize;
+        return (cellCount * static_cast<std::size_t>(std::bit_width(boxSize * boxSize)) + 7) / 8;
+    }
+
+    inline constexpr std::optional<SolverKind> ReadSolverKind(std::uint8_t value) noexcept
+    {
+        if (value > static_cast<std::uint8_t>(SolverKind::Band))
+        {
+            return std::nullopt;
+        }
+        return static_cast<SolverKind>(value);
+    }
+}
+
+struct RequestHeader
+{
+    std::uint32_t id;
+    std::uint8_t boxSize;
+    std::uint8_t solver;
+    std::uint32_t deadlineMicros;
+};
+
+struct ResponseHeader
+{
+    std::uint32_t id;
+    std::uint8_t status;
+    std::uint8_t boxSize;
+};
+
+template <std::size_t N>
+struct SolveRequest
+{
+    std::uint32_t id = 0;
+    SolverKind solver = SolverKind::Dlx;
+    std::uint32_t deadlineMicros = 0;
+    SudokuMatrix<N> puzzle{};
+};
+
+template <std::size_t N>
+struct SolveResponse
+{
+    std::uint32_t id = 0;
+    // std::nullopt if the server rejected the request.
+    std::optional<SolveStatus> status;
+    SudokuMatrix<N> board{};
+};
+
+template <std::size_t N>
+inline void AppendRequest(std::vector<std::uint8_t> &out, const SolveRequest<N> &request)
+{
+    using namespace PuzzleArchiveFormat;
+    const std::size_t start = out.size();
+    out.resize(start + SolveProtocol::RequestHeaderSize + PackedBoard<N>::Bytes);
+    std::uint8_t *frame = out.data() + start;
+    Store<std::uint32_t>(frame, request.id);
+    frame[4] = static_cast<std::uint8_t>(N);
+    frame[5] = static_cast<std::uint8_t>(request.solver);
+    Store<std::uint16_t>(frame + 6, 0);
+    Store<std::uint32_t>(frame + 8, request.deadlineMicros);
+    PackBoard<N>(request.puzzle, frame + SolveProtocol::RequestHeaderSize);
+}
+
+// std::nullopt until `bytes` holds a whole header.
+inline constexpr std::optional<RequestHeader> ReadRequestHeader(std::span<const std::uint8_t> bytes) noexcept
+{
+    using namespace PuzzleArchiveFormat;
+    if (bytes.size() < SolveProtocol::RequestHeaderSize)
+    {
+        return std::nullopt;
+    }
+    return RequestHeader{Load<std::uint32_t>(bytes.data()), bytes[4], bytes[5], Load<std::uint32_t>(bytes.data() + 8)};
+}
+
+// Header and board bytes of the frame, 0 if the next frame cannot be found.
+inline constexpr std::size_t RequestFrameSize(const RequestHeader &header) noexcept
+{
+    const std::size_t boardSize = SolveProtocol::PackedBoardSize(header.boxSize);
+    return boardSize == 0 ? 0 : SolveProtocol::RequestHeaderSize + boardSize;
+}
+
+// The request of a whole frame, or std::nullopt if it should be rejected.
+template <std::size_t N>
+inline std::optional<SolveRequest<N>> ParseRequest(const RequestHeader &header, const std::uint8_t *board)
+{
+    const std::optional<SolverKind> solver = SolveProtocol::ReadSolverKind(header.solver);
+    if (header.boxSize != N || !solver.has_value())
+    {
+        return std::nullopt;
+    }
+    std::optional<SudokuMatrix<N>> puzzle = UnpackBoard<N>(board);
+    if (!puzzle.has_value())
+    {
+        return std::nullopt;
+    }
+    return SolveRequest<N>{header.id, *solver, header.deadlineMicros, std::move(*puzzle)};
+}
+
+// Appends a response; `board` is left out when `status` is std::nullopt.
+template <std::size_t N>
+inline void AppendResponse(std::vector<std::uint8_t> &out, std::uint32_t id, std::optional<SolveStatus> status, const SudokuMatrix<N> &board)
+{
+    using namespace PuzzleArchiveFormat;
+    const std::size_t start = out.size();
+    out.resize(start + SolveProtocol::ResponseHeaderSize + (status.has_value() ? PackedBoard<N>::Bytes : 0));
+    std::uint8_t *frame = out.data() + start;
+    Store<std::uint32_t>(frame, id);
+    frame[4] = status.has_value() ? static_cast<std::uint8_t>(*status) : SolveProtocol::Rejected;
+    frame[5] = static_cast<std::uint8_t>(N);
+    Store<std::uint16_t>(frame + 6, 0);
+    if (status.has_value())
+    {
+        PackBoard<N>(board, frame + SolveProtocol::ResponseHeaderSize);
+    }
+}
+
+inline constexpr std::optional<ResponseHeader> ReadResponseHeader(std::span<const std::uint8_t> bytes) noexcept
+{
+    using namespace PuzzleArchiveFormat;
+    if (bytes.size() < SolveProtocol::ResponseHeaderSize)
+    {
+        return std::nullopt;
+    }
+    return ResponseHeader{Load<std::uint32_t>(bytes.data()), bytes[4], bytes[5]};
+}
+
+inline constexpr std::size_t ResponseFrameSize(const ResponseHeader &header) noexcept
+{
+    if (header.status == SolveProtocol::Rejected)
+    {
+        return SolveProtocol::ResponseHeaderSize;
+    }
+    const std::size_t boardSize = SolveProtocol::PackedBoardSize(header.boxSize);
+    if (boardSize == 0 || header.status > static_cast<std::uint8_t>(SolveStatus::DeadlineExceeded))
+    {
+        return 0;
+    }
+    return SolveProtocol::ResponseHeaderSize + boardSize;
+}
+
+// std::nullopt if the frame is not a response for an N box.
+template <std::size_t N>
+inline std::optional<SolveResponse<N>> ParseResponse(const ResponseHeader &header, const std::uint8_t *board)
+{
+    if (header.status == SolveProtocol::Rejected)
+    {
+        return SolveResponse<N>{header.id, std::nullopt, {}};
+    }
+    if (header.boxSize != N)
+    {
+        return std::nullopt;
+    }
+    std::optional<SudokuMatrix<N>> solution = UnpackBoard<N>(board);
+    if (!solution.has_value())
+    {
+        return std::nullopt;
+    }
+    return SolveResponse<N>{header.id, static_cast<SolveStatus>(header.status), std::move(*solution)};
+}
\ No newline at end of file
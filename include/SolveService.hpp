@@ -0,0 +1,791 @@
+#pragma once
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "./BatchSolver.hpp"
+#include "./SolveProtocol.hpp"
+#include "./WorkStealingPool.hpp"
+
+// Local solve service over a Unix-domain socket or loopback TCP, speaking the
+// frames of SolveProtocol.hpp. POSIX only.
+
+// Owns a file descriptor, socket or pipe end.
+class UniqueFd
+{
+    int m_fd = -1;
+
+public:
+    UniqueFd() = default;
+    explicit UniqueFd(int fd) : m_fd(fd) {}
+    UniqueFd(const UniqueFd &) = delete;
+    UniqueFd &operator=(const UniqueFd &) = delete;
+    UniqueFd(UniqueFd &&other) noexcept : m_fd(std::exchange(other.m_fd, -1)) {}
+    UniqueFd &operator=(UniqueFd &&other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            m_fd = std::exchange(other.m_fd, -1);
+        }
+        return *this;
+    }
+    ~UniqueFd() { Reset(); }
+
+    inline void Reset() noexcept
+    {
+        if (m_fd >= 0)
+        {
+            close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    inline int Get() const noexcept
+    {
+        return m_fd;
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return m_fd >= 0;
+    }
+};
+
+// A Unix socket path, or a loopback TCP port when `path` is empty.
+struct ServiceEndpoint
+{
+    std::string path;
+    std::uint16_t port = 0;
+};
+
+// "tcp:<port>" for loopback TCP, anything else is a Unix socket path.
+inline std::optional<ServiceEndpoint> ParseEndpoint(std::string_view text)
+{
+    constexpr std::string_view tcpPrefix = "tcp:";
+    if (!text.starts_with(tcpPrefix))
+    {
+        if (text.empty())
+        {
+            return std::nullopt;
+        }
+        return ServiceEndpoint{std::string(text), 0};
+    }
+    const std::string_view port = text.substr(tcpPrefix.size());
+    std::uint16_t value = 0;
+    const auto [end, error] = std::from_chars(port.data(), port.data() + port.size(), value);
+    if (port.empty() || error != std::errc{} || end != port.data() + port.size())
+    {
+        return std::nullopt;
+    }
+    return ServiceEndpoint{{}, value};
+}
+
+inline std::string FormatEndpoint(const ServiceEndpoint &endpoint)
+{
+    return endpoint.path.empty() ? "tcp:" + std::to_string(endpoint.port) : endpoint.path;
+}
+
+namespace Detail
+{
+#if defined(MSG_NOSIGNAL)
+    inline constexpr int SendFlags = MSG_NOSIGNAL;
+#else
+    inline constexpr int SendFlags = 0;
+#endif
+
+    inline bool FillUnixAddress(const std::string &path, sockaddr_un &address) noexcept
+    {
+        address = {};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+        {
+            return false;
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return true;
+    }
+
+    inline sockaddr_in LoopbackAddress(std::uint16_t port) noexcept
+    {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        return address;
+    }
+
+    inline bool SetNonBlocking(int fd) noexcept
+    {
+        const int flags = fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    // Small frames go out at once instead of waiting for Nagle's algorithm.
+    inline void SetNoDelay(int socket) noexcept
+    {
+        const int enable = 1;
+        setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    }
+}
+
+// Listens on `endpoint`, replacing a stale Unix socket file. Port 0 binds a
+// free port, written back to endpoint.port.
+inline UniqueFd ListenOn(ServiceEndpoint &endpoint, int backlog = 128)
+{
+    if (!endpoint.path.empty())
+    {
+        sockaddr_un address;
+        if (!Detail::FillUnixAddress(endpoint.path, address))
+        {
+            return {};
+        }
+        UniqueFd socket{::socket(AF_UNIX, SOCK_STREAM, 0)};
+        unlink(endpoint.path.c_str());
+        if (!socket || bind(socket.Get(), reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 || listen(socket.Get(), backlog) != 0)
+        {
+            return {};
+        }
+        return socket;
+    }
+    UniqueFd socket{::socket(AF_INET, SOCK_STREAM, 0)};
+    const int enable = 1;
+    sockaddr_in address = Detail::LoopbackAddress(endpoint.port);
+    if (!socket || setsockopt(socket.Get(), SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) != 0 ||
+        bind(socket.Get(), reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 || listen(socket.Get(), backlog) != 0)
+    {
+        return {};
+    }
+    socklen_t length = sizeof(address);
+    if (getsockname(socket.Get(), reinterpret_cast<sockaddr *>(&address), &length) != 0)
+    {
+        return {};
+    }
+    endpoint.port = ntohs(address.sin_port);
+    return socket;
+}
+
+inline UniqueFd ConnectTo(const ServiceEndpoint &endpoint)
+{
+    if (!endpoint.path.empty())
+    {
+        sockaddr_un address;
+        if (!Detail::FillUnixAddress(endpoint.path, address))
+        {
+            return {};
+        }
+        UniqueFd socket{::socket(AF_UNIX, SOCK_STREAM, 0)};
+        if (!socket || connect(socket.Get(), reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+        {
+            return {};
+        }
+        return socket;
+    }
+    const sockaddr_in address = Detail::LoopbackAddress(endpoint.port);
+    UniqueFd socket{::socket(AF_INET, SOCK_STREAM, 0)};
+    if (!socket || connect(socket.Get(), reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+    {
+        return {};
+    }
+    Detail::SetNoDelay(socket.Get());
+    return socket;
+}
+
+// Writes all of `bytes`. False if the peer went away.
+inline bool SendAll(int socket, std::span<const std::uint8_t> bytes) noexcept
+{
+    while (!bytes.empty())
+    {
+        const ssize_t sent = send(socket, bytes.data(), bytes.size(), Detail::SendFlags);
+        if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (sent <= 0)
+        {
+            return false;
+        }
+        bytes = bytes.subspan(static_cast<std::size_t>(sent));
+    }
+    return true;
+}
+
+// Blocking client. Send() only queues a request; Receive() sends whatever is
+// queued before it waits, so requests sent back to back share a write.
+template <std::size_t N>
+class SolveClient
+{
+    UniqueFd m_socket;
+    std::vector<std::uint8_t> m_output;
+    std::vector<std::uint8_t> m_input;
+    std::size_t m_inputOffset = 0;
+
+    explicit SolveClient(UniqueFd socket) : m_socket(std::move(socket)) {}
+
+public:
+    static std::optional<SolveClient> Connect(const ServiceEndpoint &endpoint)
+    {
+        UniqueFd socket = ConnectTo(endpoint);
+        if (!socket)
+        {
+            return std::nullopt;
+        }
+        return SolveClient(std::move(socket));
+    }
+
+    inline void Send(const SolveRequest<N> &request)
+    {
+        AppendRequest<N>(m_output, request);
+    }
+
+    inline bool Flush()
+    {
+        const bool sent = SendAll(m_socket.Get(), m_output);
+        m_output.clear();
+        return sent;
+    }
+
+    // The next response, or std::nullopt once the connection is closed or
+    // sends something that is not a response for an N box.
+    inline std::optional<SolveResponse<N>> Receive()
+    {
+        while (true)
+        {
+            const std::span<const std::uint8_t> pending = std::span<const std::uint8_t>(m_input).subspan(m_inputOffset);
+            if (const std::optional<ResponseHeader> header = ReadResponseHeader(pending))
+            {
+                const std::size_t frameSize = ResponseFrameSize(*header);
+                if (frameSize == 0)
+                {
+                    return std::nullopt;
+                }
+                if (pending.size() >= frameSize)
+                {
+                    m_inputOffset += frameSize;
+                    return ParseResponse<N>(*header, pending.data() + SolveProtocol::ResponseHeaderSize);
+                }
+            }
+            if (!m_output.empty() && !Flush())
+            {
+                return std::nullopt;
+            }
+            m_input.erase(m_input.begin(), m_input.begin() + static_cast<std::ptrdiff_t>(m_inputOffset));
+            m_inputOffset = 0;
+            const std::size_t size = m_input.size();
+            m_input.resize(size + 64 * 1024);
+            const ssize_t received = recv(m_socket.Get(), m_input.data() + size, 64 * 1024, 0);
+            m_input.resize(size + static_cast<std::size_t>(std::max<ssize_t>(received, 0)));
+            if (received < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (received <= 0)
+            {
+                return std::nullopt;
+            }
+        }
+    }
+};
+
+struct SolveServerOptions
+{
+    std::size_t threads = std::thread::hardware_concurrency();
+    // A micro-batch closes at maxBatch requests or batchWindow after its
+    // oldest request arrived. Requests keep queueing while a batch runs, so
+    // batches grow with the load.
+    std::size_t maxBatch = 256;
+    std::chrono::microseconds batchWindow{50};
+    std::uint64_t maxSteps = 10'000'000;
+    std::size_t chunkSize = 4;
+    // Requests a connection may have unanswered, counting the responses its
+    // client has not read yet. Past it the server stops reading from the
+    // connection until the client catches up.
+    std::size_t maxInFlight = 1024;
+};
+
+// Serves N-box puzzles. A thread per connection decodes requests into a
+// shared queue and writes the responses back; one batch thread cuts the
+// queue into micro-batches, solves each with SolveBatch on a pool whose
+// thread-local solvers are built at start, and hands every response to the
+// buffer of its connection. Sockets are non-blocking and only their own
+// thread touches them, so a client that stops reading stalls nobody else.
+template <std::size_t N>
+class SolveServer
+{
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::size_t ResponseSize = SolveProtocol::ResponseHeaderSize + PackedBoard<N>::Bytes;
+
+    struct Connection
+    {
+        UniqueFd socket;
+        // Written by the batch thread when output stops being empty.
+        UniqueFd wakeRead;
+        UniqueFd wakeWrite;
+        std::mutex mutex;
+        // Responses not yet taken by the connection's thread.
+        std::vector<std::uint8_t> output;
+        // Requests queued or being solved.
+        std::size_t inFlight = 0;
+        // Set when the connection's thread is gone; responses are dropped.
+        bool closed = false;
+    };
+
+    struct Pending
+    {
+        std::shared_ptr<Connection> connection;
+        std::uint32_t id;
+        // std::nullopt for a rejected request.
+        std::optional<SolveRequest<N>> request;
+        Clock::time_point arrival;
+        Clock::time_point deadline;
+    };
+
+    struct Reader
+    {
+        std::unique_ptr<std::atomic<bool>> done;
+        std::shared_ptr<Connection> connection;
+        std::jthread thread;
+    };
+
+    ServiceEndpoint m_endpoint;
+    SolveServerOptions m_options;
+    UniqueFd m_listener;
+    // Written once by Stop(); every poll watches the read end.
+    UniqueFd m_wakeRead;
+    UniqueFd m_wakeWrite;
+    WorkStealingPool m_pool;
+
+    std::mutex m_mutex;
+    std::condition_variable m_queued;
+    std::deque<Pending> m_queue;
+    bool m_stopping = false;
+
+    std::mutex m_readersMutex;
+    std::vector<Reader> m_readers;
+
+    std::atomic<std::uint64_t> m_requestCount{0};
+    std::atomic<std::uint64_t> m_batchCount{0};
+
+    std::jthread m_batchThread;
+    std::jthread m_acceptThread;
+
+    // Reused between batches by the batch thread.
+    std::vector<SudokuMatrix<N>> m_puzzles;
+    std::vector<SudokuMatrix<N>> m_solutions;
+    std::vector<SolveStatus> m_statuses;
+    std::vector<Clock::time_point> m_deadlines;
+    std::vector<std::size_t> m_indices;
+
+    SolveServer(const ServiceEndpoint &endpoint, const SolveServerOptions &options, UniqueFd listener, UniqueFd wakeRead, UniqueFd wakeWrite)
+        : m_endpoint(endpoint), m_options(options), m_listener(std::move(listener)), m_wakeRead(std::move(wakeRead)), m_wakeWrite(std::move(wakeWrite)), m_pool(options.threads)
+    {
+        m_options.maxBatch = std::max<std::size_t>(m_options.maxBatch, 1);
+        m_options.maxInFlight = std::max<std::size_t>(m_options.maxInFlight, 1);
+    }
+
+    // Blocks until `fd` is readable. False once Stop() was called.
+    inline bool WaitReadable(int fd) const noexcept
+    {
+        pollfd fds[2] = {{fd, POLLIN, 0}, {m_wakeRead.Get(), POLLIN, 0}};
+        while (poll(fds, 2, -1) < 0)
+        {
+            if (errno != EINTR)
+            {
+                return false;
+            }
+        }
+        return fds[1].revents == 0;
+    }
+
+    // Builds every pool thread's solvers before the first request. Each task
+    // holds its thread at the latch until every thread has one, so no thread
+    // can take two of them.
+    inline void WarmSolvers()
+    {
+        std::latch warmed(static_cast<std::ptrdiff_t>(m_pool.Size()));
+        for (std::size_t worker = 0; worker < m_pool.Size(); ++worker)
+        {
+            m_pool.Submit(worker, [&warmed]
+                          {
+                              const SudokuMatrix<N> board{};
+                              for (const SolverKind kind : {SolverKind::BackTracking, SolverKind::Dlx, SolverKind::Propagation, SolverKind::Band})
+                              {
+                                  VisitSolverKind<N>(kind, [&]<template <std::size_t> class Solver>()
+                                                     { AcquireThreadSolver<N, Solver>(board); });
+                              }
+                              warmed.arrive_and_wait(); });
+        }
+        m_pool.Wait();
+    }
+
+    inline void AcceptLoop()
+    {
+        while (WaitReadable(m_listener.Get()))
+        {
+            UniqueFd socket{accept(m_listener.Get(), nullptr, nullptr)};
+            int wake[2];
+            if (!socket || !Detail::SetNonBlocking(socket.Get()) || pipe(wake) != 0)
+            {
+                continue;
+            }
+            auto connection = std::make_shared<Connection>();
+            connection->socket = std::move(socket);
+            connection->wakeRead = UniqueFd{wake[0]};
+            connection->wakeWrite = UniqueFd{wake[1]};
+            if (!Detail::SetNonBlocking(wake[0]) || !Detail::SetNonBlocking(wake[1]))
+            {
+                continue;
+            }
+            if (m_endpoint.path.empty())
+            {
+                Detail::SetNoDelay(connection->socket.Get());
+            }
+            std::lock_guard lock(m_readersMutex);
+            std::erase_if(m_readers, [](const Reader &reader)
+                          { return reader.done->load(); });
+            Reader &reader = m_readers.emplace_back(Reader{std::make_unique<std::atomic<bool>>(false), connection, {}});
+            reader.thread = std::jthread([this, connection, done = reader.done.get()]
+                                         {
+                                             ServeConnection(connection);
+                                             {
+                                                 std::lock_guard lock(connection->mutex);
+                                                 connection->closed = true;
+                                             }
+                                             shutdown(connection->socket.Get(), SHUT_RDWR);
+                                             done->store(true); });
+        }
+    }
+
+    // Queues up to `limit` whole frames of `input` from `offset`. False on a
+    // frame whose size cannot be told, since nothing then tells where the
+    // next one starts.
+    inline bool QueueRequests(const std::shared_ptr<Connection> &connection, const std::vector<std::uint8_t> &input, std::size_t &offset, std::size_t limit, std::vector<Pending> &decoded)
+    {
+        const Clock::time_point arrival = Clock::now();
+        while (decoded.size() < limit)
+        {
+            const std::optional<RequestHeader> header = ReadRequestHeader(std::span<const std::uint8_t>(input).subspan(offset));
+            if (!header.has_value())
+            {
+                break;
+            }
+            const std::size_t frameSize = RequestFrameSize(*header);
+            if (frameSize == 0)
+            {
+                return false;
+            }
+            if (input.size() - offset < frameSize)
+            {
+                break;
+            }
+            const Clock::time_point deadline = header->deadlineMicros == 0 ? NoDeadline : arrival + std::chrono::microseconds(header->deadlineMicros);
+            decoded.push_back({connection, header->id, ParseRequest<N>(*header, input.data() + offset + SolveProtocol::RequestHeaderSize), arrival, deadline});
+            offset += frameSize;
+        }
+        if (decoded.empty())
+        {
+            return true;
+        }
+        {
+            std::lock_guard lock(connection->mutex);
+            connection->inFlight += decoded.size();
+        }
+        {
+            std::lock_guard lock(m_mutex);
+            m_queue.insert(m_queue.end(), std::make_move_iterator(decoded.begin()), std::make_move_iterator(decoded.end()));
+        }
+        m_queued.notify_one();
+        return true;
+    }
+
+    // Reads requests while the connection has fewer than maxInFlight
+    // unanswered and writes responses as the socket takes them. Returns when
+    // the client is gone, sends something that cannot be framed, or on
+    // Stop(); a client that shut down its writing side still gets its
+    // answers first.
+    inline void ServeConnection(const std::shared_ptr<Connection> &connection)
+    {
+        constexpr std::size_t readSize = 64 * 1024;
+        const int socket = connection->socket.Get();
+        std::vector<std::uint8_t> input;
+        std::size_t offset = 0;
+        // Responses taken from connection->output, sent up to `sent`.
+        std::vector<std::uint8_t> sending;
+        std::size_t sent = 0;
+        std::vector<Pending> decoded;
+        bool inputClosed = false;
+        while (true)
+        {
+            std::size_t unanswered;
+            {
+                std::lock_guard lock(connection->mutex);
+                if (sent == sending.size())
+                {
+                    sending.clear();
+                    sent = 0;
+                    std::swap(sending, connection->output);
+                }
+                unanswered = connection->inFlight + (connection->output.size() + sending.size() - sent + ResponseSize - 1) / ResponseSize;
+            }
+            if (unanswered < m_options.maxInFlight)
+            {
+                if (!QueueRequests(connection, input, offset, m_options.maxInFlight - unanswered, decoded))
+                {
+                    return;
+                }
+                unanswered += decoded.size();
+                decoded.clear();
+            }
+            const bool hasOutput = sent < sending.size();
+            if (inputClosed && unanswered == 0)
+            {
+                return;
+            }
+            const bool wantInput = !inputClosed && unanswered < m_options.maxInFlight;
+            pollfd fds[3] = {{socket, static_cast<short>((wantInput ? POLLIN : 0) | (hasOutput ? POLLOUT : 0)), 0}, {connection->wakeRead.Get(), POLLIN, 0}, {m_wakeRead.Get(), POLLIN, 0}};
+            if (poll(fds, 3, -1) < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return;
+            }
+            if (fds[2].revents != 0 || (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) != 0)
+            {
+                return;
+            }
+            if (fds[1].revents != 0)
+            {
+                char drained[64];
+                while (read(connection->wakeRead.Get(), drained, sizeof(drained)) > 0)
+                {
+                }
+            }
+            if ((fds[0].revents & POLLOUT) != 0)
+            {
+                const ssize_t written = send(socket, sending.data() + sent, sending.size() - sent, Detail::SendFlags);
+                if (written < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                {
+                    return;
+                }
+                sent += static_cast<std::size_t>(std::max<ssize_t>(written, 0));
+            }
+            if ((fds[0].revents & POLLIN) != 0)
+            {
+                input.erase(input.begin(), input.begin() + static_cast<std::ptrdiff_t>(offset));
+                offset = 0;
+                const std::size_t size = input.size();
+                input.resize(size + readSize);
+                const ssize_t received = recv(socket, input.data() + size, readSize, 0);
+                input.resize(size + static_cast<std::size_t>(std::max<ssize_t>(received, 0)));
+                if (received == 0)
+                {
+                    inputClosed = true;
+                }
+                else if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                {
+                    return;
+                }
+            }
+        }
+    }
+
+    inline void BatchLoop(std::stop_token stopToken)
+    {
+        std::vector<Pending> batch;
+        while (true)
+        {
+            {
+                std::unique_lock lock(m_mutex);
+                m_queued.wait(lock, [this]
+                              { return m_stopping || !m_queue.empty(); });
+                if (m_stopping)
+                {
+                    return;
+                }
+                m_queued.wait_until(lock, m_queue.front().arrival + m_options.batchWindow, [this]
+                                    { return m_stopping || m_queue.size() >= m_options.maxBatch; });
+                if (m_stopping)
+                {
+                    return;
+                }
+                const auto end = m_queue.begin() + static_cast<std::ptrdiff_t>(std::min(m_queue.size(), m_options.maxBatch));
+                batch.assign(std::make_move_iterator(m_queue.begin()), std::make_move_iterator(end));
+                m_queue.erase(m_queue.begin(), end);
+            }
+            RunBatch(batch, stopToken);
+            batch.clear();
+        }
+    }
+
+    // Appends a response for the connection's thread to send, waking the
+    // thread if it had nothing to send. Never blocks on the client.
+    inline void Answer(Connection &connection, std::uint32_t id, std::optional<SolveStatus> status, const SudokuMatrix<N> &board)
+    {
+        bool wake;
+        {
+            std::lock_guard lock(connection.mutex);
+            connection.inFlight--;
+            if (connection.closed)
+            {
+                return;
+            }
+            wake = connection.output.empty();
+            AppendResponse<N>(connection.output, id, status, board);
+        }
+        if (wake)
+        {
+            // A full pipe already holds a wake-up.
+            const char byte = 0;
+            [[maybe_unused]] const ssize_t written = write(connection.wakeWrite.Get(), &byte, 1);
+        }
+    }
+
+    inline void RunBatch(std::vector<Pending> &batch, std::stop_token stopToken)
+    {
+        m_batchCount++;
+        m_requestCount += batch.size();
+        for (const SolverKind kind : {SolverKind::BackTracking, SolverKind::Dlx, SolverKind::Propagation, SolverKind::Band})
+        {
+            m_puzzles.clear();
+            m_deadlines.clear();
+            m_indices.clear();
+            for (std::size_t i = 0; i < batch.size(); ++i)
+            {
+                if (batch[i].request.has_value() && batch[i].request->solver == kind)
+                {
+                    m_puzzles.push_back(batch[i].request->puzzle);
+                    m_deadlines.push_back(batch[i].deadline);
+                    m_indices.push_back(i);
+                }
+            }
+            if (m_indices.empty())
+            {
+                continue;
+            }
+            m_solutions.resize(m_puzzles.size());
+            m_statuses.resize(m_puzzles.size());
+            BatchOptions options;
+            options.maxSteps = m_options.maxSteps;
+            options.chunkSize = m_options.chunkSize;
+            options.stopToken = stopToken;
+            options.deadlines = m_deadlines;
+            const bool supported = VisitSolverKind<N>(kind, [&]<template <std::size_t> class Solver>()
+                                                      { SolveBatch<N, Solver>(m_pool, std::span<const SudokuMatrix<N>>(m_puzzles), std::span<SudokuMatrix<N>>(m_solutions), std::span<SolveStatus>(m_statuses), options); });
+            for (std::size_t j = 0; j < m_indices.size(); ++j)
+            {
+                const Pending &pending = batch[m_indices[j]];
+                Answer(*pending.connection, pending.id, supported ? std::optional<SolveStatus>(m_statuses[j]) : std::nullopt, m_solutions[j]);
+            }
+        }
+        for (const Pending &pending : batch)
+        {
+            if (!pending.request.has_value())
+            {
+                Answer(*pending.connection, pending.id, std::nullopt, SudokuMatrix<N>{});
+            }
+        }
+    }
+
+public:
+    SolveServer(const SolveServer &) = delete;
+    SolveServer &operator=(const SolveServer &) = delete;
+    ~SolveServer() { Stop(); }
+
+    // nullptr if the endpoint cannot be listened on. Returns once the
+    // solvers are warm and connections are accepted.
+    static std::unique_ptr<SolveServer> Start(ServiceEndpoint endpoint, const SolveServerOptions &options = {})
+    {
+        UniqueFd listener = ListenOn(endpoint);
+        int wake[2];
+        if (!listener || pipe(wake) != 0)
+        {
+            return nullptr;
+        }
+        std::unique_ptr<SolveServer> server(new SolveServer(endpoint, options, std::move(listener), UniqueFd{wake[0]}, UniqueFd{wake[1]}));
+        server->WarmSolvers();
+        server->m_batchThread = std::jthread([raw = server.get()](std::stop_token stopToken)
+                                             { raw->BatchLoop(stopToken); });
+        server->m_acceptThread = std::jthread([raw = server.get()]
+                                              { raw->AcceptLoop(); });
+        return server;
+    }
+
+    // Stops accepting, cancels the batch in flight, closes every connection
+    // and drops the requests not answered yet.
+    inline void Stop()
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            if (m_stopping)
+            {
+                return;
+            }
+            m_stopping = true;
+        }
+        m_queued.notify_all();
+        m_batchThread.request_stop();
+        const char wake = 0;
+        [[maybe_unused]] const ssize_t written = write(m_wakeWrite.Get(), &wake, 1);
+        if (m_acceptThread.joinable())
+        {
+            m_acceptThread.join();
+        }
+        if (m_batchThread.joinable())
+        {
+            m_batchThread.join();
+        }
+        {
+            std::lock_guard lock(m_readersMutex);
+            for (const Reader &reader : m_readers)
+            {
+                shutdown(reader.connection->socket.Get(), SHUT_RDWR);
+            }
+        }
+        m_readers.clear();
+        m_queue.clear();
+        m_listener.Reset();
+        if (!m_endpoint.path.empty())
+        {
+            unlink(m_endpoint.path.c_str());
+        }
+    }
+
+    // The endpoint listened on, with the bound port for a port 0 request.
+    inline const ServiceEndpoint &GetEndpoint() const noexcept
+    {
+        return m_endpoint;
+    }
+
+    inline std::uint64_t GetRequestCount() const noexcept
+    {
+        return m_requestCount.load();
+    }
+
+    inline std::uint64_t GetBatchCount() const noexcept
+    {
+        return m_batchCount.load();
+    }
+};
\ No newline at end of file
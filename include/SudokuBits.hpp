@@ -1,10 +1,15 @@
 #pragma once
 #include <array>
 #include <bit>
-#include <bitset>
-#include <boost/dynamic_bitset.hpp>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 #include <algorithm> // for std::fill_n, etc.
-#include <immintrin.h>
+#include "./BitKernels.hpp"
 
 template <std::size_t BITS>
 class FastBitset
@@ -15,22 +20,9 @@ class FastBitset
 
     std::array<std::uint64_t, NUM_CHUNKS> m_data{};
 
-    static inline int lzcnt_si256(const __m256i vec)
-    {
-        __m256i vnonzero = _mm256_cmpeq_epi32(vec, _mm256_setzero_si256());
-        std::uint32_t nzmask = ~_mm256_movemask_epi8(vnonzero); //  1 for bytes that are part of non-zero dwords
-        // nzmask |= 0xf;  // branchless clamp to last elem
-        if (nzmask == 0) // all 32 bits came from vpmovmskb, so NOT didn't introduce any constant 1s
-        {
-            return 256; // don't access outside the array
-        }
-        alignas(32) std::uint32_t elems[8];
-        _mm256_storeu_si256((__m256i *)elems, vec);
-        unsigned int lzbytes = _lzcnt_u32(nzmask); // bytes above the dword containing the nonzero bit.
-        unsigned char *end_elem = 28 + (unsigned char *)elems;
-        uint32_t *nz_elem = (uint32_t *)(end_elem - lzbytes); // idx = 31-(lzcnt+3) = 28-lzcnt
-        return 8 * lzbytes + _lzcnt_u32(*nz_elem);
-    }
+    // Wide sets go through the runtime-dispatched kernels; below this many
+    // words the inline scalar loop is cheaper than the indirect call.
+    static constexpr std::size_t DISPATCH_CHUNKS = 4;
 
 public:
     // Default constructor: all bits off
@@ -47,9 +39,11 @@ public:
     // Set bit 'pos' to 1 (if 'val' is true) or 0 (if 'val' is false)
     inline constexpr void set(std::size_t pos, bool val = true)
     {
-        if (pos >= BITS)
-            return; // out of range
+        // Checking the chunk index too lets GCC prove the access in bounds
+        // (-Warray-bounds).
         const std::size_t chunkIndex = pos / BITS_PER_CHUNK;
+        if (chunkIndex >= NUM_CHUNKS || pos >= BITS)
+            return; // out of range
         const std::size_t bitIndex = pos % BITS_PER_CHUNK;
         std::uint64_t mask = (std::uint64_t{1} << bitIndex);
         if (val)
@@ -63,9 +57,9 @@ public:
     // Reset a single bit (turn off)
     inline constexpr void reset(std::size_t pos)
     {
-        if (pos >= BITS)
-            return;
         const std::size_t chunkIndex = pos / BITS_PER_CHUNK;
+        if (chunkIndex >= NUM_CHUNKS || pos >= BITS)
+            return;
         const std::size_t bitIndex = pos % BITS_PER_CHUNK;
         m_data[chunkIndex] &= ~(std::uint64_t{1} << bitIndex);
     }
@@ -90,6 +84,13 @@ public:
     // Return total number of set bits
     inline constexpr int count() const
     {
+        if constexpr (NUM_CHUNKS >= DISPATCH_CHUNKS)
+        {
+            if (!std::is_constant_evaluated())
+            {
+                return static_cast<int>(ActiveBitKernels().popCount(m_data.data(), NUM_CHUNKS));
+            }
+        }
         int result = 0;
         for (const std::uint64_t chunk : m_data)
         {
@@ -125,61 +126,198 @@ public:
         return !(lhs == rhs);
     }
 
+    inline constexpr FastBitset &operator&=(const FastBitset &other)
+    {
+        for (std::size_t i = 0; i < NUM_CHUNKS; ++i)
+            m_data[i] &= other.m_data[i];
+        return *this;
+    }
+
+    inline constexpr FastBitset &operator|=(const FastBitset &other)
+    {
+        for (std::size_t i = 0; i < NUM_CHUNKS; ++i)
+            m_data[i] |= other.m_data[i];
+        return *this;
+    }
+
+    inline constexpr FastBitset &operator^=(const FastBitset &other)
+    {
+        for (std::size_t i = 0; i < NUM_CHUNKS; ++i)
+            m_data[i] ^= other.m_data[i];
+        return *this;
+    }
+
+    inline friend constexpr FastBitset operator&(FastBitset lhs, const FastBitset &rhs)
+    {
+        return lhs &= rhs;
+    }
+
+    inline friend constexpr FastBitset operator|(FastBitset lhs, const FastBitset &rhs)
+    {
+        return lhs |= rhs;
+    }
+
+    inline friend constexpr FastBitset operator^(FastBitset lhs, const FastBitset &rhs)
+    {
+        return lhs ^= rhs;
+    }
+
+    // Complement restricted to the first BITS bits, so unused high bits stay off.
+    inline constexpr FastBitset operator~() const
+    {
+        FastBitset result;
+        for (std::size_t i = 0; i < NUM_CHUNKS; ++i)
+            result.m_data[i] = ~m_data[i];
+        if constexpr (BITS % BITS_PER_CHUNK != 0)
+        {
+            result.m_data[NUM_CHUNKS - 1] &= (std::uint64_t{1} << (BITS % BITS_PER_CHUNK)) - 1;
+        }
+        return result;
+    }
+
     // Return the least significant set bit index, or BITS if none is set.
-    constexpr std::size_t findLSB() const
+    inline constexpr std::size_t findLSB() const
     {
-#ifdef __AVX2__
-        // 1) Processamos em blocos de 4x64 bits (256 bits) por vez.
-        // Cada "for" verifica se 4 blocos são todos zero usando intrínsecos AVX2.
-        // Se forem todos zero, pulamos de imediato. Se não, checamos blocos
-        // individualmente na sequência.
-        constexpr std::size_t STEP = 4; // 4 blocos de 64 bits = 256 bits
-        std::size_t i = 0;
+        std::size_t bitPos;
+        if constexpr (NUM_CHUNKS >= DISPATCH_CHUNKS)
+        {
+            bitPos = std::is_constant_evaluated() ? BitKernels::FindFirstSetScalar(m_data.data(), NUM_CHUNKS)
+                                                  : ActiveBitKernels().findFirstSet(m_data.data(), NUM_CHUNKS);
+        }
+        else
+        {
+            bitPos = BitKernels::FindFirstSetScalar(m_data.data(), NUM_CHUNKS);
+        }
+        return bitPos < BITS ? bitPos : BITS;
+    }
+};
+
+// One bit per value of a unit: the narrowest native integer holding N * N
+// bits, or a multi-word FastBitset for boards with more than 64 values.
+template <std::size_t N>
+using UnitMask = std::conditional_t<(N * N <= 16), std::uint16_t,
+                                    std::conditional_t<(N * N <= 32), std::uint32_t,
+                                                       std::conditional_t<(N * N <= 64), std::uint64_t, FastBitset<N * N>>>>;
 
-        for (; i + STEP <= NUM_CHUNKS; i += STEP)
+// Operations on UnitMask<N>. The native-integer versions are plain ALU
+// instructions without branches.
+template <std::size_t N>
+struct UnitMaskTraits
+{
+    using MaskType = UnitMask<N>;
+    static constexpr std::size_t Bits = N * N;
+    static constexpr bool IsNative = std::is_unsigned_v<MaskType>;
+
+    static inline constexpr MaskType Bit(std::size_t index) noexcept
+    {
+        if constexpr (IsNative)
         {
-            // Carrega 256 bits (4 * 64) da memória
-            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&m_data[i]));
+            return static_cast<MaskType>(MaskType{1} << index);
+        }
+        else
+        {
+            MaskType mask;
+            mask.set(index);
+            return mask;
+        }
+    }
 
-            // Se todos bits de v forem zero, avança
-            if (_mm256_testz_si256(v, v) != 0)
-            {
-                continue;
-            }
-            int tz = lzcnt_si256(v);
-            std::size_t bitPos = i * BITS_PER_CHUNK + tz;
-            return (bitPos < BITS) ? bitPos : BITS;
+    static constexpr MaskType All = []()
+    {
+        if constexpr (IsNative)
+        {
+            return static_cast<MaskType>(Bits == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << (Bits % 64)) - 1);
+        }
+        else
+        {
+            return ~MaskType{};
         }
+    }();
 
-        // 2) Resto (caso a quantidade de blocos não seja múltipla de 4)
-        for (; i < NUM_CHUNKS; ++i)
+    // Values of the first N * N not in `mask`.
+    static inline constexpr MaskType Complement(const MaskType &mask) noexcept
+    {
+        if constexpr (IsNative)
         {
-            std::uint64_t chunk = m_data[i];
-            if (chunk != 0ULL)
-            {
-                unsigned tz = std::countr_zero(chunk);
-                std::size_t bitPos = i * BITS_PER_CHUNK + tz;
-                return (bitPos < BITS) ? bitPos : BITS;
-            }
+            return static_cast<MaskType>(~mask & All);
+        }
+        else
+        {
+            return ~mask;
+        }
+    }
+
+    static inline constexpr int Count(const MaskType &mask) noexcept
+    {
+        if constexpr (IsNative)
+        {
+            return std::popcount(mask);
+        }
+        else
+        {
+            return mask.count();
         }
+    }
 
-        return BITS; // Não encontrou nenhum bit set
+    static inline constexpr bool Any(const MaskType &mask) noexcept
+    {
+        if constexpr (IsNative)
+        {
+            return mask != 0;
+        }
+        else
+        {
+            return mask.any();
+        }
+    }
 
-#else
-        // Fallback escalar se não houver suporte a AVX2
-        for (std::size_t chunkIndex = 0; chunkIndex < NUM_CHUNKS; ++chunkIndex)
+    static inline constexpr bool Test(const MaskType &mask, std::size_t index) noexcept
+    {
+        if constexpr (IsNative)
         {
-            std::uint64_t chunk = m_data[chunkIndex];
-            if (chunk == 0ULL)
-            {
-                continue;
-            }
-            const unsigned tz = std::countr_zero(chunk);
-            const std::size_t bitPos = chunkIndex * BITS_PER_CHUNK + tz;
-            return (bitPos < BITS) ? bitPos : BITS;
+            return ((mask >> index) & 1) != 0;
+        }
+        else
+        {
+            return mask.test(index);
+        }
+    }
+
+    // Index of the lowest set bit; at least Bits if the mask is empty.
+    static inline constexpr std::size_t Lowest(const MaskType &mask) noexcept
+    {
+        if constexpr (IsNative)
+        {
+            return static_cast<std::size_t>(std::countr_zero(mask));
+        }
+        else
+        {
+            return mask.findLSB();
+        }
+    }
+
+    static inline constexpr void ClearLowest(MaskType &mask) noexcept
+    {
+        if constexpr (IsNative)
+        {
+            mask = static_cast<MaskType>(mask & (mask - 1));
+        }
+        else
+        {
+            mask.reset(mask.findLSB());
+        }
+    }
+
+    static inline constexpr void Reset(MaskType &mask, std::size_t index) noexcept
+    {
+        if constexpr (IsNative)
+        {
+            mask = static_cast<MaskType>(mask & ~(MaskType{1} << index));
+        }
+        else
+        {
+            mask.reset(index);
         }
-        return BITS;
-#endif
     }
 };
 
@@ -187,12 +325,13 @@ template <std::size_t N>
 struct BitSetIterator
 {
 public:
-    using FlagType = FastBitset<N * N>;
+    using FlagType = UnitMask<N>;
     using DataType = std::conditional_t<(N * N <= std::numeric_limits<std::uint8_t>::max()), std::uint8_t,
                                         std::conditional_t<(N * N <= std::numeric_limits<std::uint16_t>::max()), std::uint16_t,
                                                            std::conditional_t<(N * N <= std::numeric_limits<std::uint32_t>::max()), std::uint32_t, std::uint64_t>>>;
 
 private:
+    using Traits = UnitMaskTraits<N>;
     FlagType m_flag;
 
 public:
@@ -202,21 +341,14 @@ public:
     // ++ removes the least significant set bit.
     inline constexpr BitSetIterator &operator++()
     {
-        std::size_t idx = m_flag.findLSB();
-        if (idx < N * N)
-        {
-            // Reset that bit.
-            m_flag.reset(idx);
-        }
+        Traits::ClearLowest(m_flag);
         return *this;
     }
 
     // * returns the 1-based index of the least significant set bit.
     inline constexpr DataType operator*() const
     {
-        std::size_t idx = m_flag.findLSB();
-        // Original code adds 1 to the 0-based position:
-        return static_cast<DataType>(idx + 1);
+        return static_cast<DataType>(Traits::Lowest(m_flag) + 1);
     }
 
     // Compare iterators by comparing the underlying bitset.
@@ -246,34 +378,66 @@ public:
     // Returns the total number of set bits.
     inline constexpr int Count() const
     {
-        return m_flag.count();
+        return Traits::Count(m_flag);
     }
 
     inline constexpr bool Any() const
     {
-        return m_flag.any();
+        return Traits::Any(m_flag);
+    }
+
+    inline constexpr const FlagType &GetFlag() const
+    {
+        return m_flag;
     }
 };
 
+// Iterates the set bits of a runtime-sized mask kept in a few inline words,
+// so copying it never allocates.
 struct DynamicBitSetIterator
 {
 public:
     using DataType = std::uint8_t;
+    static constexpr std::size_t MaxWords = 4;
+    static constexpr std::size_t MaxBits = MaxWords * 64;
+    // Values are returned as DataType, which runs out before the words do.
+    static constexpr std::size_t MaxValue = std::min<std::size_t>(MaxBits, std::numeric_limits<DataType>::max());
 
 private:
-    using size_type = boost::dynamic_bitset<>::size_type;
-    boost::dynamic_bitset<> m_bitset;
-    size_type m_index;
-    size_type m_count;
+    static constexpr std::size_t NoIndex = MaxBits;
+    std::array<std::uint64_t, MaxWords> m_words{};
+    std::size_t m_index = NoIndex;
+    std::size_t m_count = 0;
+
+    inline std::size_t FindFrom(std::size_t word) const noexcept
+    {
+        for (; word < MaxWords; ++word)
+        {
+            if (m_words[word] != 0)
+            {
+                return word * 64 + static_cast<std::size_t>(std::countr_zero(m_words[word]));
+            }
+        }
+        return NoIndex;
+    }
 
 public:
-    DynamicBitSetIterator(const boost::dynamic_bitset<> &bitset) : m_bitset(bitset), m_index(0), m_count(bitset.count())
+    DynamicBitSetIterator() = default;
+    explicit DynamicBitSetIterator(std::span<const std::uint64_t> words)
     {
-        m_index = m_bitset.find_first();
+        assert(words.size() <= MaxWords);
+        std::copy(words.begin(), words.end(), m_words.begin());
+        for (const std::uint64_t word : words)
+        {
+            m_count += static_cast<std::size_t>(std::popcount(word));
+        }
+        m_index = FindFrom(0);
     }
     inline DynamicBitSetIterator &operator++()
     {
-        m_index = m_bitset.find_next(m_index);
+        const std::size_t word = m_index / 64;
+        m_words[word] &= m_words[word] - 1;
+        m_index = FindFrom(word);
         m_count--;
         return *this;
     }
@@ -285,13 +449,13 @@ public:
     {
         return m_index != other.m_index;
     }
-    inline DynamicBitSetIterator begin()
+    inline DynamicBitSetIterator begin() const
     {
-        return {m_bitset};
+        return *this;
     }
     static inline DynamicBitSetIterator end()
     {
-        return {boost::dynamic_bitset<>()};
+        return {};
     }
     inline std::size_t Count() const
     {
@@ -303,46 +467,77 @@ template <std::size_t N>
 struct SudokuBits
 {
 public:
-    using FlagType = std::bitset<N * N>;
+    using FlagType = UnitMask<N>;
     using DataType = typename BitSetIterator<N>::DataType;
 
 private:
+    using Traits = UnitMaskTraits<N>;
     std::array<FlagType, N * N * 3> m_bits;
     static constexpr std::size_t size = N * N;
-    static constexpr FlagType AllBitsSet = []()
-    {
-        FlagType bits;
-        bits.set();
-        return bits;
-    }();
 
 public:
     inline constexpr void SetValue(std::size_t row, std::size_t col, std::size_t square, DataType value)
     {
-        FlagType mask = 1ULL << (value - 1);
+        const FlagType mask = Traits::Bit(value - 1);
         m_bits[row] |= mask;
         m_bits[size + col] |= mask;
         m_bits[size * 2 + square] |= mask;
     }
 
+    // Bit of each value, none for an empty cell.
+    static constexpr std::array<FlagType, size + 1> ValueMasks = []()
+    {
+        std::array<FlagType, size + 1> masks{};
+        for (std::size_t value = 1; value <= size; ++value)
+        {
+            masks[value] = Traits::Bit(value - 1);
+        }
+        return masks;
+    }();
+
+    // Marks the values of a whole row-major board, a square's worth of cells
+    // at a time so that row and square masks build up in registers. Empty
+    // cells map to an empty mask instead of a branch, since they are
+    // unpredictable on a parsed or generated board.
+    inline constexpr void AddBoard(const DataType *cells)
+    {
+        // A local copy, since the cells' byte type may alias m_bits.
+        std::array<FlagType, N * N * 3> bits = m_bits;
+        for (std::size_t row = 0; row < size; ++row)
+        {
+            FlagType rowMask{};
+            for (std::size_t stack = 0; stack < N; ++stack)
+            {
+                FlagType squareMask{};
+                for (std::size_t col = stack * N; col < (stack + 1) * N; ++col)
+                {
+                    const FlagType &mask = ValueMasks[cells[row * size + col]];
+                    squareMask |= mask;
+                    bits[size + col] |= mask;
+                }
+                rowMask |= squareMask;
+                bits[size * 2 + (row / N) * N + stack] |= squareMask;
+            }
+            bits[row] |= rowMask;
+        }
+        m_bits = bits;
+    }
+
     inline constexpr void ResetValue(std::size_t row, std::size_t col, std::size_t square, DataType value)
     {
-        FlagType mask = ~(1 << (value - 1));
-        m_bits[row] &= mask;
-        m_bits[size + col] &= mask;
-        m_bits[size * 2 + square] &= mask;
+        Traits::Reset(m_bits[row], value - 1);
+        Traits::Reset(m_bits[size + col], value - 1);
+        Traits::Reset(m_bits[size * 2 + square], value - 1);
     }
 
     inline constexpr bool Test(std::size_t row, std::size_t col, std::size_t square, DataType value) const
     {
-        FlagType mask = 1ULL << (value - 1);
-        return (m_bits[row] & mask) != 0 && (m_bits[size + col] & mask) != 0 && (m_bits[size * 2 + square] & mask) != 0;
+        return Traits::Test(static_cast<FlagType>(m_bits[row] & m_bits[size + col] & m_bits[size * 2 + square]), value - 1);
     }
 
     inline constexpr FlagType GetAvailableValues(std::size_t row, std::size_t col, std::size_t square) const
     {
-        FlagType usedBits = m_bits[row] | m_bits[size + col] | m_bits[size * 2 + square];
-        return static_cast<FlagType>(~usedBits & AllBitsSet);
+        return Traits::Complement(static_cast<FlagType>(m_bits[row] | m_bits[size + col] | m_bits[size * 2 + square]));
     }
 
     inline constexpr const std::array<FlagType, N * N * 3> &GetBits() const
@@ -351,50 +546,99 @@ public:
     }
 };
 
+// Row, column and square masks share one word arena: unit i owns the
+// m_wordStride words starting at i * m_wordStride.
 struct SudokuDynamicBits
 {
 public:
     using DataType = typename DynamicBitSetIterator::DataType;
 
 private:
-    boost::dynamic_bitset<> m_allBitsSet;
-    std::vector<boost::dynamic_bitset<>> m_bits;
     std::size_t m_size;
+    std::size_t m_wordStride;
+    std::uint64_t m_lastWordMask;
+    std::vector<std::uint64_t> m_words;
+
+    inline std::uint64_t *Unit(std::size_t unit) noexcept
+    {
+        return m_words.data() + unit * m_wordStride;
+    }
+    inline const std::uint64_t *Unit(std::size_t unit) const noexcept
+    {
+        return m_words.data() + unit * m_wordStride;
+    }
+
+    // Runs before m_words is sized, so an oversized board never allocates.
+    static inline std::size_t ValidateValueCount(std::size_t valueCount)
+    {
+        if (valueCount > DynamicBitSetIterator::MaxValue)
+        {
+            throw std::length_error("SudokuDynamicBits: more values per unit than DynamicBitSetIterator holds");
+        }
+        return valueCount;
+    }
 
 public:
-    SudokuDynamicBits(std::size_t size) : m_allBitsSet(size * size), m_bits(size * size * 3, boost::dynamic_bitset<>(size * size)), m_size(size * size)
+    SudokuDynamicBits(std::size_t size)
+        : m_size(size * size),
+          m_wordStride((size * size + 63) / 64),
+          m_lastWordMask(m_size % 64 == 0 ? ~std::uint64_t{0} : (std::uint64_t{1} << (m_size % 64)) - 1),
+          m_words(ValidateValueCount(m_size) * 3 * m_wordStride, 0)
     {
-        m_allBitsSet.set();
     }
     inline void SetValue(std::size_t row, std::size_t col, std::size_t square, DataType value)
     {
         assert(value >= 1 && value <= m_size);
-        std::size_t index = static_cast<std::size_t>(value - 1);
-        m_bits[row].set(index);
-        m_bits[m_size + col].set(index);
-        m_bits[m_size * 2 + square].set(index);
+        const std::size_t index = static_cast<std::size_t>(value - 1);
+        const std::size_t word = index / 64;
+        const std::uint64_t mask = std::uint64_t{1} << (index % 64);
+        Unit(row)[word] |= mask;
+        Unit(m_size + col)[word] |= mask;
+        Unit(m_size * 2 + square)[word] |= mask;
     }
     inline void ResetValue(std::size_t row, std::size_t col, std::size_t square, DataType value)
     {
         assert(value >= 1 && value <= m_size);
-        std::size_t index = static_cast<std::size_t>(value - 1);
-        m_bits[row].reset(index);
-        m_bits[m_size + col].reset(index);
-        m_bits[m_size * 2 + square].reset(index);
+        const std::size_t index = static_cast<std::size_t>(value - 1);
+        const std::size_t word = index / 64;
+        const std::uint64_t mask = ~(std::uint64_t{1} << (index % 64));
+        Unit(row)[word] &= mask;
+        Unit(m_size + col)[word] &= mask;
+        Unit(m_size * 2 + square)[word] &= mask;
     }
     inline bool Test(std::size_t row, std::size_t col, std::size_t square, DataType value) const
     {
         assert(value >= 1 && value <= m_size);
-        std::size_t index = static_cast<std::size_t>(value - 1);
-        return m_bits[row].test(index) && m_bits[m_size + col].test(index) && m_bits[m_size * 2 + square].test(index);
+        const std::size_t index = static_cast<std::size_t>(value - 1);
+        const std::size_t word = index / 64;
+        const std::uint64_t mask = std::uint64_t{1} << (index % 64);
+        return (Unit(row)[word] & Unit(m_size + col)[word] & Unit(m_size * 2 + square)[word] & mask) != 0;
+    }
+    // Writes the values free in the row, column and square into `out`, which
+    // must hold GetWordStride() words.
+    inline void GetAvailableValues(std::size_t row, std::size_t col, std::size_t square, std::span<std::uint64_t> out) const
+    {
+        assert(out.size() >= m_wordStride);
+        const std::uint64_t *rowBits = Unit(row);
+        const std::uint64_t *colBits = Unit(m_size + col);
+        const std::uint64_t *squareBits = Unit(m_size * 2 + square);
+        for (std::size_t word = 0; word < m_wordStride; ++word)
+        {
+            out[word] = ~(rowBits[word] | colBits[word] | squareBits[word]);
+        }
+        out[m_wordStride - 1] &= m_lastWordMask;
     }
-    inline boost::dynamic_bitset<> GetAvailableValues(std::size_t row, std::size_t col, std::size_t square) const
+    inline std::size_t GetWordStride() const noexcept
     {
-        boost::dynamic_bitset<> usedBits = m_bits[row] | m_bits[m_size + col] | m_bits[m_size * 2 + square];
-        return ~usedBits & m_allBitsSet;
+        return m_wordStride;
     }
-    inline const std::vector<boost::dynamic_bitset<>> &GetBits() const
+    inline std::size_t GetUnitCount() const noexcept
     {
-        return m_bits;
+        return 3 * m_size;
+    }
+    // Rows first, then columns, then squares, as in SudokuBits.
+    inline std::span<const std::uint64_t> GetUnit(std::size_t unit) const noexcept
+    {
+        return {Unit(unit), m_wordStride};
     }
 };
\ No newline at end of file
@@ -1,12 +1,15 @@
 #pragma once
 #include "./SudokuBits.hpp"
 #include <cmath>
+#include <span>
+#include <vector>
 
 template <std::size_t N>
 class SudokuMatrix
 {
 public:
     using DataType = typename BitSetIterator<N>::DataType;
+    using MaskType = UnitMask<N>;
 
 private:
     std::array<DataType, N * N * N * N> m_data;
@@ -33,42 +36,12 @@ public:
 
     constexpr SudokuMatrix(const std::array<DataType, N * N * N * N> &data) : m_data(data), m_dataBits({})
     {
-        constexpr std::size_t size = N * N;
-        // Inicializa os bitsets para marcar os valores presentes na matriz inicial
-        for (std::size_t row = 0; row < size; ++row)
-        {
-            for (std::size_t col = 0; col < size; ++col)
-            {
-                DataType value = data[MatrixIndex(row, col)];
-                if (value == 0)
-                {
-                    continue;
-                }
-                std::size_t squareIndex = SquareIndex(row, col);
-                // Marca os valores nos bitsets correspondentes
-                m_dataBits.SetValue(row, col, squareIndex, value);
-            }
-        }
+        m_dataBits.AddBoard(m_data.data());
     }
 
     constexpr SudokuMatrix(std::array<DataType, N * N * N * N> &&data) : m_data(std::move(data)), m_dataBits({})
     {
-        constexpr std::size_t size = N * N;
-        // Inicializa os bitsets para marcar os valores presentes na matriz inicial
-        for (std::size_t row = 0; row < size; ++row)
-        {
-            for (std::size_t col = 0; col < size; ++col)
-            {
-                DataType value = m_data[MatrixIndex(row, col)];
-                if (value == 0)
-                {
-                    continue;
-                }
-                std::size_t squareIndex = SquareIndex(row, col);
-                // Marca os valores nos bitsets correspondentes
-                m_dataBits.SetValue(row, col, squareIndex, value);
-            }
-        }
+        m_dataBits.AddBoard(m_data.data());
     }
 
     constexpr SudokuMatrix(const SudokuMatrix<N> &other)
@@ -157,9 +130,7 @@ public:
 
     inline constexpr BitSetIterator<N> GetPossibleValues(std::size_t row, std::size_t col, std::size_t squareIndex) const
     {
-        using IntType = typename BitSetIterator<N>::FlagType;
-        auto availableValues = m_dataBits.GetAvailableValues(row, col, squareIndex);
-        return {static_cast<IntType>(availableValues.to_ullong())};
+        return {m_dataBits.GetAvailableValues(row, col, squareIndex)};
     }
 
     inline constexpr BitSetIterator<N> GetPossibleValues(std::size_t row, std::size_t col) const
@@ -167,6 +138,79 @@ public:
         return GetPossibleValues(row, col, SquareIndex(row, col));
     }
 
+    // Whether a value appears twice in a row, column or square. The unit masks
+    // only record that a value is present, so the cells are scanned instead.
+    inline constexpr bool HasRepeatedValue() const noexcept
+    {
+        using Traits = UnitMaskTraits<N>;
+        constexpr std::size_t size = N * N;
+        std::array<MaskType, 3 * size> seen{};
+        for (std::size_t row = 0; row < size; ++row)
+        {
+            for (std::size_t col = 0; col < size; ++col)
+            {
+                const DataType value = m_data[MatrixIndex(row, col)];
+                if (value == 0)
+                {
+                    continue;
+                }
+                for (MaskType *unit : {&seen[row], &seen[size + col], &seen[2 * size + SquareIndex(row, col)]})
+                {
+                    if (Traits::Test(*unit, value - 1u))
+                    {
+                        return true;
+                    }
+                    *unit |= Traits::Bit(value - 1u);
+                }
+            }
+        }
+        return false;
+    }
+
+    // Writes the candidate mask of every cell to `candidates` in one pass, zero
+    // for filled cells, and its number of candidates to `counts` unless that
+    // is empty. Both are indexed by MatrixIndex.
+    inline constexpr void ComputeAllCandidates(std::span<MaskType> candidates, std::span<DataType> counts = {}) const
+    {
+        using Traits = UnitMaskTraits<N>;
+        constexpr std::size_t size = N * N;
+        assert(candidates.size() >= size * size && (counts.empty() || counts.size() >= size * size));
+        const auto &units = m_dataBits.GetBits();
+        if constexpr (N >= 2 && std::is_same_v<MaskType, std::uint16_t>)
+        {
+            if (!std::is_constant_evaluated() && GetSimdLevel() != SimdLevel::Scalar)
+            {
+                BitKernels::ComputeCandidates16Avx2<N>(units.data(), m_data.data(), Traits::All, candidates.data(),
+                                                       counts.empty() ? nullptr : counts.data());
+                return;
+            }
+        }
+        const bool withCounts = !counts.empty();
+        for (std::size_t row = 0; row < size; ++row)
+        {
+            const MaskType &rowUsed = units[row];
+            const MaskType *squares = units.data() + 2 * size + (row / N) * N;
+            for (std::size_t col = 0; col < size; ++col)
+            {
+                const std::size_t index = MatrixIndex(row, col);
+                if (m_data[index] != 0)
+                {
+                    candidates[index] = MaskType{};
+                    if (withCounts)
+                    {
+                        counts[index] = 0;
+                    }
+                    continue;
+                }
+                candidates[index] = Traits::Complement(static_cast<MaskType>(rowUsed | units[size + col] | squares[col / N]));
+                if (withCounts)
+                {
+                    counts[index] = static_cast<DataType>(Traits::Count(candidates[index]));
+                }
+            }
+        }
+    }
+
     inline constexpr void RemoveValue(std::size_t row, std::size_t col, std::size_t index, std::size_t squareIndex)
     {
         SetValue(row, col, index, squareIndex, 0); // Define o valor como zero, removendo-o
@@ -187,6 +231,114 @@ public:
     {
         return m_dataBits.GetBits();
     }
+
+    inline constexpr const std::array<DataType, N * N * N * N> &GetData() const noexcept
+    {
+        return m_data;
+    }
+};
+
+// Undo log for a SudokuMatrix<N>. Changes made through SetValue/RemoveValue
+// here record the cell's previous value, and RollbackTo undoes them. Unit
+// masks follow from the values, so undoing the values restores them as well.
+// A change can also list the peers it touched in a structure layered over the
+// board (a CandidateCache), handed back to the caller on rollback.
+// The log lives outside the board, so boards that are never rolled back do not
+// carry or check it.
+template <std::size_t N>
+class SudokuTrail
+{
+public:
+    using DataType = typename SudokuMatrix<N>::DataType;
+    using IndexType = std::conditional_t<(N * N * N * N <= std::numeric_limits<std::uint16_t>::max()), std::uint16_t, std::uint32_t>;
+
+private:
+    // The value a cell held before a SetValue, and how many peers follow it
+    // in m_peers.
+    struct Entry
+    {
+        IndexType index;
+        IndexType peerCount;
+        DataType previous;
+    };
+
+    std::vector<Entry> m_entries;
+    std::vector<IndexType> m_peers;
+
+public:
+    inline constexpr void SetValue(SudokuMatrix<N> &board, std::size_t row, std::size_t col, std::size_t index, std::size_t squareIndex, DataType value)
+    {
+        m_entries.push_back({static_cast<IndexType>(index), 0, board.GetValue(index)});
+        board.SetValue(row, col, index, squareIndex, value);
+    }
+
+    inline constexpr void SetValue(SudokuMatrix<N> &board, std::size_t row, std::size_t col, DataType value)
+    {
+        SetValue(board, row, col, SudokuMatrix<N>::MatrixIndex(row, col), SudokuMatrix<N>::SquareIndex(row, col), value);
+    }
+
+    inline constexpr void RemoveValue(SudokuMatrix<N> &board, std::size_t row, std::size_t col)
+    {
+        SetValue(board, row, col, 0);
+    }
+
+    // Adds `peer` to the peers of the last change.
+    inline constexpr void RecordPeer(std::size_t peer)
+    {
+        m_peers.push_back(static_cast<IndexType>(peer));
+        m_entries.back().peerCount++;
+    }
+
+    // Mark for RollbackTo.
+    inline constexpr std::size_t Checkpoint() const noexcept
+    {
+        return m_entries.size();
+    }
+
+    // Undoes every change recorded since `checkpoint` on `board`, newest
+    // first, and calls undone(index, value, peers) once each cell holds its
+    // previous value again, with the value it lost and the peers recorded
+    // with it. Later changes are recorded again, so the same checkpoint can be
+    // reused.
+    template <class Undone>
+    inline constexpr void RollbackTo(SudokuMatrix<N> &board, std::size_t checkpoint, Undone &&undone)
+    {
+        while (m_entries.size() > checkpoint)
+        {
+            const Entry entry = m_entries.back();
+            m_entries.pop_back();
+            const std::size_t row = entry.index / (N * N);
+            const std::size_t col = entry.index % (N * N);
+            const DataType value = board.GetValue(entry.index);
+            board.SetValue(row, col, entry.index, SudokuMatrix<N>::SquareIndex(row, col), entry.previous);
+            const std::size_t first = m_peers.size() - entry.peerCount;
+            undone(static_cast<std::size_t>(entry.index), value, std::span<const IndexType>(m_peers.data() + first, entry.peerCount));
+            m_peers.resize(first);
+        }
+    }
+
+    inline constexpr void RollbackTo(SudokuMatrix<N> &board, std::size_t checkpoint)
+    {
+        RollbackTo(board, checkpoint, [](std::size_t, DataType, std::span<const IndexType>) {});
+    }
+
+    inline constexpr void Clear() noexcept
+    {
+        m_entries.clear();
+        m_peers.clear();
+    }
+
+    // Room for `entries` changes touching `peers` peers in all.
+    inline constexpr void Reserve(std::size_t entries, std::size_t peers)
+    {
+        m_entries.reserve(entries);
+        m_peers.reserve(peers);
+    }
+
+    inline constexpr std::size_t Size() const noexcept
+    {
+        return m_entries.size();
+    }
 };
 
 class DynamicSudokuMatrix
@@ -336,7 +488,10 @@ public:
 
     inline DynamicBitSetIterator GetPossibleValues(std::size_t row, std::size_t col, std::size_t squareIndex) const
     {
-        return {m_dataBits.GetAvailableValues(row, col, squareIndex)};
+        std::array<std::uint64_t, DynamicBitSetIterator::MaxWords> words{};
+        const std::span<std::uint64_t> available(words.data(), m_dataBits.GetWordStride());
+        m_dataBits.GetAvailableValues(row, col, squareIndex, available);
+        return DynamicBitSetIterator(available);
     }
 
     inline DynamicBitSetIterator GetPossibleValues(std::size_t row, std::size_t col) const
@@ -344,6 +499,37 @@ public:
         return GetPossibleValues(row, col, SquareIndex(row, col));
     }
 
+    // Whether a value appears twice in a row, column or square, as in
+    // SudokuMatrix.
+    inline bool HasRepeatedValue() const
+    {
+        const std::size_t stride = m_dataBits.GetWordStride();
+        std::vector<std::uint64_t> seen(3 * m_rowSize * stride, 0);
+        for (std::size_t row = 0; row < m_rowSize; ++row)
+        {
+            for (std::size_t col = 0; col < m_rowSize; ++col)
+            {
+                const DataType value = m_data[MatrixIndex(row, col)];
+                if (value == 0)
+                {
+                    continue;
+                }
+                const std::size_t bit = static_cast<std::size_t>(value - 1);
+                const std::uint64_t mask = std::uint64_t{1} << (bit % 64);
+                for (const std::size_t unit : {row, m_rowSize + col, 2 * m_rowSize + SquareIndex(row, col)})
+                {
+                    std::uint64_t &word = seen[unit * stride + bit / 64];
+                    if ((word & mask) != 0)
+                    {
+                        return true;
+                    }
+                    word |= mask;
+                }
+            }
+        }
+        return false;
+    }
+
     inline void RemoveValue(std::size_t row, std::size_t col, std::size_t index, std::size_t squareIndex)
     {
         SetValue(row, col, index, squareIndex, 0);
@@ -365,8 +551,8 @@ public:
         return m_size;
     }
 
-    inline const std::vector<boost::dynamic_bitset<>> &GetBits() const noexcept
+    inline const SudokuDynamicBits &GetBits() const noexcept
     {
-        return m_dataBits.GetBits();
+        return m_dataBits;
     }
 };
\ No newline at end of file
@@ -39,7 +39,7 @@ SudokuMatrix<N> CreateBoard(const float probabilityOfFilled, pcg64 &randomDevice
     return board;
 }
 
-DynamicSudokuMatrix CreateBoard(const std::size_t size, const float probabilityOfFilled, pcg64 &randomDevice)
+inline DynamicSudokuMatrix CreateBoard(const std::size_t size, const float probabilityOfFilled, pcg64 &randomDevice)
 {
     DynamicSudokuMatrix board(size);
     // Gerador de números aleatórios
@@ -96,7 +96,7 @@ constexpr bool IsValidSudoku(const SudokuMatrix<N> &board)
     return true;
 }
 
-bool IsValidSudoku(const DynamicSudokuMatrix &board)
+inline bool IsValidSudoku(const DynamicSudokuMatrix &board)
 {
     std::size_t size = board.GetSize();
     DynamicSudokuMatrix testBoard(size);
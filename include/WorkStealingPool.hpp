@@ -0,0 +1,181 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+// Persistent pool where every worker owns a task deque. Workers pop their own
+// tasks from the back and steal from the front of the other deques when idle.
+// Only threads outside the pool may block on it: a task waiting for other
+// tasks of its own pool holds the worker they may need.
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::jthread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable_any m_wakeUp;
+    std::condition_variable m_idle;
+    std::size_t m_queued = 0;
+    std::size_t m_pending = 0;
+    std::size_t m_nextQueue = 0;
+
+    // Pool whose worker loop runs on the calling thread, if any.
+    static inline const WorkStealingPool *&CurrentPool() noexcept
+    {
+        thread_local const WorkStealingPool *pool = nullptr;
+        return pool;
+    }
+
+    inline bool TryPop(std::size_t worker, Task &task)
+    {
+        WorkerQueue &queue = *m_queues[worker];
+        std::lock_guard lock(queue.mutex);
+        if (queue.tasks.empty())
+        {
+            return false;
+        }
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    inline bool TrySteal(std::size_t worker, Task &task)
+    {
+        const std::size_t count = m_queues.size();
+        for (std::size_t offset = 1; offset < count; ++offset)
+        {
+            WorkerQueue &queue = *m_queues[(worker + offset) % count];
+            std::lock_guard lock(queue.mutex);
+            if (queue.tasks.empty())
+            {
+                continue;
+            }
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    inline void WorkerLoop(std::stop_token stopToken, std::size_t worker)
+    {
+        CurrentPool() = this;
+        while (true)
+        {
+            Task task;
+            if (TryPop(worker, task) || TrySteal(worker, task))
+            {
+                {
+                    std::lock_guard lock(m_mutex);
+                    m_queued--;
+                }
+                task();
+                std::lock_guard lock(m_mutex);
+                if (--m_pending == 0)
+                {
+                    m_idle.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock lock(m_mutex);
+            if (!m_wakeUp.wait(lock, stopToken, [this]
+                               { return m_queued != 0; }))
+            {
+                return;
+            }
+        }
+    }
+
+public:
+    explicit WorkStealingPool(std::size_t threadCount = std::thread::hardware_concurrency())
+    {
+        threadCount = std::max<std::size_t>(threadCount, 1);
+        m_queues.reserve(threadCount);
+        for (std::size_t i = 0; i < threadCount; ++i)
+        {
+            m_queues.push_back(std::make_unique<WorkerQueue>());
+        }
+        m_threads.reserve(threadCount);
+        for (std::size_t i = 0; i < threadCount; ++i)
+        {
+            m_threads.emplace_back([this, i](std::stop_token stopToken)
+                                   { WorkerLoop(stopToken, i); });
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    ~WorkStealingPool()
+    {
+        for (auto &thread : m_threads)
+        {
+            thread.request_stop();
+        }
+        // Join before the synchronization members are destroyed.
+        m_threads.clear();
+    }
+
+    inline std::size_t Size() const noexcept
+    {
+        return m_threads.size();
+    }
+
+    // Whether the calling thread is one of this pool's workers.
+    inline bool IsWorkerThread() const noexcept
+    {
+        return CurrentPool() == this;
+    }
+
+    // Queues the task on a specific worker; other workers may still steal it.
+    inline void Submit(std::size_t worker, Task task)
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_queued++;
+            m_pending++;
+        }
+        {
+            WorkerQueue &queue = *m_queues[worker % m_queues.size()];
+            std::lock_guard lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        m_wakeUp.notify_one();
+    }
+
+    inline void Submit(Task task)
+    {
+        std::size_t worker;
+        {
+            std::lock_guard lock(m_mutex);
+            worker = m_nextQueue++ % m_queues.size();
+        }
+        Submit(worker, std::move(task));
+    }
+
+    // Blocks until every submitted task has finished. Must not be called from
+    // a task of this pool, which would wait for itself.
+    inline void Wait()
+    {
+        assert(!IsWorkerThread());
+        std::unique_lock lock(m_mutex);
+        m_idle.wait(lock, [this]
+                    { return m_pending == 0; });
+    }
+};
\ No newline at end of file
@@ -0,0 +1,230 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+#include "./BackTracking.hpp"
+#include "./BandSolver.hpp"
+#include "./DlxSolver.hpp"
+#include "./PropagationSolver.hpp"
+#include "./SearchStats.hpp"
+#include "./SolveResult.hpp"
+
+enum class SolverKind : std::uint8_t
+{
+    BackTracking,
+    Dlx,
+    Propagation,
+    Band
+};
+
+inline constexpr std::optional<SolverKind> ParseSolverKind(std::string_view name) noexcept
+{
+    if (name == "backtrack")
+    {
+        return SolverKind::BackTracking;
+    }
+    if (name == "dlx")
+    {
+        return SolverKind::Dlx;
+    }
+    if (name == "propagation")
+    {
+        return SolverKind::Propagation;
+    }
+    if (name == "band")
+    {
+        return SolverKind::Band;
+    }
+    return std::nullopt;
+}
+
+// Box sizes with a compiled SudokuMatrix<N> instantiation.
+inline constexpr std::size_t MinStaticBoardSize = 2;
+inline constexpr std::size_t MaxStaticBoardSize = 7;
+// Largest box whose N*N values fit DynamicBitSetIterator::MaxValue: 15, since
+// the 256 values of a 16 box overflow the uint8_t cells.
+inline constexpr std::size_t MaxDynamicBoardSize = []()
+{
+    std::size_t size = 1;
+    while ((size + 1) * (size + 1) <= DynamicBitSetIterator::MaxValue)
+    {
+        size++;
+    }
+    return size;
+}();
+
+namespace Detail
+{
+    template <std::size_t First, class Visitor, class Fallback, std::size_t... Offsets>
+    inline auto VisitBoardSize(std::size_t size, Visitor &&visitor, Fallback &&fallback, std::index_sequence<Offsets...>)
+    {
+        using Result = decltype(fallback());
+        std::optional<Result> result;
+        ((size == First + Offsets ? (result.emplace(visitor(std::integral_constant<std::size_t, First + Offsets>{})), true) : false) || ...);
+        if (!result.has_value())
+        {
+            return fallback();
+        }
+        return std::move(*result);
+    }
+}
+
+// Calls visitor(std::integral_constant<std::size_t, N>{}) when N == size has a
+// static instantiation, fallback() otherwise. Both must return the same type.
+template <class Visitor, class Fallback>
+inline auto VisitBoardSize(std::size_t size, Visitor &&visitor, Fallback &&fallback)
+{
+    return Detail::VisitBoardSize<MinStaticBoardSize>(size, std::forward<Visitor>(visitor), std::forward<Fallback>(fallback),
+                                                      std::make_index_sequence<MaxStaticBoardSize - MinStaticBoardSize + 1>{});
+}
+
+// Calls visitor.template operator()<Solver>() with the solver template of
+// `kind`. Returns false if that solver has no instantiation for N or needs
+// instructions above GetSimdLevel(), which SUDOKU_SIMD can lower.
+template <std::size_t N, class Visitor>
+inline bool VisitSolverKind(SolverKind kind, Visitor &&visitor)
+{
+    switch (kind)
+    {
+    case SolverKind::BackTracking:
+        visitor.template operator()<BackTrackingSolver>();
+        return true;
+    case SolverKind::Dlx:
+        visitor.template operator()<DLXSolver>();
+        return true;
+    case SolverKind::Propagation:
+        visitor.template operator()<PropagationSolver>();
+        return true;
+    case SolverKind::Band:
+        if constexpr (N == 3)
+        {
+            if (GetSimdLevel() >= SimdLevel::Avx2)
+            {
+                visitor.template operator()<BandSolver>();
+                return true;
+            }
+        }
+        return false;
+    }
+    return false;
+}
+
+// Type-erased solver for a box size only known at run time. Supported sizes
+// dispatch once to the static Solver<N>; larger boards fall back to
+// DynamicBackTrackingSolver, whatever the requested kind.
+class AnySolver
+{
+public:
+    using DataType = DynamicSudokuMatrix::DataType;
+
+private:
+    class Concept
+    {
+    public:
+        virtual bool Advance() = 0;
+        virtual SolveResult Solve(std::uint64_t maxSteps) = 0;
+        virtual SolveResult Solve(const SolveLimits &limits) = 0;
+        virtual AdvanceResult GetStatus() const noexcept = 0;
+        virtual bool IsSolved() const noexcept = 0;
+        virtual SearchStats GetStats() const noexcept = 0;
+        virtual DataType GetValue(std::size_t row, std::size_t col) const = 0;
+        virtual ~Concept() = default;
+    };
+
+    template <std::size_t N, template <std::size_t> class Solver>
+    class StaticModel final : public Concept
+    {
+        Solver<N> m_solver;
+
+    public:
+        StaticModel(const SudokuMatrix<N> &data) : m_solver(data) {}
+        bool Advance() override { return m_solver.Advance(); }
+        SolveResult Solve(std::uint64_t maxSteps) override { return m_solver.Solve(maxSteps); }
+        SolveResult Solve(const SolveLimits &limits) override { return m_solver.Solve(limits); }
+        AdvanceResult GetStatus() const noexcept override { return m_solver.GetStatus(); }
+        bool IsSolved() const noexcept override { return m_solver.IsSolved(); }
+        SearchStats GetStats() const noexcept override { return m_solver.GetStats(); }
+        DataType GetValue(std::size_t row, std::size_t col) const override
+        {
+            return static_cast<DataType>(m_solver.GetBoard().GetValue(row, col));
+        }
+    };
+
+    class DynamicModel final : public Concept
+    {
+        DynamicBackTrackingSolver m_solver;
+
+    public:
+        DynamicModel(DynamicSudokuMatrix &&data) : m_solver(std::move(data)) {}
+        bool Advance() override { return m_solver.Advance(); }
+        SolveResult Solve(std::uint64_t maxSteps) override { return m_solver.Solve(maxSteps); }
+        SolveResult Solve(const SolveLimits &limits) override { return m_solver.Solve(limits); }
+        AdvanceResult GetStatus() const noexcept override { return m_solver.GetStatus(); }
+        bool IsSolved() const noexcept override { return m_solver.IsSolved(); }
+        SearchStats GetStats() const noexcept override { return m_solver.GetStats(); }
+        DataType GetValue(std::size_t row, std::size_t col) const override { return m_solver.GetBoard().GetValue(row, col); }
+    };
+
+    std::unique_ptr<Concept> m_solver;
+    std::size_t m_size;
+    bool m_static;
+
+    AnySolver(std::unique_ptr<Concept> solver, std::size_t size, bool isStatic) : m_solver(std::move(solver)), m_size(size), m_static(isStatic) {}
+
+public:
+    // `data` holds the size^4 cells in row-major order, 0 for empty cells.
+    // Returns std::nullopt if the size is out of range, the data has the wrong
+    // length, a cell holds a value above size^2 or `kind` has no instantiation
+    // for the size.
+    static std::optional<AnySolver> Create(std::size_t size, SolverKind kind, std::span<const DataType> data)
+    {
+        const std::size_t cellCount = size * size * size * size;
+        if (size == 0 || size > MaxDynamicBoardSize || data.size() != cellCount)
+        {
+            return std::nullopt;
+        }
+        // The unit masks index by value without a bounds check.
+        if (std::any_of(data.begin(), data.end(), [size](DataType value)
+                        { return value > size * size; }))
+        {
+            return std::nullopt;
+        }
+        return VisitBoardSize(
+            size,
+            [&]<std::size_t N>(std::integral_constant<std::size_t, N>) -> std::optional<AnySolver>
+            {
+                std::array<typename SudokuMatrix<N>::DataType, N * N * N * N> cells{};
+                std::copy(data.begin(), data.end(), cells.begin());
+                const SudokuMatrix<N> board{cells};
+                std::unique_ptr<Concept> solver;
+                const bool supported = VisitSolverKind<N>(kind, [&]<template <std::size_t> class Solver>()
+                                                          { solver = std::make_unique<StaticModel<N, Solver>>(board); });
+                if (!supported)
+                {
+                    return std::nullopt;
+                }
+                return AnySolver(std::move(solver), N, true);
+            },
+            [&]() -> std::optional<AnySolver>
+            {
+                DynamicSudokuMatrix board{std::vector<DataType>(data.begin(), data.end()), size};
+                return AnySolver(std::make_unique<DynamicModel>(std::move(board)), size, false);
+            });
+    }
+
+    inline bool Advance() { return m_solver->Advance(); }
+    // Runs at most `maxSteps` steps inside the concrete solver, without a
+    // virtual call per step.
+    inline SolveResult Solve(std::uint64_t maxSteps = NoStepLimit) { return m_solver->Solve(maxSteps); }
+    inline SolveResult Solve(const SolveLimits &limits) { return m_solver->Solve(limits); }
+    inline AdvanceResult GetStatus() const noexcept { return m_solver->GetStatus(); }
+    inline bool IsSolved() const noexcept { return m_solver->IsSolved(); }
+    inline SearchStats GetStats() const noexcept { return m_solver->GetStats(); }
+    inline DataType GetValue(std::size_t row, std::size_t col) const { return m_solver->GetValue(row, col); }
+    inline std::size_t GetSize() const noexcept { return m_size; }
+    // Whether the solver runs on a compile-time specialization.
+    inline bool IsStatic() const noexcept { return m_static; }
+};
\ No newline at end of file
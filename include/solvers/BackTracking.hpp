@@ -2,6 +2,8 @@
 #include "./StateMachineStatus.hpp"
 #include "../SudokuMatrix.hpp"
 #include "./ISolver.hpp"
+#include "./SolveResult.hpp"
+#include "./SearchStats.hpp"
 
 template <std::size_t N>
 class BackTrackingSolver : public ISolver<N>
@@ -10,109 +12,195 @@ public:
     using DataType = typename SudokuMatrix<N>::DataType;
 private:
     SudokuMatrix<N> m_data;
+    std::array<bool, N * N * N * N> m_fixed{};
     std::size_t m_currentRow = 0;
     std::size_t m_currentCol = 0;
+    std::size_t m_solutionLimit = 1;
+    std::size_t m_solutionCount = 0;
     AdvanceResult m_currentState = AdvanceResult::Continue;
     bool m_solved = false;
-    inline constexpr bool AdvanceToNextCell()
+    SUDOKU_NO_UNIQUE_ADDRESS SearchCounters<> m_stats;
+    // Givens are skipped by the search, so a repeated one would never be
+    // caught: such a board finishes unsolved before the first step.
+    inline constexpr void InitializeFixedCells()
     {
-        constexpr std::size_t size = N * N;
-        if (m_currentCol == size - 1 && m_currentRow == size - 1)
+        for (std::size_t index = 0; index < m_fixed.size(); ++index)
         {
-            m_currentState = AdvanceResult::Finished;
-            m_solved = true;
-            return false;
+            m_fixed[index] = m_data.GetValue(index) != 0;
         }
-        if (++m_currentCol == size)
+        if (m_data.HasRepeatedValue())
         {
-            m_currentCol = 0;
-            m_currentRow++;
+            m_currentState = AdvanceResult::Finished;
         }
-        return true;
     }
-    inline constexpr bool RetreatToPreviousCell()
+
+public:
+    constexpr BackTrackingSolver() : m_data{} {}
+    constexpr BackTrackingSolver(const SudokuMatrix<N> &data) : m_data(data) { InitializeFixedCells(); }
+    constexpr BackTrackingSolver(SudokuMatrix<N> &&data) : m_data(std::move(data)) { InitializeFixedCells(); }
+    inline constexpr void Reset(const SudokuMatrix<N> &data)
     {
-        if (m_currentCol == 0 && m_currentRow == 0)
-        {
-            m_currentState = AdvanceResult::Finished;
-            m_solved = false;
-            return false;
-        }
-        if (m_currentCol == 0 && m_currentRow != 0)
-        {
-            constexpr std::size_t size = N * N;
-            m_currentCol = size - 1;
-            m_currentRow--;
-            return true;
-        }
-        if (m_currentCol != 0)
+        m_data = data;
+        m_currentRow = 0;
+        m_currentCol = 0;
+        m_solutionLimit = 1;
+        m_solutionCount = 0;
+        m_currentState = AdvanceResult::Continue;
+        m_solved = false;
+        m_stats.Reset();
+        InitializeFixedCells();
+    }
+    // Runs the search until `limit` solutions have been found or the tree is
+    // exhausted, without copying the board per solution. A limit of 2 tells
+    // unique puzzles apart. Only when the limit is reached does the board hold
+    // a solution and IsSolved() return true; an exhausted search leaves the
+    // givens. A limit of 0 returns 0 without searching.
+    constexpr std::size_t CountSolutions(std::size_t limit)
+    {
+        if (limit == 0)
         {
-            m_currentCol--;
+            return 0;
         }
-        return true;
+        m_solutionLimit = limit;
+        Search(NoStepLimit);
+        return m_solutionCount;
     }
-
-    inline constexpr bool Continue()
+    inline constexpr std::size_t GetSolutionCount() const noexcept
     {
-        m_currentState = AdvanceResult::Continue;
-        return AdvanceToNextCell();
+        return m_solutionCount;
     }
-
-    inline constexpr bool BackTrack()
+    // Steps to the end of the search or `maxSteps`, whichever comes first.
+    constexpr SolveResult Solve(std::uint64_t maxSteps = NoStepLimit)
     {
-        m_currentState = AdvanceResult::BackTracking;
-        return RetreatToPreviousCell();
+        return MakeSolveResult(*this, Search(maxSteps));
+    }
+    SolveResult Solve(const SolveLimits &limits)
+    {
+        return RunStepsWithin(*this, [this](std::uint64_t maxSteps)
+                              { return Search(maxSteps); }, limits);
     }
-
-public:
-    constexpr BackTrackingSolver() : m_data{} {}
-    constexpr BackTrackingSolver(const SudokuMatrix<N> &data) : m_data(data) {}
-    constexpr BackTrackingSolver(SudokuMatrix<N> &&data) : m_data(std::move(data)) {}
     constexpr bool Advance() override
     {
-        if (m_solved)
+        return Search(1) != 0;
+    }
+
+private:
+    // The search behind Solve, CountSolutions and Advance. Takes up to
+    // `maxSteps` steps, one per cell visited, and returns how many it took;
+    // fewer means the search finished. The position and direction stay in
+    // locals for the whole loop and are stored back when it returns.
+    constexpr std::uint64_t Search(std::uint64_t maxSteps)
+    {
+        if (m_solved || m_currentState == AdvanceResult::Finished)
         {
             m_currentState = AdvanceResult::Finished;
-            return false;
+            return 0;
         }
         constexpr std::size_t size = N * N;
-        if (m_currentRow == size)
+        constexpr std::size_t lastIndex = size * size - 1;
+        std::size_t row = m_currentRow;
+        std::size_t col = m_currentCol;
+        bool backTracking = m_currentState == AdvanceResult::BackTracking;
+        bool finished = false;
+        std::uint64_t steps = 0;
+        for (; steps < maxSteps; ++steps)
         {
-            m_solved = true;
-            m_currentState = AdvanceResult::Finished;
-            return false;
-        }
-        std::size_t index = SudokuMatrix<N>::MatrixIndex(m_currentRow, m_currentCol);
-        if (m_currentState == AdvanceResult::BackTracking)
-        {
-            DataType value = m_data.GetValue(index) + 1;
-            std::size_t squareIndex = SudokuMatrix<N>::SquareIndex(m_currentRow, m_currentCol);
-            m_data.RemoveValue(m_currentRow, m_currentCol, index, squareIndex);
-            auto possibleValues = m_data.GetPossibleValues(m_currentRow, m_currentCol, squareIndex);
-            for (auto possibility : possibleValues)
+            const std::size_t index = SudokuMatrix<N>::MatrixIndex(row, col);
+            bool forward = false;
+            if (backTracking)
             {
-                if (possibility >= value)
+                if (!m_fixed[index])
                 {
-                    m_data.SetValue(m_currentRow, m_currentCol, index, squareIndex, possibility);
-                    return Continue();
+                    DataType value = m_data.GetValue(index) + 1;
+                    std::size_t squareIndex = SudokuMatrix<N>::SquareIndex(row, col);
+                    m_data.RemoveValue(row, col, index, squareIndex);
+                    auto possibleValues = m_data.GetPossibleValues(row, col, squareIndex);
+                    for (auto possibility : possibleValues)
+                    {
+                        if (possibility >= value)
+                        {
+                            m_data.SetValue(row, col, index, squareIndex, possibility);
+                            m_stats.TryCandidate();
+                            forward = true;
+                            break;
+                        }
+                    }
+                    if (!forward)
+                    {
+                        m_stats.PopChoice();
+                        m_stats.Backtrack();
+                    }
                 }
             }
-            return BackTrack();
-        }
-        DataType inSpot = m_data.GetValue(index);
-        if (inSpot != 0)
-        {
-            return Continue();
-        }
-        std::size_t squareIndex = SudokuMatrix<N>::SquareIndex(m_currentRow, m_currentCol);
-        auto possibleValues = m_data.GetPossibleValues(m_currentRow, m_currentCol, squareIndex);
-        if (!possibleValues.Any())
-        {
-            return BackTrack();
+            else if (m_data.GetValue(index) != 0)
+            {
+                forward = true;
+            }
+            else
+            {
+                std::size_t squareIndex = SudokuMatrix<N>::SquareIndex(row, col);
+                auto possibleValues = m_data.GetPossibleValues(row, col, squareIndex);
+                m_stats.Expand();
+                if (possibleValues.Any())
+                {
+                    m_data.SetValue(row, col, index, squareIndex, *possibleValues);
+                    m_stats.PushChoice();
+                    m_stats.TryCandidate();
+                    forward = true;
+                }
+                else
+                {
+                    m_stats.Backtrack();
+                }
+            }
+            if (forward)
+            {
+                if (index == lastIndex)
+                {
+                    if (++m_solutionCount >= m_solutionLimit)
+                    {
+                        m_solved = true;
+                        finished = true;
+                        break;
+                    }
+                    // Keep searching from the last cell as if it were a dead end.
+                    backTracking = true;
+                    continue;
+                }
+                backTracking = false;
+                if (++col == size)
+                {
+                    col = 0;
+                    row++;
+                }
+                continue;
+            }
+            if (index == 0)
+            {
+                m_solved = false;
+                finished = true;
+                break;
+            }
+            backTracking = true;
+            if (col == 0)
+            {
+                col = size - 1;
+                row--;
+            }
+            else
+            {
+                col--;
+            }
         }
-        m_data.SetValue(m_currentRow, m_currentCol, index, squareIndex, *possibleValues);
-        return Continue();
+        m_currentRow = row;
+        m_currentCol = col;
+        m_currentState = finished       ? AdvanceResult::Finished
+                         : backTracking ? AdvanceResult::BackTracking
+                                        : AdvanceResult::Continue;
+        return steps;
     }
+
+public:
     inline constexpr AdvanceResult GetStatus() const noexcept override
     {
         return m_currentState;
@@ -125,6 +213,10 @@ public:
     {
         return m_solved;
     }
+    inline constexpr SearchStats GetStats() const noexcept
+    {
+        return m_stats.Get();
+    }
 };
 
 class DynamicBackTrackingSolver : public IDynamicSolver
@@ -133,110 +225,153 @@ public:
     using DataType = typename DynamicSudokuMatrix::DataType;
 private:
     DynamicSudokuMatrix m_data;
+    std::vector<bool> m_fixed;
     std::size_t m_currentRow = 0;
     std::size_t m_currentCol = 0;
     std::size_t m_squaredSize;
     AdvanceResult m_currentState = AdvanceResult::Continue;
     bool m_solved = false;
-    inline bool AdvanceToNextCell()
+    SUDOKU_NO_UNIQUE_ADDRESS SearchCounters<> m_stats;
+    // A repeated given finishes the board unsolved, as in BackTrackingSolver.
+    inline void InitializeFixedCells()
     {
-        std::size_t size = m_squaredSize;
-        if (m_currentCol == size - 1 && m_currentRow == size - 1)
-        {
-            m_currentState = AdvanceResult::Finished;
-            m_solved = true;
-            return false;
-        }
-        if (++m_currentCol == size)
+        m_fixed.assign(m_squaredSize * m_squaredSize, false);
+        for (std::size_t index = 0; index < m_fixed.size(); ++index)
         {
-            m_currentCol = 0;
-            m_currentRow++;
+            m_fixed[index] = m_data.GetValue(index) != 0;
         }
-        return true;
-    }
-    inline bool RetreatToPreviousCell()
-    {
-        if (m_currentCol == 0 && m_currentRow == 0)
+        if (m_data.HasRepeatedValue())
         {
             m_currentState = AdvanceResult::Finished;
-            m_solved = false;
-            return false;
-        }
-        if (m_currentCol == 0 && m_currentRow != 0)
-        {
-            std::size_t size = m_squaredSize;
-            m_currentCol = size - 1;
-            m_currentRow--;
-            return true;
         }
-        if (m_currentCol != 0)
-        {
-            m_currentCol--;
-        }
-        return true;
     }
 
-    inline bool Continue()
+public:
+    DynamicBackTrackingSolver(std::size_t size) : m_data(size), m_squaredSize(size * size) { InitializeFixedCells(); }
+    DynamicBackTrackingSolver(const DynamicSudokuMatrix &data) : m_data(data), m_squaredSize(m_data.GetSize() * m_data.GetSize()) { InitializeFixedCells(); }
+    DynamicBackTrackingSolver(DynamicSudokuMatrix &&data) : m_data(std::move(data)), m_squaredSize(m_data.GetSize() * m_data.GetSize()) { InitializeFixedCells(); }
+    SolveResult Solve(std::uint64_t maxSteps = NoStepLimit)
     {
-        m_currentState = AdvanceResult::Continue;
-        return AdvanceToNextCell();
+        return MakeSolveResult(*this, Search(maxSteps));
     }
-
-    inline bool BackTrack()
+    SolveResult Solve(const SolveLimits &limits)
     {
-        m_currentState = AdvanceResult::BackTracking;
-        return RetreatToPreviousCell();
+        return RunStepsWithin(*this, [this](std::uint64_t maxSteps)
+                              { return Search(maxSteps); }, limits);
     }
-
-public:
-    DynamicBackTrackingSolver(std::size_t size) : m_data(size), m_squaredSize(size * size) {}
-    DynamicBackTrackingSolver(const DynamicSudokuMatrix &data) : m_data(data), m_squaredSize(m_data.GetSize() * m_data.GetSize()) {}
-    DynamicBackTrackingSolver(DynamicSudokuMatrix &&data) : m_data(std::move(data)), m_squaredSize(m_data.GetSize() * m_data.GetSize()) {}
     bool Advance() override
     {
-        if (m_solved)
-        {
-            m_currentState = AdvanceResult::Finished;
-            return false;
-        }
-        std::size_t size = m_squaredSize;
-        if (m_currentRow == size)
+        return Search(1) != 0;
+    }
+
+private:
+    // Same loop as BackTrackingSolver::Search, for one solution.
+    std::uint64_t Search(std::uint64_t maxSteps)
+    {
+        if (m_solved || m_currentState == AdvanceResult::Finished)
         {
-            m_solved = true;
             m_currentState = AdvanceResult::Finished;
-            return false;
+            return 0;
         }
-        std::size_t index = m_data.MatrixIndex(m_currentRow, m_currentCol);
-        if (m_currentState == AdvanceResult::BackTracking)
+        const std::size_t size = m_squaredSize;
+        const std::size_t lastIndex = size * size - 1;
+        std::size_t row = m_currentRow;
+        std::size_t col = m_currentCol;
+        bool backTracking = m_currentState == AdvanceResult::BackTracking;
+        bool finished = false;
+        std::uint64_t steps = 0;
+        for (; steps < maxSteps; ++steps)
         {
-            DataType value = m_data.GetValue(index) + 1;
-            std::size_t squareIndex = m_data.SquareIndex(m_currentRow, m_currentCol);
-            m_data.RemoveValue(m_currentRow, m_currentCol, index, squareIndex);
-            auto possibleValues = m_data.GetPossibleValues(m_currentRow, m_currentCol, squareIndex);
-            for (auto possibility : possibleValues)
+            const std::size_t index = m_data.MatrixIndex(row, col);
+            bool forward = false;
+            if (backTracking)
             {
-                if (possibility >= value)
+                if (!m_fixed[index])
                 {
-                    m_data.SetValue(m_currentRow, m_currentCol, index, squareIndex, possibility);
-                    return Continue();
+                    DataType value = m_data.GetValue(index) + 1;
+                    std::size_t squareIndex = m_data.SquareIndex(row, col);
+                    m_data.RemoveValue(row, col, index, squareIndex);
+                    auto possibleValues = m_data.GetPossibleValues(row, col, squareIndex);
+                    for (auto possibility : possibleValues)
+                    {
+                        if (possibility >= value)
+                        {
+                            m_data.SetValue(row, col, index, squareIndex, possibility);
+                            m_stats.TryCandidate();
+                            forward = true;
+                            break;
+                        }
+                    }
+                    if (!forward)
+                    {
+                        m_stats.PopChoice();
+                        m_stats.Backtrack();
+                    }
                 }
             }
-            return BackTrack();
-        }
-        DataType inSpot = m_data.GetValue(index);
-        if (inSpot != 0)
-        {
-            return Continue();
-        }
-        std::size_t squareIndex = m_data.SquareIndex(m_currentRow, m_currentCol);
-        auto possibleValues = m_data.GetPossibleValues(m_currentRow, m_currentCol, squareIndex);
-        if (possibleValues.Count() == 0)
-        {
-            return BackTrack();
+            else if (m_data.GetValue(index) != 0)
+            {
+                forward = true;
+            }
+            else
+            {
+                std::size_t squareIndex = m_data.SquareIndex(row, col);
+                auto possibleValues = m_data.GetPossibleValues(row, col, squareIndex);
+                m_stats.Expand();
+                if (possibleValues.Count() != 0)
+                {
+                    m_data.SetValue(row, col, index, squareIndex, *possibleValues);
+                    m_stats.PushChoice();
+                    m_stats.TryCandidate();
+                    forward = true;
+                }
+                else
+                {
+                    m_stats.Backtrack();
+                }
+            }
+            if (forward)
+            {
+                if (index == lastIndex)
+                {
+                    m_solved = true;
+                    finished = true;
+                    break;
+                }
+                backTracking = false;
+                if (++col == size)
+                {
+                    col = 0;
+                    row++;
+                }
+                continue;
+            }
+            if (index == 0)
+            {
+                m_solved = false;
+                finished = true;
+                break;
+            }
+            backTracking = true;
+            if (col == 0)
+            {
+                col = size - 1;
+                row--;
+            }
+            else
+            {
+                col--;
+            }
         }
-        m_data.SetValue(m_currentRow, m_currentCol, index, squareIndex, *possibleValues);
-        return Continue();
+        m_currentRow = row;
+        m_currentCol = col;
+        m_currentState = finished       ? AdvanceResult::Finished
+                         : backTracking ? AdvanceResult::BackTracking
+                                        : AdvanceResult::Continue;
+        return steps;
     }
+
+public:
     inline constexpr AdvanceResult GetStatus() const noexcept override
     {
         return m_currentState;
@@ -249,4 +384,8 @@ public:
     {
         return m_solved;
     }
+    inline constexpr SearchStats GetStats() const noexcept
+    {
+        return m_stats.Get();
+    }
 };
\ No newline at end of file
@@ -0,0 +1,647 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+#include <vector>
+#include <immintrin.h>
+#include "./StateMachineStatus.hpp"
+#include "./ISolver.hpp"
+#include "./SolveResult.hpp"
+#include "./SearchStats.hpp"
+#include "../CpuFeatures.hpp"
+#include "../SudokuMatrix.hpp"
+
+template <std::size_t N>
+class BandSolver;
+
+// 9x9 solver working on one 81-bit bitboard per digit, stored as three 27-bit
+// bands (one band per 32-bit lane). Two digits share a 256-bit register, so
+// eliminations, naked singles and hidden singles in rows, columns and boxes
+// are computed for a pair of digits with a handful of AVX2 instructions.
+// The class is compiled for AVX2 whatever the build flags; only construct it
+// when GetSimdLevel() is at least SimdLevel::Avx2.
+SUDOKU_BEGIN_TARGET_AVX2
+template <>
+class BandSolver<3> : public ISolver<3>
+{
+public:
+    using DataType = typename SudokuMatrix<3>::DataType;
+
+private:
+    static constexpr std::size_t Size = 9;
+    static constexpr std::size_t CellCount = 81;
+    static constexpr std::size_t BandCells = 27;
+    static constexpr std::size_t PairCount = 5;
+    static constexpr std::uint32_t BandBits = (1u << BandCells) - 1;
+    using BandMasks = std::array<std::uint32_t, 4>;
+
+    struct State
+    {
+        // Lanes 0..2 hold digit 2k, lanes 4..6 digit 2k + 1. A solved cell keeps
+        // only the bit of its digit.
+        __m256i digits[PairCount];
+        __m128i unsolved;
+    };
+
+    struct Frame
+    {
+        State state;
+        std::uint8_t cell;
+        std::uint16_t remaining;
+    };
+
+    alignas(16) static constexpr std::array<BandMasks, CellCount> CellMasks = []()
+    {
+        std::array<BandMasks, CellCount> masks{};
+        for (std::size_t cell = 0; cell < CellCount; ++cell)
+        {
+            masks[cell][cell / BandCells] = 1u << (cell % BandCells);
+        }
+        return masks;
+    }();
+
+    alignas(16) static constexpr std::array<BandMasks, CellCount> PeerMasks = []()
+    {
+        std::array<BandMasks, CellCount> masks{};
+        for (std::size_t cell = 0; cell < CellCount; ++cell)
+        {
+            const std::size_t row = cell / Size;
+            const std::size_t col = cell % Size;
+            for (std::size_t other = 0; other < CellCount; ++other)
+            {
+                const std::size_t otherRow = other / Size;
+                const std::size_t otherCol = other % Size;
+                const bool sameBox = row / 3 == otherRow / 3 && col / 3 == otherCol / 3;
+                if (other != cell && (row == otherRow || col == otherCol || sameBox))
+                {
+                    masks[cell][other / BandCells] |= 1u << (other % BandCells);
+                }
+            }
+        }
+        return masks;
+    }();
+
+    // Summary bits in every band lane: the first cell of each row, the first
+    // column of each box, and one bit per column in lane 0.
+    static constexpr std::uint32_t RowBits = 0x40201;
+    static constexpr std::uint32_t BoxBits = 0x49;
+    static constexpr std::uint32_t ColBits = 0x1FF;
+    // Multipliers spreading a summary bit back over its row, box or column.
+    static constexpr std::uint32_t RowSpread = 0x1FF;
+    static constexpr std::uint32_t BoxSpread = 0x1C0E07;
+    static constexpr std::uint32_t ColSpread = 0x40201;
+
+    // Units of both digits of a pair holding at least one / at least two cells.
+    struct UnitCounts
+    {
+        __m256i rowOnce;
+        __m256i rowTwice;
+        __m256i boxOnce;
+        __m256i boxTwice;
+        __m256i colOnce;
+        __m256i colTwice;
+    };
+
+    State m_state;
+    SudokuMatrix<3> m_data;
+    std::vector<Frame> m_frames;
+    AdvanceResult m_currentState = AdvanceResult::Continue;
+    bool m_solved = false;
+    SUDOKU_NO_UNIQUE_ADDRESS SearchCounters<> m_stats;
+
+    static inline __m128i Load(const BandMasks &mask)
+    {
+        return _mm_load_si128(reinterpret_cast<const __m128i *>(mask.data()));
+    }
+
+    static inline __m256i Broadcast(__m128i value)
+    {
+        return _mm256_broadcastsi128_si256(value);
+    }
+
+    static inline __m256i InHalf(__m128i value, std::size_t half)
+    {
+        __m256i zero = _mm256_setzero_si256();
+        return half == 0 ? _mm256_inserti128_si256(zero, value, 0) : _mm256_inserti128_si256(zero, value, 1);
+    }
+
+    static inline __m128i DigitMask(const State &state, std::size_t digit)
+    {
+        const __m256i pair = state.digits[digit / 2];
+        return (digit & 1) == 0 ? _mm256_castsi256_si128(pair) : _mm256_extracti128_si256(pair, 1);
+    }
+
+    static inline bool IsEmpty(__m256i value)
+    {
+        return _mm256_testz_si256(value, value) != 0;
+    }
+
+    // The upper half of the last pair has no digit and must not be checked.
+    static inline __m256i PairLanes(std::size_t pair, std::uint32_t low0, std::uint32_t low1)
+    {
+        const std::uint32_t high0 = pair + 1 < PairCount ? low0 : 0;
+        const std::uint32_t high1 = pair + 1 < PairCount ? low1 : 0;
+        return _mm256_setr_epi32(static_cast<int>(low0), static_cast<int>(low1), static_cast<int>(low1), 0,
+                                 static_cast<int>(high0), static_cast<int>(high1), static_cast<int>(high1), 0);
+    }
+
+    static inline void Place(State &state, std::size_t digit, std::size_t cell)
+    {
+        const __m128i bit = Load(CellMasks[cell]);
+        const __m256i bits = Broadcast(bit);
+        for (__m256i &pair : state.digits)
+        {
+            pair = _mm256_andnot_si256(bits, pair);
+        }
+        const std::size_t half = digit & 1;
+        __m256i &pair = state.digits[digit / 2];
+        pair = _mm256_or_si256(_mm256_andnot_si256(InHalf(Load(PeerMasks[cell]), half), pair), InHalf(bit, half));
+        state.unsolved = _mm_andnot_si128(bit, state.unsolved);
+    }
+
+    static inline UnitCounts CountUnits(__m256i x)
+    {
+        UnitCounts counts;
+        // Rows: fold the nine columns of every row onto its first cell.
+        __m256i shifted = _mm256_srli_epi32(x, 1);
+        __m256i once = _mm256_or_si256(x, shifted);
+        __m256i twice = _mm256_and_si256(x, shifted);
+        shifted = _mm256_srli_epi32(once, 2);
+        twice = _mm256_or_si256(_mm256_or_si256(twice, _mm256_srli_epi32(twice, 2)), _mm256_and_si256(once, shifted));
+        once = _mm256_or_si256(once, shifted);
+        shifted = _mm256_srli_epi32(once, 4);
+        twice = _mm256_or_si256(_mm256_or_si256(twice, _mm256_srli_epi32(twice, 4)), _mm256_and_si256(once, shifted));
+        once = _mm256_or_si256(once, shifted);
+        shifted = _mm256_srli_epi32(x, 8);
+        twice = _mm256_or_si256(twice, _mm256_and_si256(once, shifted));
+        once = _mm256_or_si256(once, shifted);
+        const __m256i rowBits = _mm256_set1_epi32(static_cast<int>(RowBits));
+        counts.rowOnce = _mm256_and_si256(once, rowBits);
+        counts.rowTwice = _mm256_and_si256(twice, rowBits);
+
+        // Band columns: fold the three rows of every band.
+        const __m256i nineBits = _mm256_set1_epi32(static_cast<int>(ColBits));
+        const __m256i r0 = _mm256_and_si256(x, nineBits);
+        const __m256i r1 = _mm256_and_si256(_mm256_srli_epi32(x, 9), nineBits);
+        const __m256i r2 = _mm256_srli_epi32(x, 18);
+        const __m256i bandOnce = _mm256_or_si256(_mm256_or_si256(r0, r1), r2);
+        const __m256i bandTwice = _mm256_or_si256(_mm256_and_si256(r0, r1), _mm256_and_si256(r2, _mm256_or_si256(r0, r1)));
+
+        // Boxes: fold three adjacent band columns.
+        const __m256i boxBits = _mm256_set1_epi32(static_cast<int>(BoxBits));
+        const __m256i b1 = _mm256_srli_epi32(bandOnce, 1);
+        const __m256i b2 = _mm256_srli_epi32(bandOnce, 2);
+        counts.boxOnce = _mm256_and_si256(_mm256_or_si256(_mm256_or_si256(bandOnce, b1), b2), boxBits);
+        twice = _mm256_or_si256(_mm256_or_si256(bandTwice, _mm256_srli_epi32(bandTwice, 1)), _mm256_srli_epi32(bandTwice, 2));
+        twice = _mm256_or_si256(twice, _mm256_or_si256(_mm256_and_si256(bandOnce, b1), _mm256_and_si256(b2, _mm256_or_si256(bandOnce, b1))));
+        counts.boxTwice = _mm256_and_si256(twice, boxBits);
+
+        // Columns: fold the three bands into lane 0.
+        const __m256i colBits = _mm256_setr_epi32(static_cast<int>(ColBits), 0, 0, 0, static_cast<int>(ColBits), 0, 0, 0);
+        const __m256i o1 = _mm256_shuffle_epi32(bandOnce, _MM_SHUFFLE(3, 3, 3, 1));
+        const __m256i o2 = _mm256_shuffle_epi32(bandOnce, _MM_SHUFFLE(3, 3, 3, 2));
+        const __m256i t1 = _mm256_shuffle_epi32(bandTwice, _MM_SHUFFLE(3, 3, 3, 1));
+        const __m256i t2 = _mm256_shuffle_epi32(bandTwice, _MM_SHUFFLE(3, 3, 3, 2));
+        counts.colOnce = _mm256_and_si256(_mm256_or_si256(_mm256_or_si256(bandOnce, o1), o2), colBits);
+        twice = _mm256_or_si256(_mm256_or_si256(bandTwice, t1), t2);
+        twice = _mm256_or_si256(twice, _mm256_or_si256(_mm256_and_si256(bandOnce, o1), _mm256_and_si256(o2, _mm256_or_si256(bandOnce, o1))));
+        counts.colTwice = _mm256_and_si256(twice, colBits);
+        return counts;
+    }
+
+    // Every cell of the selected rows, boxes and columns.
+    static inline __m256i Spread(__m256i rows, __m256i boxes, __m256i cols)
+    {
+        const __m256i rowCells = _mm256_mullo_epi32(rows, _mm256_set1_epi32(static_cast<int>(RowSpread)));
+        const __m256i boxCells = _mm256_mullo_epi32(boxes, _mm256_set1_epi32(static_cast<int>(BoxSpread)));
+        const __m256i colLanes = _mm256_shuffle_epi32(cols, _MM_SHUFFLE(1, 0, 0, 0));
+        const __m256i colCells = _mm256_mullo_epi32(colLanes, _mm256_set1_epi32(static_cast<int>(ColSpread)));
+        return _mm256_or_si256(_mm256_or_si256(rowCells, boxCells), colCells);
+    }
+
+    // Solves all the given cells of every pair at once: their other digits are
+    // cleared and their digit is removed from every unit they share. Fails when
+    // a cell gets two digits or a digit lands twice in one unit.
+    static inline bool Assign(State &state, const __m256i (&cells)[PairCount])
+    {
+        __m256i ones = _mm256_setzero_si256();
+        __m256i twos = _mm256_setzero_si256();
+        for (const __m256i &pair : cells)
+        {
+            twos = _mm256_or_si256(twos, _mm256_and_si256(ones, pair));
+            ones = _mm256_or_si256(ones, pair);
+        }
+        const __m128i onesLow = _mm256_castsi256_si128(ones);
+        const __m128i onesHigh = _mm256_extracti128_si256(ones, 1);
+        const __m128i clash = _mm_or_si128(_mm_or_si128(_mm256_castsi256_si128(twos), _mm256_extracti128_si256(twos, 1)), _mm_and_si128(onesLow, onesHigh));
+        if (_mm_testz_si128(clash, clash) == 0)
+        {
+            return false;
+        }
+        const __m128i assigned = _mm_or_si128(onesLow, onesHigh);
+        const __m256i assignedPair = Broadcast(assigned);
+        for (std::size_t pair = 0; pair < PairCount; ++pair)
+        {
+            __m256i digits = _mm256_andnot_si256(assignedPair, state.digits[pair]);
+            if (!IsEmpty(cells[pair]))
+            {
+                const UnitCounts counts = CountUnits(cells[pair]);
+                if (!IsEmpty(_mm256_or_si256(_mm256_or_si256(counts.rowTwice, counts.boxTwice), counts.colTwice)))
+                {
+                    return false;
+                }
+                const __m256i peers = Spread(counts.rowOnce, counts.boxOnce, counts.colOnce);
+                digits = _mm256_or_si256(_mm256_andnot_si256(peers, digits), cells[pair]);
+            }
+            state.digits[pair] = digits;
+        }
+        state.unsolved = _mm_andnot_si128(assigned, state.unsolved);
+        return true;
+    }
+
+    static inline bool PlaceNakedSingles(State &state, bool &changed)
+    {
+        const __m256i unsolved = Broadcast(state.unsolved);
+        __m256i ones = _mm256_setzero_si256();
+        __m256i twos = _mm256_setzero_si256();
+        for (const __m256i &pair : state.digits)
+        {
+            const __m256i x = _mm256_and_si256(pair, unsolved);
+            twos = _mm256_or_si256(twos, _mm256_and_si256(ones, x));
+            ones = _mm256_or_si256(ones, x);
+        }
+        const __m128i onesLow = _mm256_castsi256_si128(ones);
+        const __m128i onesHigh = _mm256_extracti128_si256(ones, 1);
+        const __m128i any = _mm_or_si128(onesLow, onesHigh);
+        const __m128i many = _mm_or_si128(_mm_or_si128(_mm256_castsi256_si128(twos), _mm256_extracti128_si256(twos, 1)), _mm_and_si128(onesLow, onesHigh));
+        if (_mm_testc_si128(any, state.unsolved) == 0)
+        {
+            return false;
+        }
+        const __m128i singles = _mm_andnot_si128(many, any);
+        if (_mm_testz_si128(singles, singles) != 0)
+        {
+            return true;
+        }
+        const __m256i singlesPair = Broadcast(singles);
+        __m256i cells[PairCount];
+        for (std::size_t pair = 0; pair < PairCount; ++pair)
+        {
+            cells[pair] = _mm256_and_si256(state.digits[pair], singlesPair);
+        }
+        changed = true;
+        return Assign(state, cells);
+    }
+
+    static inline bool PlaceHiddenSingles(State &state, bool &changed)
+    {
+        const __m256i unsolved = Broadcast(state.unsolved);
+        __m256i cells[PairCount];
+        __m256i found = _mm256_setzero_si256();
+        for (std::size_t pair = 0; pair < PairCount; ++pair)
+        {
+            const __m256i x = state.digits[pair];
+            const UnitCounts counts = CountUnits(x);
+            // Every row, box and column needs a cell for each digit.
+            if (_mm256_testc_si256(counts.rowOnce, PairLanes(pair, RowBits, RowBits)) == 0 ||
+                _mm256_testc_si256(counts.boxOnce, PairLanes(pair, BoxBits, BoxBits)) == 0 ||
+                _mm256_testc_si256(counts.colOnce, PairLanes(pair, ColBits, 0)) == 0)
+            {
+                return false;
+            }
+            const __m256i unique = Spread(_mm256_andnot_si256(counts.rowTwice, counts.rowOnce),
+                                          _mm256_andnot_si256(counts.boxTwice, counts.boxOnce),
+                                          _mm256_andnot_si256(counts.colTwice, counts.colOnce));
+            cells[pair] = _mm256_and_si256(_mm256_and_si256(unique, x), unsolved);
+            found = _mm256_or_si256(found, cells[pair]);
+        }
+        if (IsEmpty(found))
+        {
+            return true;
+        }
+        changed = true;
+        return Assign(state, cells);
+    }
+
+    static inline bool Propagate(State &state)
+    {
+        bool changed = true;
+        while (changed && _mm_testz_si128(state.unsolved, state.unsolved) == 0)
+        {
+            changed = false;
+            if (!PlaceNakedSingles(state, changed))
+            {
+                return false;
+            }
+            if (changed)
+            {
+                continue;
+            }
+            if (!PlaceHiddenSingles(state, changed))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Candidates of every cell, a solved cell counting its own digit.
+    static inline std::size_t CountCandidates(const State &state)
+    {
+        std::size_t count = 0;
+        for (const __m256i &pair : state.digits)
+        {
+            alignas(32) std::uint64_t words[4];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(words), pair);
+            for (const std::uint64_t word : words)
+            {
+                count += static_cast<std::size_t>(std::popcount(word));
+            }
+        }
+        return count;
+    }
+
+    static inline std::uint16_t CellCandidates(const State &state, std::size_t cell)
+    {
+        const __m128i bit = Load(CellMasks[cell]);
+        std::uint16_t candidates = 0;
+        for (std::size_t digit = 0; digit < Size; ++digit)
+        {
+            if (_mm_testz_si128(DigitMask(state, digit), bit) == 0)
+            {
+                candidates |= static_cast<std::uint16_t>(1u << digit);
+            }
+        }
+        return candidates;
+    }
+
+    // Picks a bivalue cell when there is one, otherwise the open cell with the
+    // fewest candidates.
+    static inline std::size_t ChooseCell(const State &state)
+    {
+        const __m256i unsolved = Broadcast(state.unsolved);
+        __m256i ones = _mm256_setzero_si256();
+        __m256i twos = _mm256_setzero_si256();
+        __m256i threes = _mm256_setzero_si256();
+        for (const __m256i &pair : state.digits)
+        {
+            const __m256i x = _mm256_and_si256(pair, unsolved);
+            threes = _mm256_or_si256(threes, _mm256_and_si256(twos, x));
+            twos = _mm256_or_si256(twos, _mm256_and_si256(ones, x));
+            ones = _mm256_or_si256(ones, x);
+        }
+        const __m128i onesLow = _mm256_castsi256_si128(ones);
+        const __m128i onesHigh = _mm256_extracti128_si256(ones, 1);
+        const __m128i twosLow = _mm256_castsi256_si128(twos);
+        const __m128i twosHigh = _mm256_extracti128_si256(twos, 1);
+        const __m128i atLeastTwo = _mm_or_si128(_mm_or_si128(twosLow, twosHigh), _mm_and_si128(onesLow, onesHigh));
+        const __m128i atLeastThree = _mm_or_si128(_mm_or_si128(_mm256_castsi256_si128(threes), _mm256_extracti128_si256(threes, 1)),
+                                                  _mm_or_si128(_mm_and_si128(twosLow, onesHigh), _mm_and_si128(twosHigh, onesLow)));
+        alignas(16) std::uint32_t bivalue[4];
+        _mm_store_si128(reinterpret_cast<__m128i *>(bivalue), _mm_andnot_si128(atLeastThree, atLeastTwo));
+        for (std::size_t band = 0; band < 3; ++band)
+        {
+            if (bivalue[band] != 0)
+            {
+                return band * BandCells + static_cast<std::size_t>(std::countr_zero(bivalue[band]));
+            }
+        }
+        alignas(16) std::uint32_t open[4];
+        _mm_store_si128(reinterpret_cast<__m128i *>(open), state.unsolved);
+        std::size_t best = CellCount;
+        int minCount = std::numeric_limits<int>::max();
+        for (std::size_t band = 0; band < 3; ++band)
+        {
+            for (std::uint32_t bits = open[band]; bits != 0; bits &= bits - 1)
+            {
+                const std::size_t cell = band * BandCells + static_cast<std::size_t>(std::countr_zero(bits));
+                const int count = std::popcount(CellCandidates(state, cell));
+                if (count < minCount)
+                {
+                    minCount = count;
+                    best = cell;
+                }
+            }
+        }
+        return best;
+    }
+
+    inline void WriteBoard()
+    {
+        std::array<DataType, CellCount> values{};
+        alignas(16) std::uint32_t open[4];
+        _mm_store_si128(reinterpret_cast<__m128i *>(open), m_state.unsolved);
+        for (std::size_t digit = 0; digit < Size; ++digit)
+        {
+            alignas(16) std::uint32_t bands[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(bands), DigitMask(m_state, digit));
+            for (std::size_t band = 0; band < 3; ++band)
+            {
+                for (std::uint32_t bits = bands[band] & ~open[band]; bits != 0; bits &= bits - 1)
+                {
+                    values[band * BandCells + static_cast<std::size_t>(std::countr_zero(bits))] = static_cast<DataType>(digit + 1);
+                }
+            }
+        }
+        m_data = SudokuMatrix<3>{values};
+    }
+
+    // Givens are applied in bulk: every digit collects the cells it occupies and
+    // the peers it blocks, and a given sitting on a blocked cell is a conflict.
+    inline void Initialize()
+    {
+        m_frames.clear();
+        m_currentState = AdvanceResult::Continue;
+        m_solved = false;
+        m_stats.Reset();
+        __m128i placed[Size];
+        __m128i blocked[Size];
+        for (std::size_t digit = 0; digit < Size; ++digit)
+        {
+            placed[digit] = _mm_setzero_si128();
+            blocked[digit] = _mm_setzero_si128();
+        }
+        // Padded copy so every band can be compared with one unaligned load.
+        alignas(32) std::array<DataType, 3 * BandCells + 32> values{};
+        std::copy(m_data.GetData().begin(), m_data.GetData().end(), values.begin());
+        for (std::size_t band = 0; band < 3; ++band)
+        {
+            const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values.data() + band * BandCells));
+            const std::uint32_t empty = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_setzero_si256())));
+            for (std::uint32_t bits = ~empty & BandBits; bits != 0; bits &= bits - 1)
+            {
+                const std::size_t cell = band * BandCells + static_cast<std::size_t>(std::countr_zero(bits));
+                const std::size_t digit = values[cell] - 1;
+                placed[digit] = _mm_or_si128(placed[digit], Load(CellMasks[cell]));
+                blocked[digit] = _mm_or_si128(blocked[digit], Load(PeerMasks[cell]));
+            }
+        }
+        const __m128i full = _mm_setr_epi32(static_cast<int>(BandBits), static_cast<int>(BandBits), static_cast<int>(BandBits), 0);
+        __m128i givens = _mm_setzero_si128();
+        __m128i conflicts = _mm_setzero_si128();
+        for (std::size_t digit = 0; digit < Size; ++digit)
+        {
+            givens = _mm_or_si128(givens, placed[digit]);
+            conflicts = _mm_or_si128(conflicts, _mm_and_si128(placed[digit], blocked[digit]));
+        }
+        const __m128i open = _mm_andnot_si128(givens, full);
+        for (std::size_t pair = 0; pair < PairCount; ++pair)
+        {
+            const __m128i low = _mm_or_si128(placed[2 * pair], _mm_andnot_si128(blocked[2 * pair], open));
+            const __m128i high = 2 * pair + 1 < Size ? _mm_or_si128(placed[2 * pair + 1], _mm_andnot_si128(blocked[2 * pair + 1], open)) : _mm_setzero_si128();
+            m_state.digits[pair] = _mm256_set_m128i(high, low);
+        }
+        m_state.unsolved = open;
+        if (_mm_testz_si128(conflicts, conflicts) == 0)
+        {
+            m_currentState = AdvanceResult::Finished;
+        }
+    }
+
+    inline bool Branch()
+    {
+        m_stats.Expand(m_frames.size());
+        m_stats.TryCandidate();
+        const std::size_t cell = ChooseCell(m_state);
+        std::uint16_t remaining = CellCandidates(m_state, cell);
+        const std::size_t digit = static_cast<std::size_t>(std::countr_zero(remaining));
+        remaining &= remaining - 1;
+        m_frames.push_back({m_state, static_cast<std::uint8_t>(cell), remaining});
+        Place(m_state, digit, cell);
+        return Continue();
+    }
+
+    inline bool Retry()
+    {
+        while (!m_frames.empty())
+        {
+            Frame &frame = m_frames.back();
+            if (frame.remaining == 0)
+            {
+                m_frames.pop_back();
+                continue;
+            }
+            m_state = frame.state;
+            const std::size_t cell = frame.cell;
+            const std::size_t digit = static_cast<std::size_t>(std::countr_zero(frame.remaining));
+            frame.remaining &= frame.remaining - 1;
+            if (frame.remaining == 0)
+            {
+                m_frames.pop_back();
+            }
+            m_stats.TryCandidate();
+            Place(m_state, digit, cell);
+            return Continue();
+        }
+        m_currentState = AdvanceResult::Finished;
+        m_solved = false;
+        return false;
+    }
+
+    // Propagate(m_state), also counting the eliminations when stats are on.
+    inline bool PropagateCounting()
+    {
+        if constexpr (SearchStatsEnabled)
+        {
+            const std::size_t before = CountCandidates(m_state);
+            const bool consistent = Propagate(m_state);
+            m_stats.Eliminate(before - CountCandidates(m_state));
+            return consistent;
+        }
+        else
+        {
+            return Propagate(m_state);
+        }
+    }
+
+    inline bool Continue()
+    {
+        m_currentState = AdvanceResult::Continue;
+        return true;
+    }
+
+    inline bool BackTrack()
+    {
+        m_currentState = AdvanceResult::BackTracking;
+        return true;
+    }
+
+public:
+    BandSolver() : m_data{} { Initialize(); }
+    BandSolver(const SudokuMatrix<3> &data) : m_data(data) { Initialize(); }
+    BandSolver(SudokuMatrix<3> &&data) : m_data(std::move(data)) { Initialize(); }
+
+    inline void Reset(const SudokuMatrix<3> &data)
+    {
+        m_data = data;
+        Initialize();
+    }
+
+    bool Advance(bool insertEveryStep)
+    {
+        if (m_currentState == AdvanceResult::Finished)
+        {
+            return false;
+        }
+        bool advanced;
+        if (m_currentState == AdvanceResult::BackTracking)
+        {
+            advanced = Retry();
+        }
+        else if (!PropagateCounting())
+        {
+            m_stats.Backtrack();
+            advanced = BackTrack();
+        }
+        else if (_mm_testz_si128(m_state.unsolved, m_state.unsolved) != 0)
+        {
+            m_solved = true;
+            m_currentState = AdvanceResult::Finished;
+            WriteBoard();
+            return false;
+        }
+        else
+        {
+            advanced = Branch();
+        }
+        if (insertEveryStep && advanced)
+        {
+            WriteBoard();
+        }
+        return advanced;
+    }
+
+    inline bool Advance() override
+    {
+        return Advance(true);
+    }
+    SolveResult Solve(std::uint64_t maxSteps = NoStepLimit)
+    {
+        return MakeSolveResult(*this, RunSteps([this]
+                                               { return Advance(false); }, maxSteps));
+    }
+    SolveResult Solve(const SolveLimits &limits)
+    {
+        return RunStepsWithin(*this, [this](std::uint64_t maxSteps)
+                              { return RunSteps([this]
+                                                { return Advance(false); }, maxSteps); }, limits);
+    }
+    inline AdvanceResult GetStatus() const noexcept override
+    {
+        return m_currentState;
+    }
+    inline const SudokuMatrix<3> &GetBoard() const noexcept override
+    {
+        return m_data;
+    }
+    inline SearchStats GetStats() const noexcept
+    {
+        return m_stats.Get();
+    }
+    inline bool IsSolved() const noexcept override
+    {
+        return m_solved;
+    }
+};
+SUDOKU_END_TARGET
\ No newline at end of file
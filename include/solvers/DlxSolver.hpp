@@ -1,29 +1,17 @@
 #pragma once
+#include <array>
 #include <vector>
-#include <span>
 #include "./StateMachineStatus.hpp"
 #include "./ISolver.hpp"
+#include "./SolveResult.hpp"
+#include "./SearchStats.hpp"
 #include "../SudokuMatrix.hpp"
 
-struct DLXNode
-{
-    DLXNode *left;
-    DLXNode *right;
-    DLXNode *up;
-    DLXNode *down;
-    DLXNode *column;
-};
-
-struct DLXColumn : public DLXNode
-{
-    std::size_t size;
-    std::size_t index;
-};
 template <typename T>
 struct Placement
 {
-    std::size_t row;
-    std::size_t col;
+    T row;
+    T col;
     T digit;
 };
 
@@ -34,115 +22,139 @@ public:
     using DataType = typename SudokuMatrix<N>::DataType;
 
 private:
+    static constexpr std::size_t Size = N * N;
+    static constexpr std::size_t CellCount = Size * Size;
+    static constexpr std::size_t ColumnCount = 4 * CellCount;
+    static constexpr std::size_t MaxNodeCount = 1 + ColumnCount + 4 * CellCount * Size;
+    // Links are indices into structure-of-arrays storage: node 0 is the header,
+    // nodes 1..ColumnCount are the column heads and every candidate row owns
+    // four consecutive nodes after them, so the row ring is implicit.
+    using IndexType = std::conditional_t<(MaxNodeCount <= std::numeric_limits<std::uint16_t>::max()), std::uint16_t, std::uint32_t>;
+    // A column never holds more than N * N rows.
+    using SizeType = std::conditional_t<(Size <= std::numeric_limits<std::uint8_t>::max()), std::uint8_t, std::uint16_t>;
+    static constexpr IndexType Header = 0;
+    static constexpr IndexType FirstRowNode = ColumnCount + 1;
+    static constexpr IndexType RowWidth = 4;
+
+    // Exact-cover matrix of the empty grid: one row per cell and digit, in
+    // cell-major order. It is built once per N and copied into every solver.
+    struct MatrixTemplate
+    {
+        std::vector<IndexType> left;
+        std::vector<IndexType> right;
+        std::vector<IndexType> up;
+        std::vector<IndexType> down;
+        std::vector<IndexType> column;
+        std::vector<SizeType> sizes;
+        // Cell and digit of every row.
+        std::vector<Placement<DataType>> placements;
+    };
+
     SudokuMatrix<N> m_data;
-    DLXColumn m_header = {};
-    std::vector<DLXNode *> m_solutionStack;
-    std::vector<DLXNode> m_nodes;
-    std::array<DLXColumn, 4 * N * N * N * N> m_columns;
+    const MatrixTemplate *m_template;
+    std::vector<IndexType> m_solutionStack;
+    // Left/right links only exist for the header and the column heads.
+    std::vector<IndexType> m_left;
+    std::vector<IndexType> m_right;
+    std::vector<IndexType> m_up;
+    std::vector<IndexType> m_down;
+    std::vector<IndexType> m_column;
+    std::vector<SizeType> m_sizes;
+    std::size_t m_solutionLimit = 1;
+    std::size_t m_solutionCount = 0;
     AdvanceResult m_currentState = AdvanceResult::Continue;
     bool m_solved = false;
-    static inline constexpr void CoverColumn(DLXColumn *c)
+    SUDOKU_NO_UNIQUE_ADDRESS SearchCounters<> m_stats;
+
+    static inline constexpr IndexType RowStart(IndexType node) noexcept
+    {
+        return static_cast<IndexType>(node - ((node - FirstRowNode) % RowWidth));
+    }
+
+    // The node `offset` steps to the right of `node` in its row.
+    static inline constexpr IndexType RowNeighbour(IndexType start, IndexType node, IndexType offset) noexcept
+    {
+        return static_cast<IndexType>(start + (node - start + offset) % RowWidth);
+    }
+
+    inline constexpr void CoverColumn(IndexType c)
     {
-        c->right->left = c->left;
-        c->left->right = c->right;
-        for (DLXNode *i = c->down; i != c; i = i->down)
+        m_stats.CoverOperation();
+        m_left[m_right[c]] = m_left[c];
+        m_right[m_left[c]] = m_right[c];
+        for (IndexType i = m_down[c]; i != c; i = m_down[i])
         {
-            for (DLXNode *j = i->right; j != i; j = j->right)
+            const IndexType start = RowStart(i);
+            for (IndexType offset = 1; offset < RowWidth; ++offset)
             {
-                j->up->down = j->down;
-                j->down->up = j->up;
-                static_cast<DLXColumn *>(j->column)->size--;
+                const IndexType j = RowNeighbour(start, i, offset);
+                m_down[m_up[j]] = m_down[j];
+                m_up[m_down[j]] = m_up[j];
+                m_sizes[m_column[j]]--;
             }
         }
     }
-    static inline constexpr void UncoverColumn(DLXColumn *c)
+
+    inline constexpr void UncoverColumn(IndexType c)
     {
-        for (DLXNode *i = c->up; i != c; i = i->up)
+        m_stats.CoverOperation();
+        for (IndexType i = m_up[c]; i != c; i = m_up[i])
         {
-            for (DLXNode *j = i->left; j != i; j = j->left)
+            const IndexType start = RowStart(i);
+            for (IndexType offset = RowWidth - 1; offset > 0; --offset)
             {
-                static_cast<DLXColumn *>(j->column)->size++;
-                j->up->down = j;
-                j->down->up = j;
+                const IndexType j = RowNeighbour(start, i, offset);
+                m_sizes[m_column[j]]++;
+                m_down[m_up[j]] = j;
+                m_up[m_down[j]] = j;
             }
         }
-        c->right->left = c;
-        c->left->right = c;
+        m_right[m_left[c]] = c;
+        m_left[m_right[c]] = c;
     }
 
-    static inline constexpr void CoverRow(DLXNode *rowNode)
+    inline constexpr void CoverRow(IndexType rowNode)
     {
-        CoverColumn(static_cast<DLXColumn *>(rowNode->column));
-        for (DLXNode *j = rowNode->right; j != rowNode; j = j->right)
+        const IndexType start = RowStart(rowNode);
+        CoverColumn(m_column[rowNode]);
+        for (IndexType offset = 1; offset < RowWidth; ++offset)
         {
-            CoverColumn(static_cast<DLXColumn *>(j->column));
+            CoverColumn(m_column[RowNeighbour(start, rowNode, offset)]);
         }
     }
 
-    static inline constexpr void UncoverRow(DLXNode *rowNode)
+    inline constexpr void UncoverRow(IndexType rowNode)
     {
-        for (DLXNode *j = rowNode->left; j != rowNode; j = j->left)
+        const IndexType start = RowStart(rowNode);
+        for (IndexType offset = RowWidth - 1; offset > 0; --offset)
         {
-            UncoverColumn(static_cast<DLXColumn *>(j->column));
+            UncoverColumn(m_column[RowNeighbour(start, rowNode, offset)]);
         }
-        UncoverColumn(static_cast<DLXColumn *>(rowNode->column));
+        UncoverColumn(m_column[rowNode]);
     }
 
-    inline constexpr DLXColumn *ChooseColumn() const noexcept
+    inline constexpr IndexType ChooseColumn() const noexcept
     {
-        DLXColumn *best = nullptr;
+        IndexType best = Header;
         std::size_t minSize = std::numeric_limits<std::size_t>::max();
-        for (DLXColumn *c = (DLXColumn *)m_header.right; c != &m_header; c = (DLXColumn *)c->right)
+        for (IndexType c = m_right[Header]; c != Header; c = m_right[c])
         {
-            if (c->size < minSize)
+            if (m_sizes[c] < minSize)
             {
-                minSize = c->size;
+                minSize = m_sizes[c];
                 best = c;
+                if (minSize == 0)
+                {
+                    break;
+                }
             }
         }
         return best;
     }
 
-    constexpr std::pair<std::size_t, std::size_t> GetRowColIndices(const std::span<const std::size_t> indices) const noexcept
+    inline constexpr const Placement<DataType> &DecodePlacement(IndexType rowNode) const noexcept
     {
-        constexpr std::size_t size = N * N;
-        constexpr std::size_t sizeSquared = size * size;
-        constexpr std::size_t doubleSizeSquared = 2 * sizeSquared;
-        std::size_t cellColIndex = std::numeric_limits<std::size_t>::min();
-        std::size_t rowColIndex = std::numeric_limits<std::size_t>::min();
-        for (const std::size_t ci : indices)
-        {
-            if (ci < sizeSquared)
-            {
-                cellColIndex = ci;
-            }
-            else if (ci >= sizeSquared && ci < doubleSizeSquared)
-            {
-                rowColIndex = ci;
-            }
-        }
-        return {cellColIndex, rowColIndex};
-    }
-
-    constexpr Placement<DataType> DecodePlacement(DLXNode *rowNode) const
-    {
-        static constexpr std::size_t size = N * N;
-        static constexpr std::size_t sizeSquared = size * size;
-
-        std::vector<std::size_t> colIndices;
-        DLXNode *cur = rowNode;
-        do
-        {
-            DLXColumn *col = static_cast<DLXColumn *>(cur->column);
-            colIndices.push_back(col->index);
-            cur = cur->right;
-        } while (cur != rowNode);
-
-        auto [cellColIndex, rowColIndex] = GetRowColIndices(colIndices);
-        std::size_t r = cellColIndex / size;
-        std::size_t c = cellColIndex % size;
-        DataType d = static_cast<DataType>((rowColIndex - sizeSquared) % size + 1);
-        return {r, c, d};
+        return m_template->placements[(rowNode - FirstRowNode) / RowWidth];
     }
 
     inline constexpr void FinalizeSolution()
@@ -154,100 +166,137 @@ private:
         }
     }
 
-    inline constexpr BitSetIterator<N> GetCandidates(std::size_t row, std::size_t column)
+    static inline void InsertIntoColumn(MatrixTemplate &matrix, IndexType node, IndexType column)
     {
-        DataType val = m_data.GetValue(row, column);
-        if (val != 0)
-        {
-            std::size_t value = val - 1;
-            typename BitSetIterator<N>::FlagType flag;
-            flag.set(value);
-            return {flag};
-        }
-        return m_data.GetPossibleValues(row, column);
+        matrix.column[node] = column;
+        matrix.up[node] = matrix.up[column];
+        matrix.down[node] = column;
+        matrix.down[matrix.up[column]] = node;
+        matrix.up[column] = node;
+        matrix.sizes[column]++;
     }
 
-    inline constexpr DLXColumn *InitializeColumn(DLXColumn *header, std::size_t index)
-    {
-        DLXColumn &col = m_columns[index];
-        DLXColumn *ptr = &col;
-        col.column = ptr;
-        col.size = 0;
-        col.index = index;
-        col.right = header;
-        col.left = header->left;
-        header->left->right = ptr;
-        header->left = ptr;
-        col.up = ptr;
-        col.down = ptr;
-        return ptr;
-    }
-
-public:
-    constexpr DLXSolver(const SudokuMatrix<N> &data) : m_data(data)
+    static MatrixTemplate BuildTemplate()
     {
         constexpr std::size_t size = N * N;
         constexpr std::size_t squaredSize = size * size;
-        constexpr std::size_t totalCols = 4 * size * size;
-        m_nodes.reserve(squaredSize * squaredSize);
-        m_solutionStack.reserve(squaredSize);
-        m_header.left = m_header.right = &m_header;
-        m_header.up = m_header.down = &m_header;
-        m_header.column = &m_header;
-        m_header.size = 0;
-        for (std::size_t i = 0; i < totalCols; i++)
+        constexpr std::size_t nodeCount = FirstRowNode + RowWidth * CellCount * Size;
+        MatrixTemplate matrix;
+        matrix.left.resize(FirstRowNode);
+        matrix.right.resize(FirstRowNode);
+        matrix.up.resize(nodeCount);
+        matrix.down.resize(nodeCount);
+        matrix.column.resize(nodeCount);
+        matrix.sizes.assign(FirstRowNode, 0);
+        matrix.placements.reserve(CellCount * Size);
+        for (std::size_t c = 0; c < FirstRowNode; c++)
         {
-            InitializeColumn(&m_header, i);
+            matrix.left[c] = static_cast<IndexType>(c == 0 ? ColumnCount : c - 1);
+            matrix.right[c] = static_cast<IndexType>(c == ColumnCount ? 0 : c + 1);
+            matrix.up[c] = matrix.down[c] = matrix.column[c] = static_cast<IndexType>(c);
         }
         auto boxIndex = [](std::size_t r, std::size_t c)
         {
             return (r / N) * N + (c / N);
         };
+        IndexType node = FirstRowNode;
         for (std::size_t row = 0; row < size; row++)
         {
             for (std::size_t column = 0; column < size; column++)
             {
-                for (DataType d : GetCandidates(row, column))
+                for (std::size_t d = 1; d <= size; d++)
                 {
                     std::size_t cellCol = row * size + column;
                     std::size_t rowCol = squaredSize + row * size + (d - 1);
                     std::size_t colCol = 2 * squaredSize + column * size + (d - 1);
                     std::size_t boxCol = 3 * squaredSize + boxIndex(row, column) * size + (d - 1);
+                    InsertIntoColumn(matrix, node++, static_cast<IndexType>(cellCol + 1));
+                    InsertIntoColumn(matrix, node++, static_cast<IndexType>(rowCol + 1));
+                    InsertIntoColumn(matrix, node++, static_cast<IndexType>(colCol + 1));
+                    InsertIntoColumn(matrix, node++, static_cast<IndexType>(boxCol + 1));
+                    matrix.placements.push_back({static_cast<DataType>(row), static_cast<DataType>(column), static_cast<DataType>(d)});
+                }
+            }
+        }
+        return matrix;
+    }
 
-                    DLXNode *n1 = &m_nodes.emplace_back();
-                    DLXNode *n2 = &m_nodes.emplace_back();
-                    DLXNode *n3 = &m_nodes.emplace_back();
-                    DLXNode *n4 = &m_nodes.emplace_back();
+    static const MatrixTemplate &GetTemplate()
+    {
+        static const MatrixTemplate matrix = BuildTemplate();
+        return matrix;
+    }
 
-                    n1->right = n2;
-                    n2->right = n3;
-                    n3->right = n4;
-                    n4->right = n1;
-                    n1->left = n4;
-                    n2->left = n1;
-                    n3->left = n2;
-                    n4->left = n3;
-                    auto insert_into_column = [](DLXNode *node, DLXColumn *col)
-                    {
-                        node->column = col;
-                        node->up = col->up;
-                        node->down = col;
-                        col->up->down = node;
-                        col->up = node;
-                        col->size++;
-                    };
-                    insert_into_column(n1, &m_columns[cellCol]);
-                    insert_into_column(n2, &m_columns[rowCol]);
-                    insert_into_column(n3, &m_columns[colCol]);
-                    insert_into_column(n4, &m_columns[boxCol]);
-                }
+    static inline constexpr IndexType RowNode(std::size_t cell, DataType digit) noexcept
+    {
+        return static_cast<IndexType>(FirstRowNode + RowWidth * (cell * Size + digit - 1));
+    }
+
+    // A given can only be placed while none of its four constraints is covered.
+    inline constexpr bool IsRowAvailable(IndexType rowNode) const noexcept
+    {
+        for (IndexType offset = 0; offset < RowWidth; ++offset)
+        {
+            const IndexType c = m_column[rowNode + offset];
+            if (m_right[m_left[c]] != c)
+            {
+                return false;
             }
         }
+        return true;
+    }
+
+    // Restores the template with plain copies (no allocation once the vectors
+    // are sized) and covers the rows of the givens.
+    inline void Initialize()
+    {
+        const MatrixTemplate &matrix = *m_template;
+        m_left.assign(matrix.left.begin(), matrix.left.end());
+        m_right.assign(matrix.right.begin(), matrix.right.end());
+        m_up.assign(matrix.up.begin(), matrix.up.end());
+        m_down.assign(matrix.down.begin(), matrix.down.end());
+        m_column.assign(matrix.column.begin(), matrix.column.end());
+        m_sizes.assign(matrix.sizes.begin(), matrix.sizes.end());
+        m_solutionStack.clear();
+        m_solutionLimit = 1;
+        m_solutionCount = 0;
+        m_currentState = AdvanceResult::Continue;
+        m_solved = false;
+        m_stats.Reset();
+        for (std::size_t cell = 0; cell < CellCount; cell++)
+        {
+            const DataType value = m_data.GetValue(cell);
+            if (value == 0)
+            {
+                continue;
+            }
+            const IndexType rowNode = RowNode(cell, value);
+            if (!IsRowAvailable(rowNode))
+            {
+                m_currentState = AdvanceResult::Finished;
+                return;
+            }
+            CoverRow(rowNode);
+        }
+    }
+
+public:
+    DLXSolver(const SudokuMatrix<N> &data) : m_data(data), m_template(&GetTemplate())
+    {
+        m_solutionStack.reserve(CellCount);
+        Initialize();
+    }
+
+    inline void Reset(const SudokuMatrix<N> &data)
+    {
+        m_data = data;
+        Initialize();
     }
 
     inline constexpr bool IsSolved() const noexcept override { return m_solved; }
     inline constexpr AdvanceResult GetStatus() const noexcept override { return m_currentState; }
     inline constexpr const SudokuMatrix<N> &GetBoard() const noexcept override { return m_data; }
+    inline constexpr SearchStats GetStats() const noexcept { return m_stats.Get(); }
 
     constexpr bool Advance(bool insertEveryStep)
     {
@@ -257,8 +306,13 @@ public:
             return false;
         }
 
-        if (m_header.right == &m_header)
+        if (m_currentState == AdvanceResult::Continue && m_right[Header] == Header)
         {
+            if (++m_solutionCount < m_solutionLimit)
+            {
+                // Keep searching as if the last choice had failed.
+                return BackTrack();
+            }
             m_solved = true;
             m_currentState = AdvanceResult::Finished;
             FinalizeSolution();
@@ -267,32 +321,30 @@ public:
 
         if (m_currentState == AdvanceResult::Continue)
         {
-            DLXColumn *col = ChooseColumn();
-            if (!col || col->size == 0)
+            IndexType col = ChooseColumn();
+            m_stats.Expand(m_solutionStack.size());
+            if (col == Header || m_sizes[col] == 0)
             {
+                m_stats.Backtrack();
                 return BackTrack();
             }
-            DLXNode *choice = col->down;
-            if (choice == col)
-            {
-                return BackTrack();
-            }
-            ChooseRow(choice, insertEveryStep);
+            ChooseRow(m_down[col], insertEveryStep);
             return Continue();
         }
         if (m_solutionStack.empty())
         {
             m_currentState = AdvanceResult::Finished;
+            m_solved = false;
             return false;
         }
 
-        DLXNode *lastChoice = m_solutionStack.back();
+        IndexType lastChoice = m_solutionStack.back();
         m_solutionStack.pop_back();
         UncoverRow(lastChoice);
-        DLXColumn *c = static_cast<DLXColumn *>(lastChoice->column);
-        DLXNode *nextChoice = lastChoice->down;
-        if (nextChoice == c)
+        IndexType nextChoice = m_down[lastChoice];
+        if (nextChoice == m_column[lastChoice])
         {
+            m_stats.Backtrack();
             return BackTrack();
         }
         ChooseRow(nextChoice, insertEveryStep);
@@ -302,6 +354,39 @@ public:
     {
         return Advance(true);
     }
+    // Steps with Advance(false), so the board is only decoded once solved.
+    constexpr SolveResult Solve(std::uint64_t maxSteps = NoStepLimit)
+    {
+        return MakeSolveResult(*this, RunSteps([this]
+                                               { return Advance(false); }, maxSteps));
+    }
+    SolveResult Solve(const SolveLimits &limits)
+    {
+        return RunStepsWithin(*this, [this](std::uint64_t maxSteps)
+                              { return RunSteps([this]
+                                                { return Advance(false); }, maxSteps); }, limits);
+    }
+
+    // Runs the search until `limit` solutions have been found or the tree is
+    // exhausted, without decoding any board on the way. A limit of 2 tells
+    // unique puzzles apart. Only when the limit is reached is the last
+    // solution decoded and IsSolved() true; an exhausted search leaves the
+    // givens. A limit of 0 returns 0 without searching.
+    constexpr std::size_t CountSolutions(std::size_t limit)
+    {
+        if (limit == 0)
+        {
+            return 0;
+        }
+        m_solutionLimit = limit;
+        while (Advance(false))
+            ;
+        return m_solutionCount;
+    }
+    inline constexpr std::size_t GetSolutionCount() const noexcept
+    {
+        return m_solutionCount;
+    }
 
 private:
     inline constexpr bool Continue()
@@ -316,8 +401,9 @@ private:
         return true;
     }
 
-    inline constexpr void ChooseRow(DLXNode *rowNode, bool insertValue)
+    inline constexpr void ChooseRow(IndexType rowNode, bool insertValue)
     {
+        m_stats.TryCandidate();
         m_solutionStack.push_back(rowNode);
         CoverRow(rowNode);
         if (insertValue)
@@ -0,0 +1,301 @@
+#pragma once
+#include <vector>
+#include "./StateMachineStatus.hpp"
+#include "./ISolver.hpp"
+#include "./SolveResult.hpp"
+#include "./SearchStats.hpp"
+#include "../CandidateCache.hpp"
+
+// Propagates naked and hidden singles to a fixpoint after every placement and
+// branches on the empty cell with the fewest candidates (MRV). Candidates live
+// in a CandidateCache, so singles and the MRV cell come from its buckets.
+// Each call to Advance() takes one step of the search that Solve runs as a
+// single loop. A branch keeps a checkpoint of the solver's SudokuTrail instead
+// of a copy of the board and the cache: every placement records the peers it
+// eliminated from, so going back to a branch undoes the board and the cache
+// together and the frames stay a few words whatever the board size.
+template <std::size_t N>
+class PropagationSolver : public ISolver<N>
+{
+public:
+    using DataType = typename SudokuMatrix<N>::DataType;
+    using FlagType = typename BitSetIterator<N>::FlagType;
+
+private:
+    static constexpr std::size_t Size = N * N;
+    static constexpr std::size_t CellCount = Size * Size;
+    static constexpr std::size_t UnitCount = 3 * Size;
+    using IndexType = std::conditional_t<(CellCount <= std::numeric_limits<std::uint16_t>::max()), std::uint16_t, std::uint32_t>;
+    using Traits = UnitMaskTraits<N>;
+
+    struct Frame
+    {
+        std::size_t checkpoint;
+        std::size_t cell;
+        FlagType remaining;
+    };
+
+    // Cells of every row, column and square, in that order.
+    static constexpr std::array<std::array<IndexType, Size>, UnitCount> Units = []()
+    {
+        std::array<std::array<IndexType, Size>, UnitCount> units{};
+        for (std::size_t i = 0; i < Size; ++i)
+        {
+            for (std::size_t j = 0; j < Size; ++j)
+            {
+                units[i][j] = static_cast<IndexType>(i * Size + j);
+                units[Size + i][j] = static_cast<IndexType>(j * Size + i);
+                std::size_t row = (i / N) * N + j / N;
+                std::size_t col = (i % N) * N + j % N;
+                units[2 * Size + i][j] = static_cast<IndexType>(row * Size + col);
+            }
+        }
+        return units;
+    }();
+
+    static constexpr FlagType AllDigits = Traits::All;
+
+    SudokuMatrix<N> m_data;
+    CandidateCache<N> m_cache;
+    // Every placement on m_data, so a frame can roll the board and the cache
+    // back.
+    SudokuTrail<N> m_trail;
+    std::vector<Frame> m_frames;
+    AdvanceResult m_currentState = AdvanceResult::Continue;
+    bool m_solved = false;
+    SUDOKU_NO_UNIQUE_ADDRESS SearchCounters<> m_stats;
+
+    inline constexpr void InitializeCandidates()
+    {
+        // A path places each cell once and takes each candidate at most once,
+        // so the trail never grows past this.
+        m_trail.Clear();
+        m_trail.Reserve(CellCount, CellCount * Size);
+        m_cache.Reset(m_data);
+        m_stats.Reset();
+    }
+
+    // Placement forced by propagation; choices go to the cache directly.
+    inline constexpr void Place(std::size_t index, DataType value)
+    {
+        m_stats.Eliminate(m_cache.SetValue(m_data, m_trail, index, value));
+    }
+
+    inline constexpr bool PlaceNakedSingles(bool &changed)
+    {
+        while (m_cache.GetEmptyCount() != 0)
+        {
+            const std::size_t count = m_cache.GetMinCount();
+            if (count == 0)
+            {
+                return false;
+            }
+            if (count != 1)
+            {
+                break;
+            }
+            const std::size_t index = m_cache.GetMinCell();
+            Place(index, static_cast<DataType>(Traits::Lowest(m_cache.GetCandidates(index)) + 1));
+            changed = true;
+        }
+        return true;
+    }
+
+    inline constexpr bool PlaceHiddenSingles(bool &changed)
+    {
+        for (const auto &unit : Units)
+        {
+            FlagType once{};
+            FlagType twice{};
+            FlagType placed{};
+            for (const IndexType index : unit)
+            {
+                DataType value = m_data.GetValue(index);
+                if (value != 0)
+                {
+                    placed |= Traits::Bit(value - 1);
+                    continue;
+                }
+                twice |= static_cast<FlagType>(once & m_cache.GetCandidates(index));
+                once |= m_cache.GetCandidates(index);
+            }
+            if ((once | placed) != AllDigits)
+            {
+                return false;
+            }
+            for (DataType digit : BitSetIterator<N>{static_cast<FlagType>(once & Traits::Complement(twice))})
+            {
+                const std::size_t bit = digit - 1;
+                bool found = false;
+                for (const IndexType index : unit)
+                {
+                    if (m_data.GetValue(index) == 0 && Traits::Test(m_cache.GetCandidates(index), bit))
+                    {
+                        Place(index, digit);
+                        found = true;
+                        break;
+                    }
+                }
+                if (!found)
+                {
+                    return false;
+                }
+                changed = true;
+            }
+        }
+        return true;
+    }
+
+    inline constexpr bool Propagate()
+    {
+        bool changed = true;
+        while (changed && m_cache.GetEmptyCount() != 0)
+        {
+            changed = false;
+            if (!PlaceNakedSingles(changed))
+            {
+                return false;
+            }
+            if (changed)
+            {
+                continue;
+            }
+            if (!PlaceHiddenSingles(changed))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline constexpr void Branch()
+    {
+        m_stats.Expand(m_frames.size());
+        m_stats.TryCandidate();
+        std::size_t cell = m_cache.GetMinCell();
+        FlagType remaining = m_cache.GetCandidates(cell);
+        std::size_t bit = Traits::Lowest(remaining);
+        Traits::Reset(remaining, bit);
+        m_frames.push_back({m_trail.Checkpoint(), cell, remaining});
+        m_cache.SetValue(m_data, m_trail, cell, static_cast<DataType>(bit + 1));
+    }
+
+    // Places the next candidate of the newest open branch, or returns false
+    // when no branch has one left.
+    inline constexpr bool Retry()
+    {
+        while (!m_frames.empty())
+        {
+            Frame &frame = m_frames.back();
+            if (!Traits::Any(frame.remaining))
+            {
+                m_frames.pop_back();
+                continue;
+            }
+            m_cache.RollbackTo(m_data, m_trail, frame.checkpoint);
+            std::size_t cell = frame.cell;
+            std::size_t bit = Traits::Lowest(frame.remaining);
+            Traits::Reset(frame.remaining, bit);
+            if (!Traits::Any(frame.remaining))
+            {
+                m_frames.pop_back();
+            }
+            m_stats.TryCandidate();
+            m_cache.SetValue(m_data, m_trail, cell, static_cast<DataType>(bit + 1));
+            return true;
+        }
+        return false;
+    }
+
+    // The search behind Solve and Advance. Takes up to `maxSteps` steps (a
+    // propagation that ends in a branch or a dead end, or a retry) and
+    // returns how many it took; fewer means the search finished. The
+    // direction stays in a local and is stored back when it returns.
+    inline constexpr std::uint64_t Search(std::uint64_t maxSteps)
+    {
+        if (m_currentState == AdvanceResult::Finished)
+        {
+            return 0;
+        }
+        if (m_cache.HasConflict())
+        {
+            m_currentState = AdvanceResult::Finished;
+            m_solved = false;
+            return 0;
+        }
+        bool backTracking = m_currentState == AdvanceResult::BackTracking;
+        std::uint64_t steps = 0;
+        for (; steps < maxSteps; ++steps)
+        {
+            if (backTracking)
+            {
+                if (!Retry())
+                {
+                    m_currentState = AdvanceResult::Finished;
+                    m_solved = false;
+                    return steps;
+                }
+                backTracking = false;
+                continue;
+            }
+            if (!Propagate())
+            {
+                m_stats.Backtrack();
+                backTracking = true;
+                continue;
+            }
+            if (m_cache.GetEmptyCount() == 0)
+            {
+                m_currentState = AdvanceResult::Finished;
+                m_solved = true;
+                return steps;
+            }
+            Branch();
+        }
+        m_currentState = backTracking ? AdvanceResult::BackTracking : AdvanceResult::Continue;
+        return steps;
+    }
+
+public:
+    constexpr PropagationSolver() : m_data{} { InitializeCandidates(); }
+    constexpr PropagationSolver(const SudokuMatrix<N> &data) : m_data(data) { InitializeCandidates(); }
+    constexpr PropagationSolver(SudokuMatrix<N> &&data) : m_data(std::move(data)) { InitializeCandidates(); }
+    inline constexpr void Reset(const SudokuMatrix<N> &data)
+    {
+        m_data = data;
+        m_frames.clear();
+        InitializeCandidates();
+        m_currentState = AdvanceResult::Continue;
+        m_solved = false;
+    }
+
+    constexpr SolveResult Solve(std::uint64_t maxSteps = NoStepLimit)
+    {
+        return MakeSolveResult(*this, Search(maxSteps));
+    }
+    SolveResult Solve(const SolveLimits &limits)
+    {
+        return RunStepsWithin(*this, [this](std::uint64_t maxSteps)
+                              { return Search(maxSteps); }, limits);
+    }
+    constexpr bool Advance() override
+    {
+        return Search(1) != 0;
+    }
+    inline constexpr AdvanceResult GetStatus() const noexcept override
+    {
+        return m_currentState;
+    }
+    inline constexpr const SudokuMatrix<N> &GetBoard() const noexcept override
+    {
+        return m_data;
+    }
+    inline constexpr bool IsSolved() const noexcept override
+    {
+        return m_solved;
+    }
+    inline constexpr SearchStats GetStats() const noexcept
+    {
+        return m_stats.Get();
+    }
+};
\ No newline at end of file
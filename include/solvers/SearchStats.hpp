@@ -0,0 +1,104 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Counters describing the shape of a search, read through GetStats() on every
+// solver. They only count when SUDOKU_SOLVER_STATS is defined; otherwise the
+// solvers hold an empty SearchCounters<false> and GetStats() returns zeros.
+// The macro changes the solvers' layout, so every translation unit of a
+// program must agree on it; CMake defines it for the whole project.
+// The counters cover everything since construction or the last Reset(), so a
+// search resumed over several Solve calls keeps adding up.
+struct SearchStats
+{
+    // Nodes where the search picked a cell (or DLX column) to branch on.
+    std::uint64_t nodes = 0;
+    // Values placed on those nodes, first choices and retries alike.
+    std::uint64_t candidatesTried = 0;
+    // Dead ends: a cell or DLX column left with no value to try, or a
+    // contradiction found by propagation.
+    std::uint64_t backtracks = 0;
+    // Choices made above the deepest expanded node: cells (or DLX rows)
+    // assigned by the search, never the givens, so it reads the same for
+    // every solver.
+    std::uint64_t maxDepth = 0;
+    // Candidates removed from open cells by propagation.
+    std::uint64_t eliminations = 0;
+    // DLX column covers and uncovers, those of the givens included.
+    std::uint64_t coverOperations = 0;
+
+    // Adds up the counters of another search, keeping the deeper maxDepth.
+    constexpr void Merge(const SearchStats &other) noexcept
+    {
+        nodes += other.nodes;
+        candidatesTried += other.candidatesTried;
+        backtracks += other.backtracks;
+        maxDepth = std::max(maxDepth, other.maxDepth);
+        eliminations += other.eliminations;
+        coverOperations += other.coverOperations;
+    }
+
+    constexpr bool operator==(const SearchStats &) const = default;
+};
+
+#if defined(SUDOKU_SOLVER_STATS)
+inline constexpr bool SearchStatsEnabled = true;
+#else
+inline constexpr bool SearchStatsEnabled = false;
+#endif
+
+// Lets an empty SearchCounters<false> member take no space in the solvers.
+#if defined(_MSC_VER)
+#define SUDOKU_NO_UNIQUE_ADDRESS [[msvc::no_unique_address]]
+#else
+#define SUDOKU_NO_UNIQUE_ADDRESS [[no_unique_address]]
+#endif
+
+// Solvers with a choice stack pass its size to Expand(depth). Those without
+// one push and pop their choices here and call Expand().
+template <bool Enabled = SearchStatsEnabled>
+class SearchCounters
+{
+    SearchStats m_stats{};
+    std::size_t m_depth = 0;
+
+public:
+    inline constexpr void Reset() noexcept
+    {
+        m_stats = {};
+        m_depth = 0;
+    }
+    inline constexpr void Expand(std::size_t depth) noexcept
+    {
+        m_stats.nodes++;
+        m_stats.maxDepth = std::max<std::uint64_t>(m_stats.maxDepth, depth);
+    }
+    inline constexpr void Expand() noexcept { Expand(m_depth); }
+    inline constexpr void PushChoice() noexcept { m_depth++; }
+    inline constexpr void PopChoice() noexcept { m_depth--; }
+    inline constexpr void TryCandidate() noexcept { m_stats.candidatesTried++; }
+    inline constexpr void Backtrack() noexcept { m_stats.backtracks++; }
+    inline constexpr void Eliminate(std::uint64_t count) noexcept { m_stats.eliminations += count; }
+    inline constexpr void CoverOperation() noexcept { m_stats.coverOperations++; }
+    inline constexpr SearchStats Get() const noexcept { return m_stats; }
+};
+
+template <>
+class SearchCounters<false>
+{
+public:
+    inline constexpr void Reset() noexcept {}
+    inline constexpr void Expand(std::size_t) noexcept {}
+    inline constexpr void Expand() noexcept {}
+    inline constexpr void PushChoice() noexcept {}
+    inline constexpr void PopChoice() noexcept {}
+    inline constexpr void TryCandidate() noexcept {}
+    inline constexpr void Backtrack() noexcept {}
+    inline constexpr void Eliminate(std::uint64_t) noexcept {}
+    inline constexpr void CoverOperation() noexcept {}
+    inline constexpr SearchStats Get() const noexcept { return {}; }
+};
+
+static_assert(std::is_empty_v<SearchCounters<false>>);
\ No newline at end of file
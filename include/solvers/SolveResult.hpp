@@ -0,0 +1,93 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <stop_token>
+#include "./SolveStatus.hpp"
+#include "./StateMachineStatus.hpp"
+
+// Every solver pairs Advance(), one virtual step at a time for the
+// visualizer, with Solve(maxSteps) and Solve(limits), which run the search
+// without virtual calls and report how the search ended and how many steps it
+// took. The backtracking and propagation solvers run it as one internal loop;
+// the others loop over their own step function with RunSteps. A stopped solver keeps its search state, so Solve
+// can be called again to resume it, and Reset() reuses its memory.
+struct SolveResult
+{
+    SolveStatus status;
+    std::uint64_t steps;
+};
+
+inline constexpr std::uint64_t NoStepLimit = std::numeric_limits<std::uint64_t>::max();
+inline constexpr std::chrono::steady_clock::time_point NoDeadline = std::chrono::steady_clock::time_point::max();
+
+struct SolveLimits
+{
+    std::uint64_t maxSteps = NoStepLimit;
+    std::chrono::steady_clock::time_point deadline = NoDeadline;
+    std::stop_token stopToken{};
+    // The deadline and the stop token are checked once per this many steps,
+    // so Solve returns at most this many steps after either is hit.
+    std::uint64_t checkInterval = 1024;
+};
+
+// Calls step() until it returns false or `maxSteps` calls have returned true,
+// and returns the number of calls that did.
+template <class Step>
+inline constexpr std::uint64_t RunSteps(Step &&step, std::uint64_t maxSteps)
+{
+    std::uint64_t steps = 0;
+    while (steps < maxSteps && step())
+    {
+        ++steps;
+    }
+    return steps;
+}
+
+// A solver that stopped short of Finished ran out of budget.
+template <class Solver>
+inline constexpr SolveResult MakeSolveResult(const Solver &solver, std::uint64_t steps)
+{
+    if (solver.IsSolved())
+    {
+        return {SolveStatus::Solved, steps};
+    }
+    return {solver.GetStatus() == AdvanceResult::Finished ? SolveStatus::Unsolvable : SolveStatus::BudgetExhausted, steps};
+}
+
+// Runs the search in chunks of `limits.checkInterval` steps, checking the
+// stop token and the deadline before each chunk. run(n) takes up to n steps
+// and returns how many it took, fewer once the search is over. A solver that is already done
+// reports its outcome whatever the limits. The clock is never read when
+// there is no deadline.
+template <class Solver, class Run>
+inline SolveResult RunStepsWithin(const Solver &solver, Run &&run, const SolveLimits &limits)
+{
+    if (solver.IsSolved() || solver.GetStatus() == AdvanceResult::Finished)
+    {
+        return MakeSolveResult(solver, 0);
+    }
+    const std::uint64_t interval = std::max<std::uint64_t>(limits.checkInterval, 1);
+    const bool timed = limits.deadline != NoDeadline;
+    std::uint64_t steps = 0;
+    while (steps < limits.maxSteps)
+    {
+        if (limits.stopToken.stop_requested())
+        {
+            return {SolveStatus::Cancelled, steps};
+        }
+        if (timed && std::chrono::steady_clock::now() >= limits.deadline)
+        {
+            return {SolveStatus::DeadlineExceeded, steps};
+        }
+        const std::uint64_t chunk = std::min(interval, limits.maxSteps - steps);
+        const std::uint64_t taken = run(chunk);
+        steps += taken;
+        if (taken != chunk)
+        {
+            break;
+        }
+    }
+    return MakeSolveResult(solver, steps);
+}
\ No newline at end of file
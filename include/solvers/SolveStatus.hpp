@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+enum class SolveStatus : std::uint8_t
+{
+    Solved,
+    Unsolvable,
+    BudgetExhausted,
+    // Solve(limits) saw its stop token triggered.
+    Cancelled,
+    // Solve(limits) ran past its deadline.
+    DeadlineExceeded
+};
\ No newline at end of file
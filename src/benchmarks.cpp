@@ -1,10 +1,91 @@
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
 #include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <pcg_random.hpp>
 #include <benchmark/benchmark.h>
+#include "../include/BitKernels.hpp"
+#include "../include/LatencyHistogram.hpp"
 #include "../include/SudokuMatrix.hpp"
 #include "../include/SudokuUtilities.hpp"
+#include "../include/BatchSolver.hpp"
+#include "../include/ParallelSolver.hpp"
+#include "../include/PuzzleIO.hpp"
+#include "../include/PuzzleArchive.hpp"
+#include "../include/PuzzleGenerator.hpp"
 #include "../include/solvers/BackTracking.hpp"
 #include "../include/solvers/DlxSolver.hpp"
+#include "../include/solvers/PropagationSolver.hpp"
+#include "../include/solvers/BandSolver.hpp"
+
+// Every kernel variant on the same machine; unsupported ones are skipped.
+// The argument is the set width in 64-bit words.
+template <SimdLevel Level>
+static void BM_FindFirstSet(benchmark::State &state)
+{
+    if (!IsSupported(Level, GetCpuFeatures()))
+    {
+        state.SkipWithError("instruction set not supported by this CPU");
+        return;
+    }
+    const BitKernels::KernelTable kernels = BitKernels::GetKernels(Level);
+    const std::size_t words = static_cast<std::size_t>(state.range(0));
+    // 256 sets whose first set bit sits in a random word.
+    pcg64 rng(1);
+    std::vector<std::uint64_t> sets(256 * words, 0);
+    for (std::size_t i = 0; i < 256; ++i)
+    {
+        sets[i * words + rng() % words] = rng() | 1;
+    }
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < 256; ++i)
+        {
+            benchmark::DoNotOptimize(kernels.findFirstSet(sets.data() + i * words, words));
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * 256);
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * sets.size() * sizeof(std::uint64_t)));
+}
+
+template <SimdLevel Level>
+static void BM_PopCount(benchmark::State &state)
+{
+    if (!IsSupported(Level, GetCpuFeatures()))
+    {
+        state.SkipWithError("instruction set not supported by this CPU");
+        return;
+    }
+    const BitKernels::KernelTable kernels = BitKernels::GetKernels(Level);
+    const std::size_t words = static_cast<std::size_t>(state.range(0));
+    pcg64 rng(1);
+    std::vector<std::uint64_t> sets(256 * words);
+    for (std::uint64_t &word : sets)
+    {
+        word = rng();
+    }
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0; i < 256; ++i)
+        {
+            benchmark::DoNotOptimize(kernels.popCount(sets.data() + i * words, words));
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * 256);
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * sets.size() * sizeof(std::uint64_t)));
+}
+
+BENCHMARK(BM_FindFirstSet<SimdLevel::Scalar>)->RangeMultiplier(4)->Range(4, 64);
+BENCHMARK(BM_FindFirstSet<SimdLevel::Avx2>)->RangeMultiplier(4)->Range(4, 64);
+BENCHMARK(BM_FindFirstSet<SimdLevel::Avx512>)->RangeMultiplier(4)->Range(4, 64);
+BENCHMARK(BM_PopCount<SimdLevel::Scalar>)->RangeMultiplier(4)->Range(4, 64);
+BENCHMARK(BM_PopCount<SimdLevel::Avx2>)->RangeMultiplier(4)->Range(4, 64);
+BENCHMARK(BM_PopCount<SimdLevel::Avx512>)->RangeMultiplier(4)->Range(4, 64);
 
 template <std::size_t N>
 static void BM_CreateBoard(benchmark::State &state)
@@ -25,6 +106,208 @@ BENCHMARK(BM_CreateBoard<3>)->DenseRange(10, 90, 20);
 BENCHMARK(BM_CreateBoard<4>)->DenseRange(10, 90, 20);
 BENCHMARK(BM_CreateBoard<5>)->DenseRange(10, 90, 20);
 
+// Puzzle text of 16384 random boards, one per line.
+template <std::size_t N>
+static std::string CreatePuzzleText()
+{
+    pcg64 rng(1);
+    std::string text;
+    for (std::size_t i = 0; i < 16384; ++i)
+    {
+        text += FormatPuzzle(CreateBoard<N>(0.3f, rng));
+        text += '\n';
+    }
+    return text;
+}
+
+// PuzzleReader over text in memory, as it reads a MappedFile once the pages
+// are cached. SUDOKU_SIMD=scalar shows the parser without AVX2.
+template <std::size_t N>
+static void BM_ReadPuzzles(benchmark::State &state)
+{
+    const std::string text = CreatePuzzleText<N>();
+    for (auto _ : state)
+    {
+        PuzzleReader<N> reader(text);
+        while (auto puzzle = reader.Next())
+        {
+            benchmark::DoNotOptimize(*puzzle);
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * 16384);
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * text.size()));
+}
+
+// The same text through std::getline, for comparison.
+template <std::size_t N>
+static void BM_ReadPuzzleStream(benchmark::State &state)
+{
+    const std::string text = CreatePuzzleText<N>();
+    for (auto _ : state)
+    {
+        std::istringstream input(text);
+        benchmark::DoNotOptimize(LoadPuzzles<N>(input));
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * 16384);
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * text.size()));
+}
+
+// Discards everything written to it.
+class NullBuffer : public std::streambuf
+{
+protected:
+    std::streamsize xsputn(const char *, std::streamsize count) override { return count; }
+    int overflow(int c) override { return c; }
+};
+
+template <std::size_t N>
+static void BM_WritePuzzles(benchmark::State &state)
+{
+    const std::string text = CreatePuzzleText<N>();
+    std::istringstream input(text);
+    const std::vector<SudokuMatrix<N>> boards = *LoadPuzzles<N>(input);
+    NullBuffer buffer;
+    std::ostream output(&buffer);
+    for (auto _ : state)
+    {
+        PuzzleWriter<N> writer(output);
+        for (const SudokuMatrix<N> &board : boards)
+        {
+            writer.Write(board);
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * boards.size()));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * text.size()));
+}
+
+// The boards of CreatePuzzleText as a packed archive in memory, decoded in
+// place; bytes_per_second counts the text they stand for, to compare with
+// BM_ReadPuzzles.
+template <std::size_t N>
+static void BM_ReadArchive(benchmark::State &state)
+{
+    const std::string text = CreatePuzzleText<N>();
+    std::istringstream input(text);
+    const std::vector<SudokuMatrix<N>> boards = *LoadPuzzles<N>(input);
+    std::ostringstream output;
+    WritePuzzleArchive<N>(output, boards);
+    const std::string bytes = output.str();
+    const PuzzleArchive<N> archive = *PuzzleArchive<N>::Parse(bytes);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(archive.GetPuzzles());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * boards.size()));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * text.size()));
+    state.counters["archive_bytes"] = static_cast<double>(bytes.size());
+    state.counters["text_bytes"] = static_cast<double>(text.size());
+}
+
+template <std::size_t N>
+static void BM_WriteArchive(benchmark::State &state)
+{
+    const std::string text = CreatePuzzleText<N>();
+    std::istringstream input(text);
+    const std::vector<SudokuMatrix<N>> boards = *LoadPuzzles<N>(input);
+    NullBuffer buffer;
+    std::ostream output(&buffer);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(WritePuzzleArchive<N>(output, boards));
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * boards.size()));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * text.size()));
+}
+
+BENCHMARK(BM_ReadPuzzles<3>);
+BENCHMARK(BM_ReadPuzzles<4>);
+BENCHMARK(BM_ReadPuzzleStream<3>);
+BENCHMARK(BM_WritePuzzles<3>);
+BENCHMARK(BM_WritePuzzles<4>);
+BENCHMARK(BM_ReadArchive<3>);
+BENCHMARK(BM_ReadArchive<5>);
+BENCHMARK(BM_WriteArchive<3>);
+BENCHMARK(BM_WriteArchive<5>);
+
+// Unique puzzles from one core; the argument is the target clue count, 0
+// for minimal puzzles.
+template <std::size_t N>
+static void BM_GeneratePuzzle(benchmark::State &state)
+{
+    pcg64 rng(1);
+    GeneratorOptions options;
+    options.targetClues = static_cast<std::size_t>(state.range(0));
+    std::int64_t puzzles = 0;
+    for (auto _ : state)
+    {
+        auto puzzle = GeneratePuzzle<N>(rng, options);
+        benchmark::DoNotOptimize(puzzle);
+        puzzles++;
+    }
+    state.SetItemsProcessed(puzzles);
+}
+
+BENCHMARK(BM_GeneratePuzzle<3>)->Arg(0)->Arg(30)->Arg(40);
+BENCHMARK(BM_GeneratePuzzle<4>)->Arg(0)->Arg(128)->Unit(benchmark::kMillisecond);
+
+// Candidates of every cell of a 40% filled board, one GetPossibleValues call
+// per cell against one ComputeAllCandidates pass.
+template <std::size_t N>
+static void BM_CellCandidates(benchmark::State &state)
+{
+    constexpr std::size_t size = N * N;
+    pcg64 rng(1);
+    const SudokuMatrix<N> board = CreateBoard<N>(0.4f, rng);
+    std::vector<typename SudokuMatrix<N>::MaskType> candidates(size * size);
+    std::vector<typename SudokuMatrix<N>::DataType> counts(size * size);
+    for (auto _ : state)
+    {
+        for (std::size_t row = 0; row < size; ++row)
+        {
+            for (std::size_t col = 0; col < size; ++col)
+            {
+                const std::size_t index = SudokuMatrix<N>::MatrixIndex(row, col);
+                if (board.GetValue(index) != 0)
+                {
+                    candidates[index] = {};
+                    counts[index] = 0;
+                    continue;
+                }
+                const auto values = board.GetPossibleValues(row, col);
+                candidates[index] = values.GetFlag();
+                counts[index] = static_cast<typename SudokuMatrix<N>::DataType>(values.Count());
+            }
+        }
+        benchmark::DoNotOptimize(candidates.data());
+        benchmark::DoNotOptimize(counts.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * size * size));
+}
+
+template <std::size_t N>
+static void BM_AllCandidates(benchmark::State &state)
+{
+    constexpr std::size_t size = N * N;
+    pcg64 rng(1);
+    const SudokuMatrix<N> board = CreateBoard<N>(0.4f, rng);
+    std::vector<typename SudokuMatrix<N>::MaskType> candidates(size * size);
+    std::vector<typename SudokuMatrix<N>::DataType> counts(size * size);
+    for (auto _ : state)
+    {
+        board.ComputeAllCandidates(candidates, counts);
+        benchmark::DoNotOptimize(candidates.data());
+        benchmark::DoNotOptimize(counts.data());
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * size * size));
+}
+
+BENCHMARK(BM_CellCandidates<3>);
+BENCHMARK(BM_CellCandidates<4>);
+BENCHMARK(BM_CellCandidates<5>);
+BENCHMARK(BM_AllCandidates<3>);
+BENCHMARK(BM_AllCandidates<4>);
+BENCHMARK(BM_AllCandidates<5>);
+
 template <std::size_t N>
 static void BM_CreateDynamicBoard(benchmark::State &state)
 {
@@ -45,9 +328,46 @@ BENCHMARK(BM_CreateDynamicBoard<3>)->DenseRange(10, 90, 20);
 BENCHMARK(BM_CreateDynamicBoard<4>)->DenseRange(10, 90, 20);
 BENCHMARK(BM_CreateDynamicBoard<5>)->DenseRange(10, 90, 20);
 
+// Reports the search counters next to the timings, so a regression shows up
+// as a bigger search and not only as a slower one. Counters are averaged over
+// `solves` puzzles; maxDepth is the deepest of them.
+static void ReportSearchStats(benchmark::State &state, const SearchStats &stats, std::size_t solves = 1)
+{
+    if constexpr (SearchStatsEnabled)
+    {
+        const double count = static_cast<double>(solves);
+        state.counters["nodes"] = static_cast<double>(stats.nodes) / count;
+        state.counters["tried"] = static_cast<double>(stats.candidatesTried) / count;
+        state.counters["backtracks"] = static_cast<double>(stats.backtracks) / count;
+        state.counters["maxDepth"] = static_cast<double>(stats.maxDepth);
+        state.counters["eliminations"] = static_cast<double>(stats.eliminations) / count;
+        state.counters["covers"] = static_cast<double>(stats.coverOperations) / count;
+    }
+}
+
+// BandSolver runs AVX2 code; skip it where the CPU or SUDOKU_SIMD rules that
+// out, as the kernel benchmarks above do.
+template <std::size_t N, template <std::size_t> class Solver>
+static bool SkipUnsupportedSolver(benchmark::State &state)
+{
+    if constexpr (std::is_same_v<Solver<N>, BandSolver<N>>)
+    {
+        if (GetSimdLevel() < SimdLevel::Avx2)
+        {
+            state.SkipWithError("BandSolver needs AVX2, which is not available");
+            return true;
+        }
+    }
+    return false;
+}
+
 template <std::size_t N, template <std::size_t> class Solver, typename std::enable_if<std::is_base_of<ISolver<N>, Solver<N>>::value>::type * = nullptr>
 static void BM_SolverStatic(benchmark::State &state)
 {
+    if (SkipUnsupportedSolver<N, Solver>(state))
+    {
+        return;
+    }
     static_assert(N == 3, "This benchmark is only for 3x3 sudoku boards");
     static constexpr std::array<typename Solver<N>::DataType, 81> sudokuGame = {
         5, 3, 0, 0, 7, 0, 0, 0, 0,
@@ -62,26 +382,73 @@ static void BM_SolverStatic(benchmark::State &state)
         0, 0, 0, 4, 1, 9, 0, 0, 5,
         0, 0, 0, 0, 8, 0, 0, 7, 9};
     std::int64_t solves = 0;
+    SearchStats stats;
     for (auto _ : state)
     {
         Solver<N> solver{sudokuGame};
-        if constexpr (std::is_same_v<Solver<N>, DLXSolver<N>>)
-        {
-            while (solver.Advance(false))
-                ;
-        }
-        else
-        {
-            while (solver.Advance())
-                ;
-        }
+        benchmark::DoNotOptimize(solver.Solve());
+        stats = solver.GetStats();
         solves++;
     }
     state.SetItemsProcessed(solves);
+    ReportSearchStats(state, stats);
 }
 
 BENCHMARK(BM_SolverStatic<3, BackTrackingSolver>);
 BENCHMARK(BM_SolverStatic<3, DLXSolver>);
+BENCHMARK(BM_SolverStatic<3, PropagationSolver>);
+BENCHMARK(BM_SolverStatic<3, BandSolver>);
+
+// Same search driven one virtual Advance() at a time, as the visualizer does,
+// to compare against the bulk Solve() of BM_SolverRandom.
+template <std::size_t N, template <std::size_t> class Solver, typename std::enable_if<std::is_base_of<ISolver<N>, Solver<N>>::value>::type * = nullptr>
+static void BM_SolverStepwise(benchmark::State &state)
+{
+    pcg64 rng(1);
+    float probability = static_cast<float>(state.range(0)) / 100.0f;
+    SudokuMatrix<N> sudokuGame = CreateBoard<N>(probability, rng);
+    std::int64_t solves = 0;
+    for (auto _ : state)
+    {
+        Solver<N> solver{sudokuGame};
+        ISolver<N> *stepped = &solver;
+        benchmark::DoNotOptimize(stepped);
+        std::uint64_t steps = 0;
+        while (stepped->Advance() && ++steps < 10'000'000)
+            ;
+        benchmark::DoNotOptimize(steps);
+        solves++;
+    }
+    state.SetItemsProcessed(solves);
+}
+
+BENCHMARK(BM_SolverStepwise<4, BackTrackingSolver>)->Arg(50);
+BENCHMARK(BM_SolverStepwise<4, PropagationSolver>)->Arg(40);
+BENCHMARK(BM_SolverStepwise<4, DLXSolver>)->Arg(40);
+
+// Bulk Solve() with a deadline and a stop token that never fire, to measure
+// the cost of checking them against BM_SolverRandom.
+template <std::size_t N, template <std::size_t> class Solver, typename std::enable_if<std::is_base_of<ISolver<N>, Solver<N>>::value>::type * = nullptr>
+static void BM_SolverLimits(benchmark::State &state)
+{
+    pcg64 rng(1);
+    float probability = static_cast<float>(state.range(0)) / 100.0f;
+    SudokuMatrix<N> sudokuGame = CreateBoard<N>(probability, rng);
+    std::stop_source stopSource;
+    const SolveLimits limits{10'000'000, std::chrono::steady_clock::now() + std::chrono::hours(24), stopSource.get_token()};
+    std::int64_t solves = 0;
+    for (auto _ : state)
+    {
+        Solver<N> solver{sudokuGame};
+        benchmark::DoNotOptimize(solver.Solve(limits));
+        solves++;
+    }
+    state.SetItemsProcessed(solves);
+}
+
+BENCHMARK(BM_SolverLimits<4, BackTrackingSolver>)->Arg(50);
+BENCHMARK(BM_SolverLimits<4, PropagationSolver>)->Arg(40);
+BENCHMARK(BM_SolverLimits<4, DLXSolver>)->Arg(40);
 
 template <class Solver, typename std::enable_if<std::is_base_of<IDynamicSolver, Solver>::value>::type * = nullptr>
 static void BM_DynamicSolverStatic(benchmark::State &state)
@@ -100,14 +467,16 @@ static void BM_DynamicSolverStatic(benchmark::State &state)
         0, 0, 0, 0, 8, 0, 0, 7, 9};
     DynamicSudokuMatrix sudokuGameMatrix{std::move(sudokuGame), 3};
     std::int64_t index = 0;
+    SearchStats stats;
     for (auto _ : state)
     {
         Solver solver{sudokuGameMatrix};
-        while (solver.Advance())
-            ;
+        benchmark::DoNotOptimize(solver.Solve());
+        stats = solver.GetStats();
         index++;
     }
     state.SetItemsProcessed(index);
+    ReportSearchStats(state, stats);
 }
 
 BENCHMARK(BM_DynamicSolverStatic<DynamicBackTrackingSolver>);
@@ -115,39 +484,24 @@ BENCHMARK(BM_DynamicSolverStatic<DynamicBackTrackingSolver>);
 template <std::size_t N, template <std::size_t> class Solver, typename std::enable_if<std::is_base_of<ISolver<N>, Solver<N>>::value>::type * = nullptr>
 static void BM_SolverRandom(benchmark::State &state)
 {
+    if (SkipUnsupportedSolver<N, Solver>(state))
+    {
+        return;
+    }
     pcg64 rng(1);
     float probability = static_cast<float>(state.range(0)) / 100.0f;
     SudokuMatrix<N> sudokuGame = CreateBoard<N>(probability, rng);
     std::int64_t solves = 0;
+    SearchStats stats;
     for (auto _ : state)
     {
         Solver<N> solver{sudokuGame};
-        std::size_t innerIndex = 0;
-        if constexpr (std::is_same_v<Solver<N>, DLXSolver<N>>)
-        {
-            while (solver.Advance(false))
-            {
-                innerIndex++;
-                if (innerIndex == 10'000'000)
-                {
-                    break;
-                }
-            }
-        }
-        else
-        {
-            while (solver.Advance())
-            {
-                innerIndex++;
-                if (innerIndex == 10'000'000)
-                {
-                    break;
-                }
-            }
-        }
+        benchmark::DoNotOptimize(solver.Solve(10'000'000));
+        stats = solver.GetStats();
         solves++;
     }
     state.SetItemsProcessed(solves);
+    ReportSearchStats(state, stats);
 }
 
 BENCHMARK(BM_SolverRandom<3, DLXSolver>)->DenseRange(30, 70, 10);
@@ -156,6 +510,10 @@ BENCHMARK(BM_SolverRandom<5, DLXSolver>)->DenseRange(30, 70, 10);
 BENCHMARK(BM_SolverRandom<3, BackTrackingSolver>)->DenseRange(30, 50, 5);
 BENCHMARK(BM_SolverRandom<4, BackTrackingSolver>)->DenseRange(30, 50, 5);
 BENCHMARK(BM_SolverRandom<5, BackTrackingSolver>)->DenseRange(30, 50, 5);
+BENCHMARK(BM_SolverRandom<3, PropagationSolver>)->DenseRange(30, 70, 10);
+BENCHMARK(BM_SolverRandom<4, PropagationSolver>)->DenseRange(30, 70, 10);
+BENCHMARK(BM_SolverRandom<5, PropagationSolver>)->DenseRange(30, 70, 10);
+BENCHMARK(BM_SolverRandom<3, BandSolver>)->DenseRange(30, 70, 10);
 
 template <std::size_t N, class Solver, typename std::enable_if<std::is_base_of<IDynamicSolver, Solver>::value>::type * = nullptr>
 static void BM_DynamicSolverRandom(benchmark::State &state)
@@ -164,25 +522,292 @@ static void BM_DynamicSolverRandom(benchmark::State &state)
     float probability = static_cast<float>(state.range(0)) / 100.0f;
     DynamicSudokuMatrix sudokuGame = CreateBoard(N, probability, rng);
     std::int64_t index = 0;
+    SearchStats stats;
     for (auto _ : state)
     {
         Solver solver{sudokuGame};
-        std::size_t innerIndex = 0;
-        while (solver.Advance())
-        {
-            innerIndex++;
-            if (innerIndex == 10'000'000)
-            {
-                break;
-            }
-        }
+        benchmark::DoNotOptimize(solver.Solve(10'000'000));
+        stats = solver.GetStats();
         index++;
     }
     state.SetItemsProcessed(index);
+    ReportSearchStats(state, stats);
 }
 
 BENCHMARK(BM_DynamicSolverRandom<3, DynamicBackTrackingSolver>)->DenseRange(30, 50, 5);
 BENCHMARK(BM_DynamicSolverRandom<4, DynamicBackTrackingSolver>)->DenseRange(30, 50, 5);
 BENCHMARK(BM_DynamicSolverRandom<5, DynamicBackTrackingSolver>)->DenseRange(30, 50, 5);
 
-BENCHMARK_MAIN();
\ No newline at end of file
+template <std::size_t N>
+static std::vector<SudokuMatrix<N>> CreateSolvablePuzzles(std::size_t count, float probability, pcg64 &rng)
+{
+    std::vector<SudokuMatrix<N>> puzzles;
+    puzzles.reserve(count);
+    while (puzzles.size() < count)
+    {
+        SudokuMatrix<N> puzzle = CreateBoard<N>(probability, rng);
+        DLXSolver<N> solver{puzzle};
+        if (solver.Solve(20'000).status == SolveStatus::Solved)
+        {
+            puzzles.push_back(std::move(puzzle));
+        }
+    }
+    return puzzles;
+}
+
+template <std::size_t N, template <std::size_t> class Solver, typename std::enable_if<std::is_base_of<ISolver<N>, Solver<N>>::value>::type * = nullptr>
+static void BM_SolveBatch(benchmark::State &state)
+{
+    if (SkipUnsupportedSolver<N, Solver>(state))
+    {
+        return;
+    }
+    pcg64 rng(1);
+    const std::vector<SudokuMatrix<N>> puzzles = CreateSolvablePuzzles<N>(1024, 0.4f, rng);
+    std::vector<SudokuMatrix<N>> solutions(puzzles.size());
+    std::vector<SolveStatus> statuses(puzzles.size());
+    WorkStealingPool pool(static_cast<std::size_t>(state.range(0)));
+    std::int64_t solves = 0;
+    for (auto _ : state)
+    {
+        SolveBatch<N, Solver>(pool, std::span<const SudokuMatrix<N>>(puzzles), std::span<SudokuMatrix<N>>(solutions), std::span<SolveStatus>(statuses));
+        benchmark::DoNotOptimize(statuses.data());
+        solves += static_cast<std::int64_t>(puzzles.size());
+    }
+    state.SetItemsProcessed(solves);
+}
+
+// Latency of single sparse puzzles, each split across the whole pool.
+template <std::size_t N, template <std::size_t> class Solver, typename std::enable_if<std::is_base_of<ISolver<N>, Solver<N>>::value>::type * = nullptr>
+static void BM_SolveParallel(benchmark::State &state)
+{
+    pcg64 rng(1);
+    const std::vector<SudokuMatrix<N>> puzzles = CreateSolvablePuzzles<N>(16, 0.3f, rng);
+    WorkStealingPool pool(static_cast<std::size_t>(state.range(0)));
+    SudokuMatrix<N> solution;
+    std::int64_t solves = 0;
+    for (auto _ : state)
+    {
+        for (const SudokuMatrix<N> &puzzle : puzzles)
+        {
+            benchmark::DoNotOptimize(SolveParallel<N, Solver>(pool, puzzle, solution));
+        }
+        solves += static_cast<std::int64_t>(puzzles.size());
+    }
+    state.SetItemsProcessed(solves);
+}
+
+// One solver object reused for a stream of puzzles through Reset().
+template <std::size_t N, template <std::size_t> class Solver, typename std::enable_if<std::is_base_of<ISolver<N>, Solver<N>>::value>::type * = nullptr>
+static void BM_SolverReuse(benchmark::State &state)
+{
+    if (SkipUnsupportedSolver<N, Solver>(state))
+    {
+        return;
+    }
+    pcg64 rng(1);
+    const std::vector<SudokuMatrix<N>> puzzles = CreateSolvablePuzzles<N>(256, 0.4f, rng);
+    Solver<N> solver{puzzles.front()};
+    std::int64_t solves = 0;
+    SearchStats stats;
+    for (auto _ : state)
+    {
+        stats = {};
+        for (const SudokuMatrix<N> &puzzle : puzzles)
+        {
+            solver.Reset(puzzle);
+            benchmark::DoNotOptimize(solver.Solve(10'000'000));
+            stats.Merge(solver.GetStats());
+        }
+        solves += static_cast<std::int64_t>(puzzles.size());
+    }
+    state.SetItemsProcessed(solves);
+    ReportSearchStats(state, stats, puzzles.size());
+}
+
+BENCHMARK(BM_SolverReuse<3, DLXSolver>);
+BENCHMARK(BM_SolverReuse<4, DLXSolver>);
+BENCHMARK(BM_SolverReuse<3, PropagationSolver>);
+BENCHMARK(BM_SolverReuse<3, BandSolver>);
+
+// Uniqueness check (limit = 2) on the same puzzles, as done when generating.
+template <std::size_t N, template <std::size_t> class Solver>
+static void BM_CountSolutions(benchmark::State &state)
+{
+    pcg64 rng(1);
+    const std::vector<SudokuMatrix<N>> puzzles = CreateSolvablePuzzles<N>(256, 0.4f, rng);
+    std::int64_t checks = 0;
+    for (auto _ : state)
+    {
+        for (const SudokuMatrix<N> &puzzle : puzzles)
+        {
+            Solver<N> solver{puzzle};
+            benchmark::DoNotOptimize(solver.CountSolutions(2));
+        }
+        checks += static_cast<std::int64_t>(puzzles.size());
+    }
+    state.SetItemsProcessed(checks);
+}
+
+BENCHMARK(BM_CountSolutions<3, DLXSolver>);
+BENCHMARK(BM_CountSolutions<3, BackTrackingSolver>);
+
+static const int MaxBenchmarkThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+BENCHMARK(BM_SolveBatch<3, DLXSolver>)->DenseRange(1, MaxBenchmarkThreads)->UseRealTime();
+BENCHMARK(BM_SolveBatch<3, BackTrackingSolver>)->DenseRange(1, MaxBenchmarkThreads)->UseRealTime();
+BENCHMARK(BM_SolveBatch<3, PropagationSolver>)->DenseRange(1, MaxBenchmarkThreads)->UseRealTime();
+BENCHMARK(BM_SolveBatch<3, BandSolver>)->DenseRange(1, MaxBenchmarkThreads)->UseRealTime();
+
+BENCHMARK(BM_SolveParallel<4, DLXSolver>)->DenseRange(1, MaxBenchmarkThreads)->UseRealTime();
+BENCHMARK(BM_SolveParallel<5, DLXSolver>)->DenseRange(1, MaxBenchmarkThreads)->UseRealTime();
+BENCHMARK(BM_SolveParallel<3, BackTrackingSolver>)->DenseRange(1, MaxBenchmarkThreads)->UseRealTime();
+
+static void BM_GeneratePuzzles(benchmark::State &state)
+{
+    WorkStealingPool pool(static_cast<std::size_t>(state.range(0)));
+    std::uint64_t seed = 1;
+    std::int64_t puzzles = 0;
+    for (auto _ : state)
+    {
+        const std::vector<SudokuMatrix<3>> batch = GeneratePuzzles<3>(pool, 1024, seed++);
+        benchmark::DoNotOptimize(batch.data());
+        puzzles += static_cast<std::int64_t>(batch.size());
+    }
+    state.SetItemsProcessed(puzzles);
+}
+
+BENCHMARK(BM_GeneratePuzzles)->DenseRange(1, MaxBenchmarkThreads)->UseRealTime();
+
+// Every solver over a whole puzzle file, timing each puzzle on its own into
+// a latency histogram, since the mean hides the heavy tail of the search.
+// Puzzles still open after the step budget count as unsolved.
+template <template <std::size_t> class Solver>
+static void BM_Corpus(benchmark::State &state, const std::vector<SudokuMatrix<3>> &puzzles)
+{
+    using Clock = std::chrono::steady_clock;
+    std::int64_t solves = 0;
+    std::int64_t unsolved = 0;
+    LatencyHistogram latencies;
+    SearchStats stats;
+    for (auto _ : state)
+    {
+        unsolved = 0;
+        stats = {};
+        for (const SudokuMatrix<3> &puzzle : puzzles)
+        {
+            const Clock::time_point start = Clock::now();
+            Solver<3> solver{puzzle};
+            const SolveResult result = solver.Solve(10'000'000);
+            latencies.Record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()));
+            unsolved += result.status != SolveStatus::Solved;
+            stats.Merge(solver.GetStats());
+        }
+        solves += static_cast<std::int64_t>(puzzles.size());
+    }
+    state.SetItemsProcessed(solves);
+    const auto micros = [](double nanoseconds)
+    {
+        return nanoseconds / 1000.0;
+    };
+    state.counters["mean_us"] = micros(latencies.GetMean());
+    state.counters["p50_us"] = micros(static_cast<double>(latencies.ValueAtPercentile(50.0)));
+    state.counters["p90_us"] = micros(static_cast<double>(latencies.ValueAtPercentile(90.0)));
+    state.counters["p99_us"] = micros(static_cast<double>(latencies.ValueAtPercentile(99.0)));
+    state.counters["p999_us"] = micros(static_cast<double>(latencies.ValueAtPercentile(99.9)));
+    state.counters["max_us"] = micros(static_cast<double>(latencies.GetMax()));
+    state.counters["unsolved"] = static_cast<double>(unsolved);
+    ReportSearchStats(state, stats, puzzles.size());
+}
+
+static std::string_view DifficultyBucket(const SudokuMatrix<3> &puzzle)
+{
+    const std::optional<PuzzleDifficulty> difficulty = RateDifficulty<3>(puzzle);
+    return difficulty.has_value() ? DifficultyName(*difficulty) : "unsolved";
+}
+
+// Registers BM_Corpus for every solver over the whole set and over each of
+// its difficulty buckets.
+static void RegisterCorpus(const std::string &name, std::vector<SudokuMatrix<3>> puzzles)
+{
+    std::vector<std::pair<std::string, std::shared_ptr<const std::vector<SudokuMatrix<3>>>>> sets;
+    std::map<std::string_view, std::vector<SudokuMatrix<3>>> buckets;
+    for (const SudokuMatrix<3> &puzzle : puzzles)
+    {
+        buckets[DifficultyBucket(puzzle)].push_back(puzzle);
+    }
+    sets.emplace_back(name, std::make_shared<const std::vector<SudokuMatrix<3>>>(std::move(puzzles)));
+    for (auto &[bucket, bucketPuzzles] : buckets)
+    {
+        sets.emplace_back(name + "/" + std::string(bucket), std::make_shared<const std::vector<SudokuMatrix<3>>>(std::move(bucketPuzzles)));
+    }
+    for (const auto &[setName, set] : sets)
+    {
+        const auto add = [&]<template <std::size_t> class Solver>(std::string_view solverName)
+        {
+            benchmark::RegisterBenchmark(("BM_Corpus<" + std::string(solverName) + ">/" + setName).c_str(), [set](benchmark::State &state)
+                                         { BM_Corpus<Solver>(state, *set); });
+        };
+        add.template operator()<BackTrackingSolver>("BackTrackingSolver");
+        add.template operator()<DLXSolver>("DLXSolver");
+        add.template operator()<PropagationSolver>("PropagationSolver");
+        if (GetSimdLevel() >= SimdLevel::Avx2)
+        {
+            add.template operator()<BandSolver>("BandSolver");
+        }
+    }
+}
+
+static bool RegisterCorpusFile(std::string_view path)
+{
+    if (path == "random")
+    {
+        pcg64 rng(1);
+        RegisterCorpus("random", CreateSolvablePuzzles<3>(1024, 0.3f, rng));
+        return true;
+    }
+    const std::filesystem::path file(path);
+    auto loaded = file.extension() == ".sdkp" ? LoadPuzzleArchive<3>(file) : LoadPuzzleFile<3>(file);
+    if (!loaded.has_value() || loaded->empty())
+    {
+        std::cerr << "Could not read a 9x9 puzzle corpus from " << path << '\n';
+        return false;
+    }
+    RegisterCorpus(file.stem().string(), std::move(*loaded));
+    return true;
+}
+
+// Takes --corpus=<file> any number of times on top of the Google Benchmark
+// flags, e.g. --corpus=puzzles/hardest.txt --benchmark_filter=BM_Corpus.
+// Files ending in .sdkp are read as packed archives.
+// --corpus=random stands for 1024 random solvable puzzles. Add
+// --benchmark_out=<file> --benchmark_out_format=json to keep the percentiles
+// for comparison across commits.
+int main(int argc, char **argv)
+{
+    std::vector<char *> arguments;
+    for (int i = 0; i < argc; ++i)
+    {
+        const std::string_view argument = argv[i];
+        constexpr std::string_view corpusFlag = "--corpus=";
+        if (i != 0 && argument.starts_with(corpusFlag))
+        {
+            if (!RegisterCorpusFile(argument.substr(corpusFlag.size())))
+            {
+                return 1;
+            }
+            continue;
+        }
+        arguments.push_back(argv[i]);
+    }
+    int count = static_cast<int>(arguments.size());
+    arguments.push_back(nullptr);
+    benchmark::Initialize(&count, arguments.data());
+    if (benchmark::ReportUnrecognizedArguments(count, arguments.data()))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "../include/BatchSolver.hpp"
+#include "../include/CommandLine.hpp"
+#include "../include/LatencyHistogram.hpp"
+#include "../include/PuzzleArchive.hpp"
+#include "../include/PuzzleIO.hpp"
+#include "../include/WorkStealingPool.hpp"
+#include "../include/solvers/AnySolver.hpp"
+
+struct CliOptions
+{
+    SolverKind solver = SolverKind::BackTracking;
+    std::size_t size = 3;
+    std::size_t threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    std::uint64_t maxSteps = 10'000'000;
+    // "-" reads the puzzles from stdin and writes the solutions to stdout.
+    std::string input = "-";
+    std::optional<std::string> output;
+};
+
+static void PrintUsage(std::ostream &output, std::string_view program)
+{
+    output << "Usage: " << program << " [options] [puzzles]\n"
+           << "Solves every puzzle of a text or .sdkp file, or of stdin with '-' (the default),\n"
+           << "and prints throughput and latency to stderr.\n"
+           << "  --solver=<name>   backtrack (default), dlx, propagation or band (9x9 with AVX2)\n"
+           << "  --size=<n>        box size, 3 for 9x9 (default) up to " << MaxTextBoardSize << '\n'
+           << "  --threads=<n>     solver threads (default: one per hardware thread)\n"
+           << "  --max-steps=<n>   step budget of each puzzle (default 10000000)\n"
+           << "  --output=<file>   writes the solutions, '-' for stdout; a puzzle without one is\n"
+           << "                    written as given, followed by its status. A .sdkp file gets\n"
+           << "                    an archive of the puzzles, with their solutions if all solved\n"
+           << "Exits with 2 if any puzzle was left unsolved.\n";
+}
+
+// std::nullopt after printing what was wrong with the arguments.
+static std::optional<CliOptions> ParseArguments(int argc, char **argv)
+{
+    CliOptions options;
+    bool hasInput = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view argument = argv[i];
+        const auto [name, value] = SplitOption(argument);
+        if (name == "--solver")
+        {
+            const std::optional<SolverKind> solver = ParseSolverKind(value);
+            if (!solver.has_value())
+            {
+                std::cerr << "Valid solvers are 'backtrack', 'dlx', 'propagation' and 'band'\n";
+                return std::nullopt;
+            }
+            options.solver = *solver;
+        }
+        else if (name == "--size")
+        {
+            const std::optional<std::size_t> size = ParseNumber<std::size_t>(value);
+            if (!size.has_value() || *size < MinStaticBoardSize || *size > MaxTextBoardSize)
+            {
+                std::cerr << "The box size must be between " << MinStaticBoardSize << " and " << MaxTextBoardSize << '\n';
+                return std::nullopt;
+            }
+            options.size = *size;
+        }
+        else if (name == "--threads")
+        {
+            const std::optional<std::size_t> threads = ParseNumber<std::size_t>(value);
+            if (!threads.has_value() || *threads == 0)
+            {
+                std::cerr << "--threads takes a positive count\n";
+                return std::nullopt;
+            }
+            options.threads = *threads;
+        }
+        else if (name == "--max-steps")
+        {
+            const std::optional<std::uint64_t> maxSteps = ParseNumber<std::uint64_t>(value);
+            if (!maxSteps.has_value() || *maxSteps == 0)
+            {
+                std::cerr << "--max-steps takes a positive count\n";
+                return std::nullopt;
+            }
+            options.maxSteps = *maxSteps;
+        }
+        else if (name == "--output" && !value.empty())
+        {
+            options.output = std::string(value);
+        }
+        else if ((argument == "-" || !argument.starts_with('-')) && !hasInput)
+        {
+            options.input = std::string(argument);
+            hasInput = true;
+        }
+        else
+        {
+            std::cerr << "Unknown argument " << argument << '\n';
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+static bool IsArchivePath(std::string_view path)
+{
+    return std::filesystem::path(path).extension() == ".sdkp";
+}
+
+template <std::size_t N>
+static std::optional<std::vector<SudokuMatrix<N>>> ReadPuzzles(const std::string &input)
+{
+    if (input == "-")
+    {
+        std::ios::sync_with_stdio(false);
+        return LoadPuzzles<N>(std::cin);
+    }
+    if (IsArchivePath(input))
+    {
+        return LoadPuzzleArchive<N>(input);
+    }
+    return LoadPuzzleFile<N>(input);
+}
+
+static std::string_view StatusName(SolveStatus status)
+{
+    switch (status)
+    {
+    case SolveStatus::Solved:
+        return "solved";
+    case SolveStatus::Unsolvable:
+        return "unsolvable";
+    case SolveStatus::BudgetExhausted:
+        return "over-budget";
+    case SolveStatus::Cancelled:
+        return "cancelled";
+    case SolveStatus::DeadlineExceeded:
+        return "late";
+    }
+    return "unknown";
+}
+
+// Only solved puzzles get their final board written; the others keep one
+// line each, so line i still answers puzzle i.
+template <std::size_t N>
+static bool WriteSolutions(const std::string &output, const std::vector<SudokuMatrix<N>> &puzzles, const std::vector<SudokuMatrix<N>> &solutions, std::span<const SolveStatus> statuses)
+{
+    if (IsArchivePath(output))
+    {
+        const bool allSolved = std::ranges::all_of(statuses, [](SolveStatus status)
+                                                   { return status == SolveStatus::Solved; });
+        return SavePuzzleArchive<N>(output, puzzles, allSolved ? std::span<const SudokuMatrix<N>>(solutions) : std::span<const SudokuMatrix<N>>{});
+    }
+    std::ofstream file;
+    if (output != "-")
+    {
+        file.open(output, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+    }
+    std::ostream &stream = output == "-" ? std::cout : file;
+    {
+        PuzzleWriter<N> writer(stream);
+        for (std::size_t i = 0; i < puzzles.size(); ++i)
+        {
+            if (statuses[i] == SolveStatus::Solved)
+            {
+                writer.Write(solutions[i]);
+            }
+            else
+            {
+                writer.Write(puzzles[i], StatusName(statuses[i]));
+            }
+        }
+    }
+    stream.flush();
+    return static_cast<bool>(stream);
+}
+
+static void PrintSummary(std::span<const SolveStatus> statuses, std::span<const std::uint64_t> latencies, std::chrono::nanoseconds wall, std::size_t threads)
+{
+    std::array<std::size_t, 5> counts{};
+    LatencyHistogram histogram;
+    for (std::size_t i = 0; i < statuses.size(); ++i)
+    {
+        counts[static_cast<std::size_t>(statuses[i])]++;
+        histogram.Record(latencies[i]);
+    }
+    const double seconds = std::chrono::duration<double>(wall).count();
+    const auto micros = [](double nanoseconds)
+    {
+        return nanoseconds / 1000.0;
+    };
+    std::cerr << std::fixed << std::setprecision(1)
+              << "puzzles      " << statuses.size() << " on " << threads << " threads\n"
+              << "solved       " << counts[static_cast<std::size_t>(SolveStatus::Solved)] << '\n'
+              << "unsolvable   " << counts[static_cast<std::size_t>(SolveStatus::Unsolvable)] << '\n'
+              << "over budget  " << counts[static_cast<std::size_t>(SolveStatus::BudgetExhausted)] << '\n'
+              << "wall time    " << seconds * 1000.0 << " ms\n"
+              << "throughput   " << (seconds > 0 ? static_cast<double>(statuses.size()) / seconds : 0.0) << " puzzles/s\n"
+              << std::setprecision(2)
+              << "latency (us) mean " << micros(histogram.GetMean())
+              << "  p50 " << micros(static_cast<double>(histogram.ValueAtPercentile(50.0)))
+              << "  p90 " << micros(static_cast<double>(histogram.ValueAtPercentile(90.0)))
+              << "  p99 " << micros(static_cast<double>(histogram.ValueAtPercentile(99.0)))
+              << "  p99.9 " << micros(static_cast<double>(histogram.ValueAtPercentile(99.9)))
+              << "  max " << micros(static_cast<double>(histogram.GetMax())) << '\n';
+}
+
+template <std::size_t N>
+static int Run(const CliOptions &options)
+{
+    const std::optional<std::vector<SudokuMatrix<N>>> puzzles = ReadPuzzles<N>(options.input);
+    if (!puzzles.has_value())
+    {
+        std::cerr << "Could not read " << N * N << 'x' << N * N << " puzzles from " << options.input << '\n';
+        return 1;
+    }
+    std::vector<SudokuMatrix<N>> solutions(puzzles->size());
+    std::vector<SolveStatus> statuses(puzzles->size());
+    std::vector<std::uint64_t> latencies(puzzles->size());
+    WorkStealingPool pool(options.threads);
+    BatchOptions batch;
+    batch.maxSteps = options.maxSteps;
+    batch.latencies = latencies;
+    const auto start = std::chrono::steady_clock::now();
+    const bool supported = VisitSolverKind<N>(options.solver, [&]<template <std::size_t> class Solver>()
+                                              { SolveBatch<N, Solver>(pool, std::span<const SudokuMatrix<N>>(*puzzles), std::span<SudokuMatrix<N>>(solutions), std::span<SolveStatus>(statuses), batch); });
+    const auto wall = std::chrono::steady_clock::now() - start;
+    if (!supported)
+    {
+        std::cerr << "That solver does not run " << N * N << 'x' << N * N << " boards on this CPU\n";
+        return 1;
+    }
+    if (options.output.has_value() && !WriteSolutions<N>(*options.output, *puzzles, solutions, statuses))
+    {
+        std::cerr << "Could not write " << *options.output << '\n';
+        return 1;
+    }
+    PrintSummary(statuses, latencies, std::chrono::duration_cast<std::chrono::nanoseconds>(wall), pool.Size());
+    const std::size_t unsolved = puzzles->size() - static_cast<std::size_t>(std::ranges::count(statuses, SolveStatus::Solved));
+    if (unsolved != 0)
+    {
+        std::cerr << unsolved << " of " << puzzles->size() << " puzzles were not solved";
+        if (options.output.has_value() && IsArchivePath(*options.output))
+        {
+            std::cerr << "; " << *options.output << " holds the puzzles without solutions";
+        }
+        std::cerr << '\n';
+        return 2;
+    }
+    return 0;
+}
+
+// Headless batch solver: no window, no SFML, e.g.
+//   SudokuSolver_CLI --solver=dlx --threads=8 --output=solved.txt puzzles/hardest.txt
+int main(int argc, char **argv)
+{
+    if (HasArgument(argc, argv, "--help"))
+    {
+        PrintUsage(std::cout, argv[0]);
+        return 0;
+    }
+    const std::optional<CliOptions> options = ParseArguments(argc, argv);
+    if (!options.has_value())
+    {
+        PrintUsage(std::cerr, argv[0]);
+        return 1;
+    }
+    return VisitBoardSize(
+        options->size,
+        [&]<std::size_t N>(std::integral_constant<std::size_t, N>)
+        {
+            if constexpr (N <= MaxTextBoardSize)
+            {
+                return Run<N>(*options);
+            }
+            else
+            {
+                return 1;
+            }
+        },
+        []()
+        { return 1; });
+}
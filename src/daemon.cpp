@@ -0,0 +1,139 @@
+#include <csignal>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <pthread.h>
+#include "../include/CommandLine.hpp"
+#include "../include/SolveService.hpp"
+
+// A server runs on the static solvers of one box size, all of which the
+// protocol can frame.
+static_assert(SolveProtocol::PackedBoardSize(MaxStaticBoardSize) != 0);
+
+struct DaemonOptions
+{
+    ServiceEndpoint endpoint{"/tmp/sudoku-solver.sock", 0};
+    std::size_t size = 3;
+    SolveServerOptions server;
+};
+
+static void PrintUsage(std::ostream &output, std::string_view program)
+{
+    output << "Usage: " << program << " [options]\n"
+           << "Solves puzzles sent over a local socket until SIGINT or SIGTERM.\n"
+           << "  --listen=<endpoint>      Unix socket path or tcp:<port> (default /tmp/sudoku-solver.sock)\n"
+           << "  --size=<n>               box size of the puzzles, 3 for 9x9 (default) up to " << MaxStaticBoardSize << '\n'
+           << "  --threads=<n>            solver threads (default: one per hardware thread)\n"
+           << "  --max-batch=<n>          requests per micro-batch (default 256)\n"
+           << "  --batch-window-us=<n>    how long a batch waits to fill up (default 50)\n"
+           << "  --max-steps=<n>          step budget of each puzzle (default 10000000)\n"
+           << "  --max-in-flight=<n>      unanswered requests per connection before the server\n"
+           << "                           stops reading from it (default 1024)\n";
+}
+
+static std::optional<DaemonOptions> ParseArguments(int argc, char **argv)
+{
+    DaemonOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view argument = argv[i];
+        const auto [name, value] = SplitOption(argument);
+        const std::optional<std::uint64_t> number = ParseNumber<std::uint64_t>(value);
+        if (name == "--listen")
+        {
+            const std::optional<ServiceEndpoint> endpoint = ParseEndpoint(value);
+            if (!endpoint.has_value())
+            {
+                std::cerr << "--listen takes a socket path or tcp:<port>\n";
+                return std::nullopt;
+            }
+            options.endpoint = *endpoint;
+        }
+        else if (name == "--size" && number.has_value() && *number >= MinStaticBoardSize && *number <= MaxStaticBoardSize)
+        {
+            options.size = static_cast<std::size_t>(*number);
+        }
+        else if (name == "--threads" && number.has_value() && *number != 0)
+        {
+            options.server.threads = static_cast<std::size_t>(*number);
+        }
+        else if (name == "--max-batch" && number.has_value() && *number != 0)
+        {
+            options.server.maxBatch = static_cast<std::size_t>(*number);
+        }
+        else if (name == "--batch-window-us" && number.has_value())
+        {
+            options.server.batchWindow = std::chrono::microseconds(*number);
+        }
+        else if (name == "--max-steps" && number.has_value() && *number != 0)
+        {
+            options.server.maxSteps = *number;
+        }
+        else if (name == "--max-in-flight" && number.has_value() && *number != 0)
+        {
+            options.server.maxInFlight = static_cast<std::size_t>(*number);
+        }
+        else
+        {
+            std::cerr << "Bad argument " << argument << '\n';
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+template <std::size_t N>
+static int Serve(const DaemonOptions &options, const sigset_t &signals)
+{
+    const std::unique_ptr<SolveServer<N>> server = SolveServer<N>::Start(options.endpoint, options.server);
+    if (server == nullptr)
+    {
+        std::cerr << "Could not listen on " << FormatEndpoint(options.endpoint) << '\n';
+        return 1;
+    }
+    std::cerr << "Serving " << N * N << 'x' << N * N << " puzzles on " << FormatEndpoint(server->GetEndpoint()) << '\n';
+    int signal = 0;
+    sigwait(&signals, &signal);
+    server->Stop();
+    const std::uint64_t batches = server->GetBatchCount();
+    std::cerr << "Served " << server->GetRequestCount() << " requests in " << batches << " batches";
+    if (batches != 0)
+    {
+        std::cerr << " (" << static_cast<double>(server->GetRequestCount()) / static_cast<double>(batches) << " per batch)";
+    }
+    std::cerr << '\n';
+    return 0;
+}
+
+// Pairs with SudokuSolver_LOADGEN, e.g.
+//   SudokuSolver_DAEMON --listen=/tmp/sudoku.sock --threads=8 &
+//   SudokuSolver_LOADGEN --connect=/tmp/sudoku.sock --connections=16 puzzles/hardest.txt
+int main(int argc, char **argv)
+{
+    if (HasArgument(argc, argv, "--help"))
+    {
+        PrintUsage(std::cout, argv[0]);
+        return 0;
+    }
+    const std::optional<DaemonOptions> options = ParseArguments(argc, argv);
+    if (!options.has_value())
+    {
+        PrintUsage(std::cerr, argv[0]);
+        return 1;
+    }
+    // Blocked before any thread starts, so every thread inherits the mask
+    // and only sigwait sees the signals.
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+    return VisitBoardSize(
+        options->size,
+        [&]<std::size_t N>(std::integral_constant<std::size_t, N>)
+        { return Serve<N>(*options, signals); },
+        []()
+        { return 1; });
+}
@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <pcg_random.hpp>
+#include "../include/CommandLine.hpp"
+#include "../include/LatencyHistogram.hpp"
+#include "../include/PuzzleArchive.hpp"
+#include "../include/PuzzleGenerator.hpp"
+#include "../include/PuzzleIO.hpp"
+#include "../include/SolveService.hpp"
+#include "../include/SudokuUtilities.hpp"
+
+struct LoadOptions
+{
+    ServiceEndpoint endpoint{"/tmp/sudoku-solver.sock", 0};
+    std::size_t size = 3;
+    std::size_t connections = 4;
+    // Requests each connection keeps in flight.
+    std::size_t depth = 32;
+    std::size_t requests = 100'000;
+    SolverKind solver = SolverKind::Dlx;
+    std::uint32_t deadlineMicros = 0;
+    // Puzzle file; without one the puzzles are generated.
+    std::optional<std::string> input;
+};
+
+// Per connection, merged at the end.
+struct LoadResult
+{
+    LatencyHistogram latencies;
+    // Indexed by SolveStatus, with rejections last.
+    std::array<std::uint64_t, 6> statuses{};
+    std::uint64_t wrong = 0;
+    bool failed = false;
+};
+
+static void PrintUsage(std::ostream &output, std::string_view program)
+{
+    output << "Usage: " << program << " [options] [puzzles]\n"
+           << "Sends puzzles from a text or .sdkp file, or 1024 generated ones, to a running\n"
+           << "SudokuSolver_DAEMON, checks the answers and prints throughput and latency.\n"
+           << "  --connect=<endpoint>  Unix socket path or tcp:<port> (default /tmp/sudoku-solver.sock)\n"
+           << "  --size=<n>            box size, 3 for 9x9 (default) up to " << MaxTextBoardSize << '\n'
+           << "  --connections=<n>     client connections, one thread each (default 4)\n"
+           << "  --depth=<n>           requests in flight per connection (default 32)\n"
+           << "  --requests=<n>        requests in total, cycling through the puzzles (default 100000)\n"
+           << "  --solver=<name>       backtrack, dlx (default), propagation or band\n"
+           << "  --deadline-us=<n>     deadline of every request, 0 for none (default)\n";
+}
+
+static std::optional<LoadOptions> ParseArguments(int argc, char **argv)
+{
+    LoadOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view argument = argv[i];
+        const auto [name, value] = SplitOption(argument);
+        const std::optional<std::uint64_t> number = ParseNumber<std::uint64_t>(value);
+        if (name == "--connect")
+        {
+            const std::optional<ServiceEndpoint> endpoint = ParseEndpoint(value);
+            if (!endpoint.has_value())
+            {
+                std::cerr << "--connect takes a socket path or tcp:<port>\n";
+                return std::nullopt;
+            }
+            options.endpoint = *endpoint;
+        }
+        else if (name == "--solver")
+        {
+            const std::optional<SolverKind> solver = ParseSolverKind(value);
+            if (!solver.has_value())
+            {
+                std::cerr << "Valid solvers are 'backtrack', 'dlx', 'propagation' and 'band'\n";
+                return std::nullopt;
+            }
+            options.solver = *solver;
+        }
+        else if (name == "--size" && number.has_value() && *number >= MinStaticBoardSize && *number <= MaxTextBoardSize)
+        {
+            options.size = static_cast<std::size_t>(*number);
+        }
+        else if (name == "--connections" && number.has_value() && *number != 0)
+        {
+            options.connections = static_cast<std::size_t>(*number);
+        }
+        else if (name == "--depth" && number.has_value() && *number != 0)
+        {
+            options.depth = static_cast<std::size_t>(*number);
+        }
+        else if (name == "--requests" && number.has_value() && *number != 0)
+        {
+            options.requests = static_cast<std::size_t>(*number);
+        }
+        else if (name == "--deadline-us" && number.has_value() && *number <= std::numeric_limits<std::uint32_t>::max())
+        {
+            options.deadlineMicros = static_cast<std::uint32_t>(*number);
+        }
+        else if (!argument.starts_with('-') && !options.input.has_value())
+        {
+            options.input = std::string(argument);
+        }
+        else
+        {
+            std::cerr << "Bad argument " << argument << '\n';
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+template <std::size_t N>
+static std::optional<std::vector<SudokuMatrix<N>>> ReadPuzzles(const LoadOptions &options)
+{
+    if (!options.input.has_value())
+    {
+        WorkStealingPool pool;
+        return GeneratePuzzles<N>(pool, 1024, 1);
+    }
+    if (std::filesystem::path(*options.input).extension() == ".sdkp")
+    {
+        return LoadPuzzleArchive<N>(*options.input);
+    }
+    return LoadPuzzleFile<N>(*options.input);
+}
+
+template <std::size_t N>
+static bool IsSolutionOf(const SudokuMatrix<N> &puzzle, const SudokuMatrix<N> &solution)
+{
+    for (std::size_t cell = 0; cell < N * N * N * N; ++cell)
+    {
+        if (solution.GetValue(cell) == 0 || (puzzle.GetValue(cell) != 0 && puzzle.GetValue(cell) != solution.GetValue(cell)))
+        {
+            return false;
+        }
+    }
+    return IsValidSudoku(solution);
+}
+
+// Sends requests [first, first + count) on one connection, keeping
+// options.depth of them in flight. Request i carries puzzle i modulo the
+// puzzle count, and its id is its offset on the connection.
+template <std::size_t N>
+static LoadResult RunConnection(const LoadOptions &options, const std::vector<SudokuMatrix<N>> &puzzles, std::size_t first, std::size_t count)
+{
+    using Clock = std::chrono::steady_clock;
+    LoadResult result;
+    std::optional<SolveClient<N>> client = SolveClient<N>::Connect(options.endpoint);
+    if (!client.has_value())
+    {
+        result.failed = true;
+        return result;
+    }
+    std::vector<Clock::time_point> sentAt(count);
+    std::size_t sent = 0;
+    const auto send = [&]()
+    {
+        sentAt[sent] = Clock::now();
+        client->Send({static_cast<std::uint32_t>(sent), options.solver, options.deadlineMicros, puzzles[(first + sent) % puzzles.size()]});
+        sent++;
+    };
+    while (sent < std::min(options.depth, count))
+    {
+        send();
+    }
+    for (std::size_t received = 0; received < count; ++received)
+    {
+        const std::optional<SolveResponse<N>> response = client->Receive();
+        if (!response.has_value() || response->id >= sent)
+        {
+            result.failed = true;
+            return result;
+        }
+        result.latencies.Record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - sentAt[response->id]).count()));
+        result.statuses[response->status.has_value() ? static_cast<std::size_t>(*response->status) : result.statuses.size() - 1]++;
+        if (response->status == SolveStatus::Solved && !IsSolutionOf<N>(puzzles[(first + response->id) % puzzles.size()], response->board))
+        {
+            result.wrong++;
+        }
+        if (sent < count)
+        {
+            send();
+        }
+    }
+    return result;
+}
+
+template <std::size_t N>
+static int Run(const LoadOptions &options)
+{
+    const std::optional<std::vector<SudokuMatrix<N>>> puzzles = ReadPuzzles<N>(options);
+    if (!puzzles.has_value() || puzzles->empty())
+    {
+        std::cerr << "Could not read " << N * N << 'x' << N * N << " puzzles from " << options.input.value_or("the generator") << '\n';
+        return 1;
+    }
+    std::vector<LoadResult> results(options.connections);
+    const auto start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> threads;
+        for (std::size_t i = 0; i < options.connections; ++i)
+        {
+            const std::size_t first = options.requests * i / options.connections;
+            const std::size_t last = options.requests * (i + 1) / options.connections;
+            threads.emplace_back([&, i, first, last]
+                                 { results[i] = RunConnection<N>(options, *puzzles, first, last - first); });
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    LoadResult total;
+    for (const LoadResult &result : results)
+    {
+        total.latencies.Merge(result.latencies);
+        for (std::size_t i = 0; i < total.statuses.size(); ++i)
+        {
+            total.statuses[i] += result.statuses[i];
+        }
+        total.wrong += result.wrong;
+        total.failed = total.failed || result.failed;
+    }
+    const auto micros = [](double nanoseconds)
+    {
+        return nanoseconds / 1000.0;
+    };
+    std::cerr << std::fixed << std::setprecision(1)
+              << "responses    " << total.latencies.GetCount() << " of " << options.requests << " over " << options.connections << " connections\n"
+              << "solved       " << total.statuses[static_cast<std::size_t>(SolveStatus::Solved)] << " (" << total.wrong << " wrong)\n"
+              << "unsolvable   " << total.statuses[static_cast<std::size_t>(SolveStatus::Unsolvable)] << '\n'
+              << "over budget  " << total.statuses[static_cast<std::size_t>(SolveStatus::BudgetExhausted)] << '\n'
+              << "late         " << total.statuses[static_cast<std::size_t>(SolveStatus::DeadlineExceeded)] << '\n'
+              << "rejected     " << total.statuses.back() << '\n'
+              << "wall time    " << seconds * 1000.0 << " ms\n"
+              << "throughput   " << static_cast<double>(total.latencies.GetCount()) / seconds << " requests/s\n"
+              << std::setprecision(2)
+              << "latency (us) mean " << micros(total.latencies.GetMean())
+              << "  p50 " << micros(static_cast<double>(total.latencies.ValueAtPercentile(50.0)))
+              << "  p90 " << micros(static_cast<double>(total.latencies.ValueAtPercentile(90.0)))
+              << "  p99 " << micros(static_cast<double>(total.latencies.ValueAtPercentile(99.0)))
+              << "  p99.9 " << micros(static_cast<double>(total.latencies.ValueAtPercentile(99.9)))
+              << "  max " << micros(static_cast<double>(total.latencies.GetMax())) << '\n';
+    if (total.failed)
+    {
+        std::cerr << "Some connections failed; is the daemon running on " << FormatEndpoint(options.endpoint) << "?\n";
+    }
+    return total.failed || total.wrong != 0 ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (HasArgument(argc, argv, "--help"))
+    {
+        PrintUsage(std::cout, argv[0]);
+        return 0;
+    }
+    const std::optional<LoadOptions> options = ParseArguments(argc, argv);
+    if (!options.has_value())
+    {
+        PrintUsage(std::cerr, argv[0]);
+        return 1;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+    return VisitBoardSize(
+        options->size,
+        [&]<std::size_t N>(std::integral_constant<std::size_t, N>)
+        {
+            if constexpr (N <= MaxTextBoardSize)
+            {
+                return Run<N>(*options);
+            }
+            else
+            {
+                return 1;
+            }
+        },
+        []()
+        { return 1; });
+}
@@ -4,9 +4,8 @@
 #include <iostream>
 #include <pcg_random.hpp>
 #include <SFML/Graphics.hpp>
-#include "../include/solvers/BackTracking.hpp"
-#include "../include/solvers/DlxSolver.hpp"
-#include "../include/SudokuUtilities.hpp"
+#include "../include/solvers/AnySolver.hpp"
+#include "../include/PuzzleGenerator.hpp"
 
 template <std::size_t N>
 static void DrawLines(sf::RenderWindow &window, std::size_t cellSize)
@@ -84,7 +83,7 @@ static bool RunClass(const SudokuMatrix<N> &matrix, sf::RenderWindow &window, sf
     std::size_t index = 0;
     while (solver.Advance() && window.isOpen())
     {
-        if constexpr (!std::is_same_v<Solver<N>, DLXSolver<N>>)
+        if constexpr (std::is_same_v<Solver<N>, BackTrackingSolver<N>>)
         {
             if (index % 1'000 != 0)
             {
@@ -162,34 +161,16 @@ static bool RunClass(const SudokuMatrix<N> &matrix, sf::RenderWindow &window, sf
 template <std::size_t N, template <std::size_t> class Solver, typename std::enable_if<std::is_base_of<ISolver<N>, Solver<N>>::value>::type * = nullptr>
 SudokuMatrix<N> GetPossibleMatrix(float probability, pcg64 &rng)
 {
+    // A unique puzzle keeping about `probability` of the cells as clues.
+    GeneratorOptions options;
+    options.targetClues = static_cast<std::size_t>(probability * static_cast<float>(N * N * N * N));
     while (true)
     {
-        SudokuMatrix<N> data = CreateBoard<N>(probability, rng);
+        SudokuMatrix<N> data = *GeneratePuzzle<N>(rng, options);
         Solver<N> solver{data};
-        std::size_t index = 0;
-        if constexpr (std::is_same_v<Solver<N>, DLXSolver<N>>)
-        {
-            while (solver.Advance(false))
-            {
-                index++;
-                if (index % 20'000 == 0)
-                {
-                    break;
-                }
-            }
-        }
-        else
-        {
-            while (solver.Advance())
-            {
-                index++;
-                if (index % 100'000'000 == 0)
-                {
-                    break;
-                }
-            }
-        }
-        if (!solver.IsSolved() || !IsValidSudoku(solver.GetBoard()))
+        // Boards that would take the visualizer too long are redrawn.
+        const std::uint64_t maxSteps = requires { solver.Advance(false); } ? 20'000 : 100'000'000;
+        if (solver.Solve(maxSteps).status != SolveStatus::Solved)
         {
             continue;
         }
@@ -214,18 +195,16 @@ int Run(const float probability, pcg64 &rng)
 }
 
 template <std::size_t N>
-int RunForSolver(const float probability, pcg64 &rng, std::string_view userSolver)
+int RunForSolver(const float probability, pcg64 &rng, SolverKind kind)
 {
-    if (userSolver == "backtrack")
-    {
-        return Run<N, BackTrackingSolver>(probability, rng);
-    }
-    if (userSolver == "dlx")
+    int result = 0;
+    if (!VisitSolverKind<N>(kind, [&]<template <std::size_t> class Solver>()
+                            { result = Run<N, Solver>(probability, rng); }))
     {
-        return Run<N, DLXSolver>(probability, rng);
+        std::cerr << "The 'band' solver only supports size 3\n";
+        return 1;
     }
-    std::cerr << "Valid solvers are 'backtrack' and 'dlx'\n";
-    return 1;
+    return result;
 }
 
 int main(int argc, char **argv)
@@ -248,38 +227,22 @@ int main(int argc, char **argv)
         return 1;
     }
     std::size_t userSize = std::stoul(argv[1]);
-    std::string_view userSolver = argv[2];
-    std::random_device device;
-    pcg64 rng{device()};
-    static constexpr float probability = 0.3f;
-    switch (userSize)
+    std::optional<SolverKind> userSolver = ParseSolverKind(argv[2]);
+    if (!userSolver.has_value())
     {
-    case 2:
-    {
-        return RunForSolver<2>(probability, rng, userSolver);
-    }
-    case 3:
-    {
-        return RunForSolver<3>(probability, rng, userSolver);
-    }
-    case 4:
-    {
-        return RunForSolver<4>(probability, rng, userSolver);
-    }
-    case 5:
-    {
-        return RunForSolver<5>(probability, rng, userSolver);
-    }
-    case 6:
-    {
-        return RunForSolver<6>(probability, rng, userSolver);
-    }
-    case 7:
-    {
-        return RunForSolver<7>(probability, rng, userSolver);
-    }
-    default:
-        std::cerr << "Invalid size\n";
+        std::cerr << "Valid solvers are 'backtrack', 'dlx', 'propagation' and 'band' (size 3 only)\n";
         return 1;
     }
+    std::random_device device;
+    pcg64 rng{device()};
+    static constexpr float probability = 0.3f;
+    return VisitBoardSize(
+        userSize,
+        [&]<std::size_t N>(std::integral_constant<std::size_t, N>)
+        { return RunForSolver<N>(probability, rng, *userSolver); },
+        []
+        {
+            std::cerr << "Invalid size\n";
+            return 1;
+        });
 }
@@ -0,0 +1,460 @@
+#include "../include/BatchSolver.hpp"
+#include "../include/ParallelSolver.hpp"
+#include "../include/PuzzleGenerator.hpp"
+#include "../include/SolveProtocol.hpp"
+#include "../include/SudokuUtilities.hpp"
+#include "../include/solvers/BackTracking.hpp"
+#include "../include/solvers/DlxSolver.hpp"
+#include "../include/solvers/PropagationSolver.hpp"
+#include "../include/solvers/BandSolver.hpp"
+#include <atomic>
+#include <filesystem>
+#include <gtest/gtest.h>
+#if !defined(_WIN32)
+#include "../include/SolveService.hpp"
+#endif
+
+static std::vector<SudokuMatrix<3>> CreatePuzzles()
+{
+    static constexpr std::array<SudokuMatrix<3>::DataType, 81> easyGame = {
+        5, 3, 0, 0, 7, 0, 0, 0, 0,
+        6, 0, 0, 1, 9, 5, 0, 0, 0,
+        0, 9, 8, 0, 0, 0, 0, 6, 0,
+
+        8, 0, 0, 0, 6, 0, 0, 0, 3,
+        4, 0, 0, 8, 0, 3, 0, 0, 1,
+        7, 0, 0, 0, 2, 0, 0, 0, 6,
+
+        0, 6, 0, 0, 0, 0, 2, 8, 0,
+        0, 0, 0, 4, 1, 9, 0, 0, 5,
+        0, 0, 0, 0, 8, 0, 0, 7, 9};
+    // The first cell has no candidate left.
+    static constexpr std::array<SudokuMatrix<3>::DataType, 81> unsolvableGame = {
+        0, 1, 2, 3, 4, 5, 6, 7, 8,
+        9, 0, 0, 0, 0, 0, 0, 0, 0};
+    std::vector<SudokuMatrix<3>> puzzles;
+    for (std::size_t i = 0; i < 20; ++i)
+    {
+        puzzles.emplace_back(easyGame);
+        puzzles.emplace_back(SudokuMatrix<3>{});
+    }
+    puzzles.emplace_back(unsolvableGame);
+    return puzzles;
+}
+
+template <template <std::size_t> class Solver>
+static void CheckBatch(std::size_t threads)
+{
+    WorkStealingPool pool(threads);
+    const std::vector<SudokuMatrix<3>> puzzles = CreatePuzzles();
+    std::vector<SudokuMatrix<3>> solutions(puzzles.size());
+    std::vector<std::uint64_t> latencies(puzzles.size(), std::numeric_limits<std::uint64_t>::max());
+    BatchOptions options;
+    options.chunkSize = 3;
+    options.latencies = latencies;
+    std::vector<SolveStatus> statuses = SolveBatch<3, Solver>(pool, std::span<const SudokuMatrix<3>>(puzzles), std::span<SudokuMatrix<3>>(solutions), options);
+    ASSERT_EQ(statuses.size(), puzzles.size());
+    for (std::size_t i = 0; i + 1 < puzzles.size(); ++i)
+    {
+        EXPECT_EQ(statuses[i], SolveStatus::Solved);
+        EXPECT_TRUE(IsValidSudoku(solutions[i]));
+        for (std::size_t cell = 0; cell < 81; ++cell)
+        {
+            EXPECT_NE(solutions[i].GetValue(cell), 0);
+            if (puzzles[i].GetValue(cell) != 0)
+            {
+                EXPECT_EQ(solutions[i].GetValue(cell), puzzles[i].GetValue(cell));
+            }
+        }
+    }
+    EXPECT_EQ(statuses.back(), SolveStatus::Unsolvable);
+    for (const std::uint64_t latency : latencies)
+    {
+        EXPECT_NE(latency, std::numeric_limits<std::uint64_t>::max());
+    }
+}
+
+TEST(BatchSolver, SolvesBatchBackTracking)
+{
+    CheckBatch<BackTrackingSolver>(1);
+    CheckBatch<BackTrackingSolver>(4);
+}
+
+TEST(BatchSolver, SolvesBatchDlx)
+{
+    CheckBatch<DLXSolver>(1);
+    CheckBatch<DLXSolver>(4);
+}
+
+TEST(BatchSolver, SolvesBatchPropagation)
+{
+    CheckBatch<PropagationSolver>(1);
+    CheckBatch<PropagationSolver>(4);
+}
+
+TEST(BatchSolver, SolvesBatchBand)
+{
+    if (!GetCpuFeatures().avx2)
+    {
+        GTEST_SKIP() << "BandSolver needs AVX2";
+    }
+    CheckBatch<BandSolver>(1);
+    CheckBatch<BandSolver>(4);
+}
+
+TEST(BatchSolver, ReportsExhaustedBudget)
+{
+    static constexpr std::array<SudokuMatrix<3>::DataType, 81> hardGame = {
+        0,0,0,0,0,0,0,0,0,
+        0,9,0,0,1,0,0,3,0,
+        0,0,6,0,2,0,7,0,0,
+        0,0,0,3,0,4,0,0,0,
+        2,1,0,0,0,0,0,9,8,
+        0,0,0,0,0,0,0,0,0,
+        0,0,2,5,0,6,4,0,0,
+        0,8,0,0,0,0,0,1,0,
+        0,0,0,0,0,0,0,0,0,
+    };
+    WorkStealingPool pool(2);
+    const std::vector<SudokuMatrix<3>> puzzles(4, SudokuMatrix<3>{hardGame});
+    std::vector<SudokuMatrix<3>> solutions(puzzles.size());
+    BatchOptions options;
+    options.maxSteps = 100;
+    std::vector<SolveStatus> statuses = SolveBatch<3, BackTrackingSolver>(pool, std::span<const SudokuMatrix<3>>(puzzles), std::span<SudokuMatrix<3>>(solutions), options);
+    for (SolveStatus status : statuses)
+    {
+        EXPECT_EQ(status, SolveStatus::BudgetExhausted);
+    }
+}
+
+TEST(BatchSolver, StopsOnCancellationAndDeadline)
+{
+    WorkStealingPool pool(2);
+    const std::vector<SudokuMatrix<3>> puzzles = CreatePuzzles();
+    std::vector<SudokuMatrix<3>> solutions(puzzles.size());
+    std::stop_source stopSource;
+    stopSource.request_stop();
+    BatchOptions options;
+    options.stopToken = stopSource.get_token();
+    std::vector<SolveStatus> statuses = SolveBatch<3, DLXSolver>(pool, std::span<const SudokuMatrix<3>>(puzzles), std::span<SudokuMatrix<3>>(solutions), options);
+    for (SolveStatus status : statuses)
+    {
+        EXPECT_EQ(status, SolveStatus::Cancelled);
+    }
+
+    options = BatchOptions{};
+    options.deadline = std::chrono::steady_clock::now();
+    statuses = SolveBatch<3, PropagationSolver>(pool, std::span<const SudokuMatrix<3>>(puzzles), std::span<SudokuMatrix<3>>(solutions), options);
+    for (SolveStatus status : statuses)
+    {
+        EXPECT_EQ(status, SolveStatus::DeadlineExceeded);
+    }
+
+    std::vector<std::chrono::steady_clock::time_point> deadlines(puzzles.size(), NoDeadline);
+    for (std::size_t i = 0; i < deadlines.size(); i += 2)
+    {
+        deadlines[i] = std::chrono::steady_clock::now();
+    }
+    options = BatchOptions{};
+    options.deadlines = deadlines;
+    statuses = SolveBatch<3, BackTrackingSolver>(pool, std::span<const SudokuMatrix<3>>(puzzles), std::span<SudokuMatrix<3>>(solutions), options);
+    for (std::size_t i = 0; i < statuses.size(); ++i)
+    {
+        EXPECT_EQ(statuses[i], i % 2 == 0 ? SolveStatus::DeadlineExceeded : SolveStatus::Solved);
+    }
+}
+
+template <std::size_t N>
+static void ExpectSolutionOf(const SudokuMatrix<N> &puzzle, const SudokuMatrix<N> &solution)
+{
+    constexpr std::size_t cellCount = N * N * N * N;
+    EXPECT_TRUE(IsValidSudoku(solution));
+    for (std::size_t cell = 0; cell < cellCount; ++cell)
+    {
+        EXPECT_NE(solution.GetValue(cell), 0);
+        if (puzzle.GetValue(cell) != 0)
+        {
+            EXPECT_EQ(solution.GetValue(cell), puzzle.GetValue(cell));
+        }
+    }
+}
+
+template <template <std::size_t> class Solver>
+static void CheckParallel(std::size_t threads)
+{
+    static constexpr std::array<SudokuMatrix<3>::DataType, 81> hardGame = {
+        0,0,0,0,0,0,0,0,0,
+        0,9,0,0,1,0,0,3,0,
+        0,0,6,0,2,0,7,0,0,
+        0,0,0,3,0,4,0,0,0,
+        2,1,0,0,0,0,0,9,8,
+        0,0,0,0,0,0,0,0,0,
+        0,0,2,5,0,6,4,0,0,
+        0,8,0,0,0,0,0,1,0,
+        0,0,0,0,0,0,0,0,0,
+    };
+    WorkStealingPool pool(threads);
+    const SudokuMatrix<3> puzzle{hardGame};
+    SudokuMatrix<3> solution;
+    EXPECT_EQ((SolveParallel<3, Solver>(pool, puzzle, solution)), SolveStatus::Solved);
+    ExpectSolutionOf<3>(puzzle, solution);
+}
+
+TEST(ParallelSolver, SolvesHardPuzzleDlx)
+{
+    CheckParallel<DLXSolver>(1);
+    CheckParallel<DLXSolver>(4);
+}
+
+TEST(ParallelSolver, SolvesHardPuzzleBackTracking)
+{
+    CheckParallel<BackTrackingSolver>(1);
+    CheckParallel<BackTrackingSolver>(4);
+}
+
+TEST(ParallelSolver, SolvesEmptyLargeBoard)
+{
+    WorkStealingPool pool(4);
+    const SudokuMatrix<4> puzzle{};
+    SudokuMatrix<4> solution;
+    EXPECT_EQ((SolveParallel<4, DLXSolver>(pool, puzzle, solution)), SolveStatus::Solved);
+    ExpectSolutionOf<4>(puzzle, solution);
+}
+
+TEST(ParallelSolver, ReportsUnsolvablePuzzles)
+{
+    // The first cell has no candidate left.
+    static constexpr std::array<SudokuMatrix<3>::DataType, 81> blockedGame = {
+        0, 1, 2, 3, 4, 5, 6, 7, 8,
+        9, 0, 0, 0, 0, 0, 0, 0, 0};
+    // Both empty cells of the first row can only hold a 9.
+    static constexpr std::array<SudokuMatrix<3>::DataType, 81> deadEndGame = {
+        1, 2, 3, 4, 5, 6, 7, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 8, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 8};
+    WorkStealingPool pool(2);
+    SudokuMatrix<3> solution;
+    EXPECT_EQ((SolveParallel<3, DLXSolver>(pool, SudokuMatrix<3>{blockedGame}, solution)), SolveStatus::Unsolvable);
+    EXPECT_EQ((SolveParallel<3, DLXSolver>(pool, SudokuMatrix<3>{deadEndGame}, solution)), SolveStatus::Unsolvable);
+    EXPECT_EQ((SolveParallel<3, BackTrackingSolver>(pool, SudokuMatrix<3>{deadEndGame}, solution)), SolveStatus::Unsolvable);
+}
+
+TEST(PuzzleGenerator, GeneratesSameBatchOnAnyPool)
+{
+    WorkStealingPool small(1);
+    WorkStealingPool large(4);
+    const std::vector<SudokuMatrix<3>> first = GeneratePuzzles<3>(small, 50, 99);
+    ASSERT_EQ(first.size(), 50);
+    for (const SudokuMatrix<3> &puzzle : first)
+    {
+        DLXSolver<3> solver{puzzle};
+        EXPECT_EQ(solver.CountSolutions(2), 1);
+    }
+    EXPECT_TRUE(GeneratePuzzles<3>(large, 50, 99) == first);
+    EXPECT_FALSE(GeneratePuzzles<3>(large, 50, 100) == first);
+}
+
+TEST(WorkStealingPool, RunsTasksSubmittedToOneWorker)
+{
+    WorkStealingPool pool(4);
+    std::atomic<int> counter = 0;
+    for (int i = 0; i < 1000; ++i)
+    {
+        pool.Submit(0, [&counter]
+                    { counter++; });
+    }
+    pool.Wait();
+    EXPECT_EQ(counter.load(), 1000);
+}
+
+TEST(WorkStealingPool, KnowsItsWorkerThreads)
+{
+    WorkStealingPool pool(2);
+    WorkStealingPool other(1);
+    EXPECT_FALSE(pool.IsWorkerThread());
+    std::atomic<bool> own = false;
+    std::atomic<bool> foreign = true;
+    pool.Submit([&]
+                {
+                    own = pool.IsWorkerThread();
+                    foreign = other.IsWorkerThread(); });
+    pool.Wait();
+    EXPECT_TRUE(own.load());
+    EXPECT_FALSE(foreign.load());
+}
+
+
+TEST(SolveProtocol, RoundTripsFrames)
+{
+    static_assert(SolveProtocol::PackedBoardSize(3) == PackedBoard<3>::Bytes);
+    static_assert(SolveProtocol::PackedBoardSize(5) == PackedBoard<5>::Bytes);
+    static_assert(SolveProtocol::PackedBoardSize(MaxDynamicBoardSize) != 0);
+    static_assert(SolveProtocol::PackedBoardSize(MaxDynamicBoardSize + 1) == 0);
+    const std::vector<SudokuMatrix<3>> puzzles = CreatePuzzles();
+    std::vector<std::uint8_t> bytes;
+    AppendRequest<3>(bytes, {7, SolverKind::Propagation, 1500, puzzles[0]});
+    EXPECT_FALSE(ReadRequestHeader(std::span<const std::uint8_t>(bytes).first(SolveProtocol::RequestHeaderSize - 1)).has_value());
+    std::optional<RequestHeader> header = ReadRequestHeader(bytes);
+    ASSERT_TRUE(header.has_value());
+    EXPECT_EQ(RequestFrameSize(*header), bytes.size());
+    const std::optional<SolveRequest<3>> request = ParseRequest<3>(*header, bytes.data() + SolveProtocol::RequestHeaderSize);
+    ASSERT_TRUE(request.has_value());
+    EXPECT_EQ(request->id, 7u);
+    EXPECT_EQ(request->solver, SolverKind::Propagation);
+    EXPECT_EQ(request->deadlineMicros, 1500u);
+    EXPECT_TRUE(request->puzzle == puzzles[0]);
+    EXPECT_FALSE(ParseRequest<2>(*header, bytes.data() + SolveProtocol::RequestHeaderSize).has_value());
+    bytes[5] = 9;
+    header = ReadRequestHeader(bytes);
+    EXPECT_FALSE(ParseRequest<3>(*header, bytes.data() + SolveProtocol::RequestHeaderSize).has_value());
+
+    bytes.clear();
+    AppendResponse<3>(bytes, 7, SolveStatus::Solved, puzzles[1]);
+    const std::size_t firstSize = bytes.size();
+    AppendResponse<3>(bytes, 8, std::nullopt, SudokuMatrix<3>{});
+    const std::optional<ResponseHeader> first = ReadResponseHeader(bytes);
+    ASSERT_TRUE(first.has_value());
+    ASSERT_EQ(ResponseFrameSize(*first), firstSize);
+    const std::optional<SolveResponse<3>> solved = ParseResponse<3>(*first, bytes.data() + SolveProtocol::ResponseHeaderSize);
+    ASSERT_TRUE(solved.has_value());
+    EXPECT_EQ(solved->id, 7u);
+    EXPECT_EQ(solved->status, SolveStatus::Solved);
+    EXPECT_TRUE(solved->board == puzzles[1]);
+    const std::optional<ResponseHeader> second = ReadResponseHeader(std::span<const std::uint8_t>(bytes).subspan(firstSize));
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(ResponseFrameSize(*second), SolveProtocol::ResponseHeaderSize);
+    const std::optional<SolveResponse<3>> rejected = ParseResponse<3>(*second, nullptr);
+    ASSERT_TRUE(rejected.has_value());
+    EXPECT_EQ(rejected->id, 8u);
+    EXPECT_FALSE(rejected->status.has_value());
+}
+
+#if !defined(_WIN32)
+TEST(SolveServer, AnswersPipelinedRequests)
+{
+    ServiceEndpoint endpoint{(std::filesystem::temp_directory_path() / ("sudoku-test-" + std::to_string(getpid()) + ".sock")).string(), 0};
+    SolveServerOptions options;
+    options.threads = 2;
+    options.maxBatch = 8;
+    const std::unique_ptr<SolveServer<3>> server = SolveServer<3>::Start(endpoint, options);
+    ASSERT_NE(server, nullptr);
+    const std::vector<SudokuMatrix<3>> puzzles = CreatePuzzles();
+    std::optional<SolveClient<3>> client = SolveClient<3>::Connect(endpoint);
+    ASSERT_TRUE(client.has_value());
+    for (std::size_t i = 0; i < puzzles.size(); ++i)
+    {
+        client->Send({static_cast<std::uint32_t>(i), i % 2 == 0 ? SolverKind::Dlx : SolverKind::BackTracking, 0, puzzles[i]});
+    }
+    // Already late when the batch starts.
+    client->Send({1000, SolverKind::Dlx, 1, SudokuMatrix<3>{}});
+    ASSERT_TRUE(client->Flush());
+
+    std::vector<bool> answered(puzzles.size(), false);
+    for (std::size_t i = 0; i <= puzzles.size(); ++i)
+    {
+        const std::optional<SolveResponse<3>> response = client->Receive();
+        ASSERT_TRUE(response.has_value());
+        if (response->id == 1000)
+        {
+            EXPECT_EQ(response->status, SolveStatus::DeadlineExceeded);
+            continue;
+        }
+        ASSERT_LT(response->id, puzzles.size());
+        EXPECT_FALSE(answered[response->id]);
+        answered[response->id] = true;
+        if (response->id + 1 == puzzles.size())
+        {
+            EXPECT_EQ(response->status, SolveStatus::Unsolvable);
+            continue;
+        }
+        EXPECT_EQ(response->status, SolveStatus::Solved);
+        ExpectSolutionOf<3>(puzzles[response->id], response->board);
+    }
+
+    // The server only takes 9x9 puzzles.
+    std::optional<SolveClient<2>> smallClient = SolveClient<2>::Connect(endpoint);
+    ASSERT_TRUE(smallClient.has_value());
+    smallClient->Send({5, SolverKind::Dlx, 0, SudokuMatrix<2>{}});
+    const std::optional<SolveResponse<2>> rejected = smallClient->Receive();
+    ASSERT_TRUE(rejected.has_value());
+    EXPECT_EQ(rejected->id, 5u);
+    EXPECT_FALSE(rejected->status.has_value());
+
+    EXPECT_EQ(server->GetRequestCount(), puzzles.size() + 2);
+    EXPECT_LE(server->GetBatchCount(), server->GetRequestCount());
+    server->Stop();
+    EXPECT_FALSE(client->Receive().has_value());
+    EXPECT_FALSE(std::filesystem::exists(endpoint.path));
+}
+
+TEST(SolveServer, ServesLoopbackTcp)
+{
+    SolveServerOptions options;
+    options.threads = 1;
+    const std::unique_ptr<SolveServer<3>> server = SolveServer<3>::Start(*ParseEndpoint("tcp:0"), options);
+    ASSERT_NE(server, nullptr);
+    EXPECT_NE(server->GetEndpoint().port, 0);
+    std::optional<SolveClient<3>> client = SolveClient<3>::Connect(server->GetEndpoint());
+    ASSERT_TRUE(client.has_value());
+    const SudokuMatrix<3> puzzle = CreatePuzzles().front();
+    client->Send({1, SolverKind::Propagation, 0, puzzle});
+    const std::optional<SolveResponse<3>> response = client->Receive();
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(response->status, SolveStatus::Solved);
+    ExpectSolutionOf<3>(puzzle, response->board);
+}
+
+TEST(SolveServer, StopsReadingFromClientsThatDoNotRead)
+{
+    SolveServerOptions options;
+    options.threads = 2;
+    options.maxInFlight = 64;
+    const std::unique_ptr<SolveServer<3>> server = SolveServer<3>::Start(*ParseEndpoint("tcp:0"), options);
+    ASSERT_NE(server, nullptr);
+    const SudokuMatrix<3> puzzle = CreatePuzzles().front();
+
+    // Sends until the server has stopped taking requests for a while. One
+    // that kept reading would take all 64 MB.
+    const UniqueFd stalled = ConnectTo(server->GetEndpoint());
+    ASSERT_TRUE(stalled);
+    ASSERT_TRUE(Detail::SetNonBlocking(stalled.Get()));
+    std::vector<std::uint8_t> frames;
+    for (std::uint32_t id = 0; id < 1024; ++id)
+    {
+        AppendRequest<3>(frames, {id, SolverKind::Dlx, 0, puzzle});
+    }
+    std::size_t offset = 0;
+    std::size_t total = 0;
+    bool blocked = false;
+    while (!blocked && total < (std::size_t{64} << 20))
+    {
+        const ssize_t sent = send(stalled.Get(), frames.data() + offset, frames.size() - offset, Detail::SendFlags);
+        if (sent > 0)
+        {
+            offset = (offset + static_cast<std::size_t>(sent)) % frames.size();
+            total += static_cast<std::size_t>(sent);
+            continue;
+        }
+        ASSERT_TRUE(errno == EAGAIN || errno == EWOULDBLOCK);
+        pollfd writable{stalled.Get(), POLLOUT, 0};
+        blocked = poll(&writable, 1, 500) == 0;
+    }
+    EXPECT_TRUE(blocked);
+
+    std::optional<SolveClient<3>> client = SolveClient<3>::Connect(server->GetEndpoint());
+    ASSERT_TRUE(client.has_value());
+    client->Send({1, SolverKind::Propagation, 0, puzzle});
+    const std::optional<SolveResponse<3>> response = client->Receive();
+    ASSERT_TRUE(response.has_value());
+    EXPECT_EQ(response->status, SolveStatus::Solved);
+
+    const auto start = std::chrono::steady_clock::now();
+    server->Stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    EXPECT_FALSE(client->Receive().has_value());
+}
+#endif
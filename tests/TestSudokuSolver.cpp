@@ -1,7 +1,19 @@
 #include "../include/SudokuMatrix.hpp"
+#include "../include/CandidateCache.hpp"
 #include "../include/solvers/BackTracking.hpp"
 #include "../include/solvers/DlxSolver.hpp"
+#include "../include/solvers/PropagationSolver.hpp"
+#include "../include/solvers/BandSolver.hpp"
+#include "../include/solvers/AnySolver.hpp"
 #include "../include/SudokuUtilities.hpp"
+#include "../include/PuzzleIO.hpp"
+#include "../include/LatencyHistogram.hpp"
+#include "../include/PuzzleGenerator.hpp"
+#include "../include/PuzzleArchive.hpp"
+#include "../include/CommandLine.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
 #include <gtest/gtest.h>
 
 inline constexpr SudokuMatrix<3> CreateBoard()
@@ -152,6 +164,19 @@ TEST(DynamicSudokuMatrix, RemoveValue)
     EXPECT_EQ(matrix.GetValue(2, 2), 0);
 }
 
+template <std::size_t N, std::size_t Size>
+inline constexpr bool KeepsGivens(const std::array<typename SudokuMatrix<N>::DataType, Size> &sudokuGame, const SudokuMatrix<N> &board)
+{
+    for (std::size_t i = 0; i < Size; ++i)
+    {
+        if (sudokuGame[i] != 0 && board.GetValue(i) != sudokuGame[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 template<std::size_t N, template<std::size_t> class Solver, typename std::enable_if<std::is_base_of<ISolver<N>, Solver<N>>::value>::type * = nullptr>
 inline constexpr bool SolveHardSudoku()
 {
@@ -169,7 +194,7 @@ inline constexpr bool SolveHardSudoku()
     constexpr auto getSolver = [](const std::array<typename Solver<N>::DataType, 81>& sudokuGame) -> Solver<N>
     {
         Solver<N> solver{sudokuGame};
-        if constexpr (std::is_same_v<Solver<N>, DLXSolver<N>>)
+        if constexpr (requires { solver.Advance(false); })
         {
             while (solver.Advance(false));
         }
@@ -197,7 +222,7 @@ inline constexpr bool SolveHardSudoku()
     constexpr auto solve = [](const std::array<typename Solver<N>::DataType, 81>& sudokuGame) -> bool
     {
         Solver<N> solver = getSolver(sudokuGame);
-        return validateSolver(solver);
+        return validateSolver(solver) && KeepsGivens<N>(sudokuGame, solver.GetBoard());
     };
     return solve(sudokuGame);
 }
@@ -221,7 +246,7 @@ inline constexpr bool CanBeSolved()
     constexpr auto getSolver = [](const std::array<typename Solver<N>::DataType, 81> &sudokuGame) -> Solver<N>
     {
         Solver<N> solver{sudokuGame};
-        if constexpr (std::is_same_v<Solver<N>, DLXSolver<N>>)
+        if constexpr (requires { solver.Advance(false); })
         {
             while (solver.Advance(false));
         }
@@ -249,7 +274,7 @@ inline constexpr bool CanBeSolved()
     constexpr auto solve = [](const std::array<typename Solver<N>::DataType, 81> &sudokuGame) -> bool
     {
         Solver<N> solver = getSolver(sudokuGame);
-        return validateSolver(solver);
+        return validateSolver(solver) && KeepsGivens<N>(sudokuGame, solver.GetBoard());
     };
     return solve(sudokuGame);
 }
@@ -307,10 +332,7 @@ TEST(SudokuMatrix, CheckBitSetIterator)
 {
     static constexpr auto getIterator = [](int iterations)
     {
-        FastBitset<9> bitset;
-        bitset.set(0);
-        bitset.set(2);
-        BitSetIterator<3> it{bitset};
+        BitSetIterator<3> it{std::uint16_t{0b101}};
         for (int i = 0; i < iterations; ++i)
         {
             ++it;
@@ -329,10 +351,8 @@ TEST(SudokuMatrix, CheckBitSetIterator)
 
 TEST(DynamicSudokuMatrix, CheckBitSetIterator)
 {
-    boost::dynamic_bitset<> bitset{3};
-    bitset.set(0);
-    bitset.set(2);
-    DynamicBitSetIterator it{bitset};
+    static constexpr std::array<std::uint64_t, 1> words = {0b101};
+    DynamicBitSetIterator it{words};
     EXPECT_EQ(it.Count(), 2);
     EXPECT_EQ(*it, 1);
     ++it;
@@ -342,6 +362,14 @@ TEST(DynamicSudokuMatrix, CheckBitSetIterator)
     EXPECT_EQ(it.Count(), 0);
 }
 
+TEST(DynamicSudokuMatrix, RejectsOversizedBoards)
+{
+    static_assert(DynamicBitSetIterator::MaxValue == 255);
+    EXPECT_NO_THROW(DynamicSudokuMatrix(15).GetPossibleValues(0, 0));
+    EXPECT_THROW(DynamicSudokuMatrix(16), std::length_error);
+    EXPECT_THROW(DynamicSudokuMatrix(17), std::length_error);
+}
+
 TEST(SudokuMatrix, GetPossibleValues)
 {
     static constexpr auto getIterator = [](const SudokuMatrix<3> &matrix, int iterations)
@@ -368,6 +396,291 @@ TEST(SudokuMatrix, GetPossibleValues)
     static_assert(*it3 == 7);
 }
 
+TEST(SudokuMatrix, UnitMaskWidth)
+{
+    static_assert(std::is_same_v<UnitMask<2>, std::uint16_t>);
+    static_assert(std::is_same_v<UnitMask<3>, std::uint16_t>);
+    static_assert(std::is_same_v<UnitMask<4>, std::uint16_t>);
+    static_assert(std::is_same_v<UnitMask<5>, std::uint32_t>);
+    static_assert(std::is_same_v<UnitMask<6>, std::uint64_t>);
+    static_assert(std::is_same_v<UnitMask<8>, std::uint64_t>);
+    static_assert(std::is_same_v<UnitMask<9>, FastBitset<81>>);
+    static_assert(std::is_same_v<UnitMask<16>, FastBitset<256>>);
+    static_assert(UnitMaskTraits<3>::All == 0x1FF);
+    static_assert(UnitMaskTraits<8>::All == ~std::uint64_t{0});
+    static_assert(UnitMaskTraits<3>::Complement(0b101) == 0x1FA);
+}
+
+// Same grid as CreatePatternBoard, built straight into a (heap) SudokuMatrix<N>.
+template <std::size_t N>
+inline std::unique_ptr<SudokuMatrix<N>> CreateLargePatternBoard(std::size_t stride)
+{
+    constexpr std::size_t size = N * N;
+    auto board = std::make_unique<SudokuMatrix<N>>();
+    for (std::size_t row = 0; row < size; ++row)
+    {
+        for (std::size_t col = 0; col < size; ++col)
+        {
+            if ((row * size + col) % stride != 0)
+            {
+                board->SetValue(row, col, static_cast<typename SudokuMatrix<N>::DataType>((row * N + row / N + col) % size + 1));
+            }
+        }
+    }
+    return board;
+}
+
+TEST(SudokuMatrix, LargeBoardCandidates)
+{
+    // 256 values per unit: candidates span four 64-bit words.
+    auto board = std::make_unique<SudokuMatrix<16>>();
+    for (std::size_t col = 0; col < 255; ++col)
+    {
+        board->SetValue(0, col, static_cast<SudokuMatrix<16>::DataType>(col + 1));
+    }
+    auto last = board->GetPossibleValues(0, 255);
+    EXPECT_EQ(last.Count(), 1);
+    EXPECT_EQ(*last, 256);
+    board->RemoveValue(0, 199);
+    EXPECT_TRUE(board->IsValidPlay(200, 0, 199));
+    auto freed = board->GetPossibleValues(0, 199);
+    EXPECT_EQ(freed.Count(), 2);
+    EXPECT_EQ(*freed, 200);
+    ++freed;
+    EXPECT_EQ(*freed, 256);
+    EXPECT_TRUE(IsValidSudoku(*board));
+}
+
+TEST(SudokuMatrix, SolveLargeBoardBackTracking)
+{
+    auto board = CreateLargePatternBoard<9>(80);
+    auto solver = std::make_unique<BackTrackingSolver<9>>(*board);
+    while (solver->Advance())
+    {
+    }
+    EXPECT_TRUE(solver->IsSolved());
+    EXPECT_TRUE(IsValidSudoku(solver->GetBoard()));
+    auto large = CreateLargePatternBoard<16>(255);
+    auto largeSolver = std::make_unique<BackTrackingSolver<16>>(*large);
+    while (largeSolver->Advance())
+    {
+    }
+    EXPECT_TRUE(largeSolver->IsSolved());
+    EXPECT_TRUE(IsValidSudoku(largeSolver->GetBoard()));
+}
+
+template <std::size_t N>
+inline void ExpectAllCandidatesMatchPerCell(pcg64 &rng)
+{
+    constexpr std::size_t size = N * N;
+    for (float probability : {0.0f, 0.3f, 0.7f})
+    {
+        const SudokuMatrix<N> board = CreateBoard<N>(probability, rng);
+        std::vector<typename SudokuMatrix<N>::MaskType> candidates(size * size);
+        std::vector<typename SudokuMatrix<N>::DataType> counts(size * size);
+        board.ComputeAllCandidates(candidates, counts);
+        for (std::size_t row = 0; row < size; ++row)
+        {
+            for (std::size_t col = 0; col < size; ++col)
+            {
+                const std::size_t index = SudokuMatrix<N>::MatrixIndex(row, col);
+                if (board.GetValue(index) != 0)
+                {
+                    EXPECT_EQ(candidates[index], typename SudokuMatrix<N>::MaskType{});
+                    EXPECT_EQ(counts[index], 0);
+                    continue;
+                }
+                const auto expected = board.GetPossibleValues(row, col);
+                EXPECT_EQ(expected, candidates[index]);
+                EXPECT_EQ(counts[index], expected.Count());
+            }
+        }
+    }
+}
+
+TEST(SudokuMatrix, ComputeAllCandidates)
+{
+    pcg64 rng(5);
+    ExpectAllCandidatesMatchPerCell<2>(rng);
+    ExpectAllCandidatesMatchPerCell<3>(rng);
+    ExpectAllCandidatesMatchPerCell<4>(rng);
+    ExpectAllCandidatesMatchPerCell<5>(rng);
+    ExpectAllCandidatesMatchPerCell<6>(rng);
+}
+
+template <std::size_t N>
+inline void ExpectCacheMatchesBoard(const CandidateCache<N> &cache, const SudokuMatrix<N> &board)
+{
+    constexpr std::size_t size = N * N;
+    std::vector<typename SudokuMatrix<N>::MaskType> candidates(size * size);
+    board.ComputeAllCandidates(candidates);
+    std::size_t empty = 0;
+    std::size_t minCount = size + 1;
+    std::size_t minCell = CandidateCache<N>::NoCell;
+    for (std::size_t index = 0; index < size * size; ++index)
+    {
+        ASSERT_EQ(cache.GetCandidates(index), candidates[index]);
+        if (board.GetValue(index) != 0)
+        {
+            continue;
+        }
+        empty++;
+        ASSERT_EQ(cache.GetCount(index), static_cast<std::size_t>(UnitMaskTraits<N>::Count(candidates[index])));
+        ASSERT_TRUE(cache.GetCells(cache.GetCount(index)).test(index));
+        if (cache.GetCount(index) < minCount)
+        {
+            minCount = cache.GetCount(index);
+            minCell = index;
+        }
+    }
+    EXPECT_EQ(cache.GetEmptyCount(), empty);
+    EXPECT_EQ(cache.GetMinCount(), minCount);
+    EXPECT_EQ(cache.GetMinCell(), minCell);
+}
+
+template <std::size_t N>
+inline void ExpectCacheFollowsEdits(pcg64 &rng)
+{
+    constexpr std::size_t cellCount = N * N * N * N;
+    SudokuMatrix<N> board = CreateBoard<N>(0.3f, rng);
+    auto cache = std::make_unique<CandidateCache<N>>(board);
+    ExpectCacheMatchesBoard(*cache, board);
+    for (int step = 0; step < 500; ++step)
+    {
+        const std::size_t index = rng() % cellCount;
+        if (board.GetValue(index) != 0)
+        {
+            cache->RemoveValue(board, index);
+        }
+        else
+        {
+            const typename SudokuMatrix<N>::MaskType candidates = cache->GetCandidates(index);
+            if (!UnitMaskTraits<N>::Any(candidates))
+            {
+                continue;
+            }
+            cache->SetValue(board, index, *BitSetIterator<N>{candidates});
+        }
+        ExpectCacheMatchesBoard(*cache, board);
+    }
+}
+
+TEST(SudokuMatrix, CandidateCacheFollowsEdits)
+{
+    pcg64 rng(7);
+    ExpectCacheFollowsEdits<2>(rng);
+    ExpectCacheFollowsEdits<3>(rng);
+    ExpectCacheFollowsEdits<4>(rng);
+    ExpectCacheFollowsEdits<5>(rng);
+}
+
+TEST(SudokuMatrix, RollbackToCheckpoint)
+{
+    SudokuMatrix<3> matrix;
+    matrix.SetValue(0, 0, 1);
+    matrix.SetValue(4, 4, 5);
+    const SudokuMatrix<3> original = matrix;
+    SudokuTrail<3> trail;
+    const std::size_t checkpoint = trail.Checkpoint();
+    trail.SetValue(matrix, 0, 2, 4);
+    trail.RemoveValue(matrix, 0, 0);
+    trail.SetValue(matrix, 4, 4, 2);
+    EXPECT_EQ(trail.Size(), 3);
+    trail.RollbackTo(matrix, checkpoint);
+    EXPECT_EQ(trail.Size(), 0);
+    EXPECT_TRUE(matrix == original);
+    EXPECT_EQ(matrix.GetBits(), original.GetBits());
+}
+
+template <std::size_t N>
+inline void ExpectBoardRollsBack(pcg64 &rng)
+{
+    constexpr std::size_t size = N * N;
+    SudokuMatrix<N> board = CreateBoard<N>(0.3f, rng);
+    SudokuTrail<N> trail;
+    std::vector<SudokuMatrix<N>> boards;
+    std::vector<std::size_t> checkpoints;
+    for (int level = 0; level < 5; ++level)
+    {
+        boards.push_back(board);
+        checkpoints.push_back(trail.Checkpoint());
+        for (int step = 0; step < 40; ++step)
+        {
+            const std::size_t row = rng() % size;
+            const std::size_t col = rng() % size;
+            if (board.GetValue(row, col) != 0)
+            {
+                trail.RemoveValue(board, row, col);
+                continue;
+            }
+            auto candidates = board.GetPossibleValues(row, col);
+            if (candidates.Count() != 0)
+            {
+                trail.SetValue(board, row, col, *candidates);
+            }
+        }
+    }
+    while (!checkpoints.empty())
+    {
+        trail.RollbackTo(board, checkpoints.back());
+        ASSERT_TRUE(board == boards.back());
+        ASSERT_EQ(board.GetBits(), boards.back().GetBits());
+        checkpoints.pop_back();
+        boards.pop_back();
+    }
+}
+
+TEST(SudokuMatrix, NestedRollbacks)
+{
+    pcg64 rng(11);
+    ExpectBoardRollsBack<2>(rng);
+    ExpectBoardRollsBack<3>(rng);
+    ExpectBoardRollsBack<4>(rng);
+    ExpectBoardRollsBack<5>(rng);
+}
+
+template <std::size_t N>
+inline void ExpectCacheRollsBack(pcg64 &rng)
+{
+    constexpr std::size_t cellCount = N * N * N * N;
+    SudokuMatrix<N> board = CreateBoard<N>(0.3f, rng);
+    auto cache = std::make_unique<CandidateCache<N>>(board);
+    SudokuTrail<N> trail;
+    std::vector<SudokuMatrix<N>> boards;
+    std::vector<std::size_t> checkpoints;
+    for (int level = 0; level < 5; ++level)
+    {
+        boards.push_back(board);
+        checkpoints.push_back(trail.Checkpoint());
+        for (int step = 0; step < 40; ++step)
+        {
+            const std::size_t index = rng() % cellCount;
+            const typename SudokuMatrix<N>::MaskType candidates = cache->GetCandidates(index);
+            if (board.GetValue(index) == 0 && UnitMaskTraits<N>::Any(candidates))
+            {
+                cache->SetValue(board, trail, index, *BitSetIterator<N>{candidates});
+            }
+        }
+    }
+    while (!checkpoints.empty())
+    {
+        cache->RollbackTo(board, trail, checkpoints.back());
+        ASSERT_TRUE(board == boards.back());
+        ExpectCacheMatchesBoard(*cache, board);
+        checkpoints.pop_back();
+        boards.pop_back();
+    }
+}
+
+TEST(SudokuMatrix, CandidateCacheRollsBack)
+{
+    pcg64 rng(13);
+    ExpectCacheRollsBack<2>(rng);
+    ExpectCacheRollsBack<3>(rng);
+    ExpectCacheRollsBack<4>(rng);
+    ExpectCacheRollsBack<5>(rng);
+}
+
 TEST(DynamicSudokuMatrix, GetPossibleValues)
 {
     DynamicSudokuMatrix matrix = CreateDynamicBoard();
@@ -428,13 +741,13 @@ TEST(BothSudoku, TestSameBitSets)
     DynamicSudokuMatrix matrix2 = CreateDynamicBoard();
     const auto &bits1 = matrix1.GetBits();
     const auto &bits2 = matrix2.GetBits();
-    if (bits1.size() != bits2.size())
+    if (bits1.size() != bits2.GetUnitCount() || bits2.GetWordStride() != 1)
     {
         FAIL();
     }
     for (std::size_t i = 0; i < bits1.size(); ++i)
     {
-        EXPECT_EQ(bits1[i], bits2[i].to_ulong());
+        EXPECT_EQ(bits1[i], bits2.GetUnit(i)[0]);
     }
 }
 
@@ -465,4 +778,1062 @@ TEST(SudokuMatrix, SolveHardSudokuDlx)
 {
     bool solved = SolveHardSudoku<3, DLXSolver>();
     EXPECT_TRUE(solved);
+}
+
+TEST(SudokuMatrix, SolveSudokuPropagation)
+{
+    bool solved = CanBeSolved<3, PropagationSolver>();
+    EXPECT_TRUE(solved);
+}
+
+TEST(SudokuMatrix, PropagationRejectsConflictingGivens)
+{
+    // Two 1s in the first column, then in the first square.
+    for (const std::size_t second : {std::size_t{9}, std::size_t{10}})
+    {
+        std::array<SudokuMatrix<3>::DataType, 81> cells{};
+        cells[0] = 1;
+        cells[second] = 1;
+        PropagationSolver<3> solver{SudokuMatrix<3>{cells}};
+        const SolveResult result = solver.Solve(10'000'000);
+        EXPECT_EQ(result.status, SolveStatus::Unsolvable);
+        EXPECT_LE(result.steps, 1u);
+    }
+}
+
+TEST(SudokuMatrix, BackTrackingRejectsConflictingGivens)
+{
+    // A solved grid with a second 1 in the first row, once with the last cell
+    // cleared and once full: the search skips givens, so neither may pass.
+    std::array<SudokuMatrix<3>::DataType, 81> cells{};
+    for (std::size_t index = 0; index < cells.size(); ++index)
+    {
+        const std::size_t row = index / 9;
+        cells[index] = static_cast<SudokuMatrix<3>::DataType>((row * 3 + row / 3 + index % 9) % 9 + 1);
+    }
+    cells[1] = cells[0];
+    for (const bool clearLast : {true, false})
+    {
+        if (clearLast)
+        {
+            cells[80] = 0;
+        }
+        BackTrackingSolver<3> solver{SudokuMatrix<3>{cells}};
+        const SolveResult result = solver.Solve(10'000'000);
+        EXPECT_EQ(result.status, SolveStatus::Unsolvable);
+        EXPECT_EQ(result.steps, 0u);
+        EXPECT_FALSE(solver.IsSolved());
+        solver.Reset(SudokuMatrix<3>{cells});
+        EXPECT_EQ(solver.Solve().status, SolveStatus::Unsolvable);
+
+        DynamicBackTrackingSolver dynamic{DynamicSudokuMatrix{std::vector<DynamicSudokuMatrix::DataType>(cells.begin(), cells.end()), 3}};
+        EXPECT_EQ(dynamic.Solve(10'000'000).status, SolveStatus::Unsolvable);
+        EXPECT_FALSE(dynamic.IsSolved());
+    }
+}
+
+TEST(SudokuMatrix, SolveHardSudokuPropagation)
+{
+    bool solved = SolveHardSudoku<3, PropagationSolver>();
+    EXPECT_TRUE(solved);
+}
+
+TEST(SudokuMatrix, PropagationExpandsFewerNodes)
+{
+    static constexpr std::array<SudokuMatrix<3>::DataType, 81> sudokuGame = {
+        0,0,0,0,0,0,0,0,0,
+        0,9,0,0,1,0,0,3,0,
+        0,0,6,0,2,0,7,0,0,
+        0,0,0,3,0,4,0,0,0,
+        2,1,0,0,0,0,0,9,8,
+        0,0,0,0,0,0,0,0,0,
+        0,0,2,5,0,6,4,0,0,
+        0,8,0,0,0,0,0,1,0,
+        0,0,0,0,0,0,0,0,0,
+    };
+    auto countSteps = [](auto &solver)
+    {
+        std::size_t steps = 0;
+        while (solver.Advance())
+        {
+            steps++;
+        }
+        return steps;
+    };
+    BackTrackingSolver<3> backTracking{sudokuGame};
+    PropagationSolver<3> propagation{sudokuGame};
+    std::size_t backTrackingSteps = countSteps(backTracking);
+    std::size_t propagationSteps = countSteps(propagation);
+    EXPECT_TRUE(propagation.IsSolved());
+    EXPECT_LT(propagationSteps * 100, backTrackingSteps);
+}
+
+TEST(SudokuMatrix, SolveEmptyBoardPropagation)
+{
+    PropagationSolver<4> solver{SudokuMatrix<4>{}};
+    while (solver.Advance())
+        ;
+    const auto &board = solver.GetBoard();
+    for (std::size_t i = 0; i < 16; ++i)
+    {
+        for (std::size_t j = 0; j < 16; ++j)
+        {
+            EXPECT_NE(board.GetValue(i, j), 0);
+        }
+    }
+    EXPECT_TRUE(solver.IsSolved());
+    EXPECT_TRUE(IsValidSudoku(board));
+}
+
+TEST(SudokuMatrix, SolveSudokuBand)
+{
+    if (!GetCpuFeatures().avx2)
+    {
+        GTEST_SKIP() << "BandSolver needs AVX2";
+    }
+    EXPECT_TRUE((CanBeSolved<3, BandSolver>()));
+}
+
+TEST(SudokuMatrix, SolveHardSudokuBand)
+{
+    if (!GetCpuFeatures().avx2)
+    {
+        GTEST_SKIP() << "BandSolver needs AVX2";
+    }
+    EXPECT_TRUE((SolveHardSudoku<3, BandSolver>()));
+}
+
+TEST(SudokuMatrix, SolveEmptyBoardBand)
+{
+    if (!GetCpuFeatures().avx2)
+    {
+        GTEST_SKIP() << "BandSolver needs AVX2";
+    }
+    BandSolver<3> solver{SudokuMatrix<3>{}};
+    while (solver.Advance(false))
+        ;
+    EXPECT_TRUE(solver.IsSolved());
+    EXPECT_TRUE(IsValidSudoku(solver.GetBoard()));
+}
+
+TEST(SudokuMatrix, BandRejectsUnsolvableBoards)
+{
+    if (!GetCpuFeatures().avx2)
+    {
+        GTEST_SKIP() << "BandSolver needs AVX2";
+    }
+    // Repeated given in the first row.
+    static constexpr std::array<SudokuMatrix<3>::DataType, 81> repeatedGame = {1, 1};
+    // The first cell has no candidate left.
+    static constexpr std::array<SudokuMatrix<3>::DataType, 81> blockedGame = {
+        0, 1, 2, 3, 4, 5, 6, 7, 8,
+        9, 0, 0, 0, 0, 0, 0, 0, 0};
+    for (const auto &game : {repeatedGame, blockedGame})
+    {
+        BandSolver<3> solver{game};
+        while (solver.Advance(false))
+            ;
+        EXPECT_FALSE(solver.IsSolved());
+        EXPECT_EQ(solver.GetStatus(), AdvanceResult::Finished);
+    }
+}
+
+TEST(SudokuMatrix, BandAgreesWithDlx)
+{
+    if (!GetCpuFeatures().avx2)
+    {
+        GTEST_SKIP() << "BandSolver needs AVX2";
+    }
+    pcg64 rng(7);
+    for (int i = 0; i < 200; ++i)
+    {
+        SudokuMatrix<3> game = CreateBoard<3>(0.35f, rng);
+        DLXSolver<3> dlx{game};
+        while (dlx.Advance(false))
+            ;
+        BandSolver<3> band{game};
+        while (band.Advance(false))
+            ;
+        ASSERT_EQ(band.IsSolved(), dlx.IsSolved());
+        if (band.IsSolved())
+        {
+            EXPECT_TRUE(IsValidSudoku(band.GetBoard()));
+            for (std::size_t cell = 0; cell < 81; ++cell)
+            {
+                EXPECT_NE(band.GetBoard().GetValue(cell), 0);
+                if (game.GetValue(cell) != 0)
+                {
+                    EXPECT_EQ(band.GetBoard().GetValue(cell), game.GetValue(cell));
+                }
+            }
+        }
+    }
+}
+
+TEST(SudokuMatrix, DlxInsertEveryStepMatchesFinalBoard)
+{
+    pcg64 rng(11);
+    for (int i = 0; i < 50; ++i)
+    {
+        SudokuMatrix<3> game = CreateBoard<3>(0.3f, rng);
+        DLXSolver<3> stepped{game};
+        while (stepped.Advance(true))
+            ;
+        DLXSolver<3> direct{game};
+        while (direct.Advance(false))
+            ;
+        ASSERT_EQ(stepped.IsSolved(), direct.IsSolved());
+        if (direct.IsSolved())
+        {
+            EXPECT_TRUE(stepped.GetBoard() == direct.GetBoard());
+        }
+    }
+}
+
+TEST(SudokuMatrix, DlxResetReusesSolver)
+{
+    pcg64 rng(5);
+    SudokuMatrix<3> first = CreateBoard<3>(0.3f, rng);
+    DLXSolver<3> reused{first};
+    for (int i = 0; i < 50; ++i)
+    {
+        SudokuMatrix<3> game = CreateBoard<3>(0.3f, rng);
+        reused.Reset(game);
+        while (reused.Advance(false))
+            ;
+        DLXSolver<3> fresh{game};
+        while (fresh.Advance(false))
+            ;
+        ASSERT_EQ(reused.IsSolved(), fresh.IsSolved());
+        EXPECT_TRUE(reused.GetBoard() == fresh.GetBoard());
+    }
+    // Repeated given in the first row.
+    static constexpr std::array<SudokuMatrix<3>::DataType, 81> repeatedGame = {1, 1};
+    reused.Reset(SudokuMatrix<3>{repeatedGame});
+    EXPECT_FALSE(reused.Advance(false));
+    EXPECT_FALSE(reused.IsSolved());
+    EXPECT_EQ(reused.GetStatus(), AdvanceResult::Finished);
+}
+
+TEST(SudokuMatrix, CountSolutionsEmptyBoard)
+{
+    // The 4x4 grid has 288 solutions.
+    // Below the limit the search unwinds, leaving the givens unsolved.
+    DLXSolver<2> dlx{SudokuMatrix<2>{}};
+    EXPECT_EQ(dlx.CountSolutions(1000), 288);
+    EXPECT_FALSE(dlx.IsSolved());
+    EXPECT_EQ(dlx.GetBoard(), SudokuMatrix<2>{});
+    BackTrackingSolver<2> backTracking{SudokuMatrix<2>{}};
+    EXPECT_EQ(backTracking.CountSolutions(1000), 288);
+    EXPECT_FALSE(backTracking.IsSolved());
+    EXPECT_EQ(backTracking.GetBoard(), SudokuMatrix<2>{});
+    DLXSolver<3> limited{SudokuMatrix<3>{}};
+    EXPECT_EQ(limited.CountSolutions(2), 2);
+    EXPECT_TRUE(limited.IsSolved());
+    EXPECT_TRUE(IsValidSudoku(limited.GetBoard()));
+}
+
+TEST(SudokuMatrix, CountSolutionsUniquePuzzle)
+{
+    static constexpr std::array<SudokuMatrix<3>::DataType, 81> sudokuGame = {
+        5, 3, 0, 0, 7, 0, 0, 0, 0,
+        6, 0, 0, 1, 9, 5, 0, 0, 0,
+        0, 9, 8, 0, 0, 0, 0, 6, 0,
+
+        8, 0, 0, 0, 6, 0, 0, 0, 3,
+        4, 0, 0, 8, 0, 3, 0, 0, 1,
+        7, 0, 0, 0, 2, 0, 0, 0, 6,
+
+        0, 6, 0, 0, 0, 0, 2, 8, 0,
+        0, 0, 0, 4, 1, 9, 0, 0, 5,
+        0, 0, 0, 0, 8, 0, 0, 7, 9};
+    DLXSolver<3> dlx{sudokuGame};
+    EXPECT_EQ(dlx.CountSolutions(2), 1);
+    EXPECT_FALSE(dlx.IsSolved());
+    EXPECT_EQ(dlx.GetStatus(), AdvanceResult::Finished);
+    EXPECT_EQ(dlx.GetBoard(), SudokuMatrix<3>{sudokuGame});
+    BackTrackingSolver<3> backTracking{sudokuGame};
+    EXPECT_EQ(backTracking.CountSolutions(2), 1);
+    EXPECT_FALSE(backTracking.IsSolved());
+    EXPECT_EQ(backTracking.GetBoard(), SudokuMatrix<3>{sudokuGame});
+    // With a limit of 1 the one solution is kept.
+    BackTrackingSolver<3> first{sudokuGame};
+    EXPECT_EQ(first.CountSolutions(1), 1);
+    EXPECT_TRUE(first.IsSolved());
+    EXPECT_TRUE(IsValidSudoku(first.GetBoard()));
+
+    // Dropping givens makes the puzzle ambiguous.
+    std::array<SudokuMatrix<3>::DataType, 81> ambiguousGame = sudokuGame;
+    std::fill(ambiguousGame.begin(), ambiguousGame.begin() + 27, 0);
+    DLXSolver<3> ambiguousDlx{ambiguousGame};
+    EXPECT_EQ(ambiguousDlx.CountSolutions(2), 2);
+    BackTrackingSolver<3> ambiguousBackTracking{ambiguousGame};
+    EXPECT_EQ(ambiguousBackTracking.CountSolutions(2), 2);
+}
+
+TEST(SudokuMatrix, CountSolutionsAgreesBetweenSolvers)
+{
+    pcg64 rng(13);
+    for (int i = 0; i < 50; ++i)
+    {
+        SudokuMatrix<2> game = CreateBoard<2>(0.3f, rng);
+        DLXSolver<2> dlx{game};
+        BackTrackingSolver<2> backTracking{game};
+        const std::size_t count = dlx.CountSolutions(1000);
+        EXPECT_EQ(backTracking.CountSolutions(1000), count);
+        EXPECT_FALSE(dlx.IsSolved());
+        EXPECT_FALSE(backTracking.IsSolved());
+    }
+}
+
+TEST(SudokuMatrix, CountSolutionsUnsolvable)
+{
+    // The first cell has no candidate left.
+    static constexpr std::array<SudokuMatrix<3>::DataType, 81> blockedGame = {
+        0, 1, 2, 3, 4, 5, 6, 7, 8,
+        9, 0, 0, 0, 0, 0, 0, 0, 0};
+    DLXSolver<3> dlx{blockedGame};
+    EXPECT_EQ(dlx.CountSolutions(2), 0);
+    EXPECT_FALSE(dlx.IsSolved());
+    BackTrackingSolver<3> backTracking{blockedGame};
+    EXPECT_EQ(backTracking.CountSolutions(2), 0);
+    EXPECT_FALSE(backTracking.IsSolved());
+    static constexpr std::array<SudokuMatrix<3>::DataType, 81> repeatedGame = {1, 1};
+    DLXSolver<3> repeated{repeatedGame};
+    EXPECT_EQ(repeated.CountSolutions(2), 0);
+}
+
+TEST(SudokuMatrix, CountSolutionsZeroLimit)
+{
+    DLXSolver<3> dlx{SudokuMatrix<3>{}};
+    EXPECT_EQ(dlx.CountSolutions(0), 0);
+    EXPECT_EQ(dlx.GetStatus(), AdvanceResult::Continue);
+    EXPECT_EQ(dlx.Solve().status, SolveStatus::Solved);
+    BackTrackingSolver<3> backTracking{SudokuMatrix<3>{}};
+    EXPECT_EQ(backTracking.CountSolutions(0), 0);
+    EXPECT_EQ(backTracking.GetStatus(), AdvanceResult::Continue);
+    EXPECT_EQ(backTracking.Solve().status, SolveStatus::Solved);
+}
+
+template <template <std::size_t> class Solver>
+inline void ExpectSolveMatchesAdvance(const SudokuMatrix<3> &puzzle)
+{
+    Solver<3> stepped{puzzle};
+    std::uint64_t steps = 0;
+    while (stepped.Advance())
+    {
+        steps++;
+    }
+    const SolveStatus expected = stepped.IsSolved() ? SolveStatus::Solved : SolveStatus::Unsolvable;
+    Solver<3> bulk{puzzle};
+    const SolveResult result = bulk.Solve();
+    EXPECT_EQ(result.status, expected);
+    EXPECT_EQ(result.steps, steps);
+    EXPECT_TRUE(bulk.GetBoard() == stepped.GetBoard());
+    EXPECT_EQ(bulk.GetStats(), stepped.GetStats());
+
+    Solver<3> resumed{puzzle};
+    const SolveResult first = resumed.Solve(steps / 2);
+    EXPECT_EQ(first.status, SolveStatus::BudgetExhausted);
+    EXPECT_EQ(first.steps, steps / 2);
+    const SolveResult second = resumed.Solve(SolveLimits{NoStepLimit, std::chrono::steady_clock::now() + std::chrono::hours(1)});
+    EXPECT_EQ(second.status, expected);
+    EXPECT_EQ(first.steps + second.steps, steps);
+
+    // A stopped search resumes where it left off.
+    Solver<3> limited{puzzle};
+    const SolveResult expired = limited.Solve(SolveLimits{NoStepLimit, std::chrono::steady_clock::now() - std::chrono::seconds(1)});
+    EXPECT_EQ(expired.status, SolveStatus::DeadlineExceeded);
+    EXPECT_EQ(expired.steps, 0);
+    std::stop_source stopSource;
+    const SolveResult running = limited.Solve(SolveLimits{steps / 2, NoDeadline, stopSource.get_token(), 1});
+    EXPECT_EQ(running.steps, steps / 2);
+    stopSource.request_stop();
+    const SolveResult cancelled = limited.Solve(SolveLimits{NoStepLimit, NoDeadline, stopSource.get_token()});
+    EXPECT_EQ(cancelled.status, SolveStatus::Cancelled);
+    EXPECT_EQ(cancelled.steps, 0);
+    const SolveResult rest = limited.Solve();
+    EXPECT_EQ(rest.status, expected);
+    EXPECT_EQ(running.steps + rest.steps, steps);
+    EXPECT_TRUE(limited.GetBoard() == stepped.GetBoard());
+
+    // A finished search reports its outcome even past its limits.
+    const SolveResult done = limited.Solve(SolveLimits{NoStepLimit, std::chrono::steady_clock::now() - std::chrono::seconds(1), stopSource.get_token()});
+    EXPECT_EQ(done.status, expected);
+    EXPECT_EQ(done.steps, 0);
+}
+
+TEST(SudokuMatrix, SolveMatchesAdvance)
+{
+    static constexpr std::array<SudokuMatrix<3>::DataType, 81> sudokuGame = {
+        0,0,0,0,0,0,0,0,0,
+        0,9,0,0,1,0,0,3,0,
+        0,0,6,0,2,0,7,0,0,
+        0,0,0,3,0,4,0,0,0,
+        2,1,0,0,0,0,0,9,8,
+        0,0,0,0,0,0,0,0,0,
+        0,0,2,5,0,6,4,0,0,
+        0,8,0,0,0,0,0,1,0,
+        0,0,0,0,0,0,0,0,0,
+    };
+    // Both empty cells of the first row can only hold a 9.
+    static constexpr std::array<SudokuMatrix<3>::DataType, 81> deadEndGame = {
+        1, 2, 3, 4, 5, 6, 7, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 8, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 8};
+    for (const auto &game : {sudokuGame, deadEndGame})
+    {
+        const SudokuMatrix<3> puzzle{game};
+        ExpectSolveMatchesAdvance<BackTrackingSolver>(puzzle);
+        ExpectSolveMatchesAdvance<DLXSolver>(puzzle);
+        ExpectSolveMatchesAdvance<PropagationSolver>(puzzle);
+        if (GetCpuFeatures().avx2)
+        {
+            ExpectSolveMatchesAdvance<BandSolver>(puzzle);
+        }
+    }
+}
+
+template <template <std::size_t> class Solver>
+inline SearchStats SolveAndGetStats(const SudokuMatrix<3> &puzzle)
+{
+    Solver<3> solver{puzzle};
+    EXPECT_EQ(solver.Solve().status, SolveStatus::Solved);
+    const SearchStats stats = solver.GetStats();
+    solver.Reset(puzzle);
+    EXPECT_EQ(solver.GetStats(), Solver<3>{puzzle}.GetStats());
+    return stats;
+}
+
+TEST(SudokuMatrix, CountsSearchStats)
+{
+    static constexpr std::array<SudokuMatrix<3>::DataType, 81> sudokuGame = {
+        0,0,0,0,0,0,0,0,0,
+        0,9,0,0,1,0,0,3,0,
+        0,0,6,0,2,0,7,0,0,
+        0,0,0,3,0,4,0,0,0,
+        2,1,0,0,0,0,0,9,8,
+        0,0,0,0,0,0,0,0,0,
+        0,0,2,5,0,6,4,0,0,
+        0,8,0,0,0,0,0,1,0,
+        0,0,0,0,0,0,0,0,0,
+    };
+    const SudokuMatrix<3> puzzle{sudokuGame};
+    const SearchStats backTracking = SolveAndGetStats<BackTrackingSolver>(puzzle);
+    const SearchStats dlx = SolveAndGetStats<DLXSolver>(puzzle);
+    const SearchStats propagation = SolveAndGetStats<PropagationSolver>(puzzle);
+    if constexpr (!SearchStatsEnabled)
+    {
+        EXPECT_EQ(backTracking, SearchStats{});
+        EXPECT_EQ(dlx, SearchStats{});
+        EXPECT_EQ(propagation, SearchStats{});
+        return;
+    }
+    // Every dead end but the ones met on the way to the solution is undone, so
+    // each node tries at least one candidate.
+    for (const SearchStats &stats : {backTracking, dlx, propagation})
+    {
+        EXPECT_GT(stats.nodes, 0u);
+        EXPECT_GT(stats.backtracks, 0u);
+        EXPECT_GE(stats.candidatesTried + stats.backtracks, stats.nodes);
+        // Only the 63 open cells count towards the depth.
+        EXPECT_LT(stats.maxDepth, 63u);
+    }
+    // The cell-order search expands every open cell on its way to the last.
+    EXPECT_EQ(backTracking.maxDepth, 62u);
+    EXPECT_EQ(backTracking.eliminations, 0u);
+    EXPECT_EQ(backTracking.coverOperations, 0u);
+    EXPECT_GT(dlx.coverOperations, 0u);
+    EXPECT_EQ(dlx.eliminations, 0u);
+    EXPECT_GT(propagation.eliminations, 0u);
+    EXPECT_EQ(propagation.coverOperations, 0u);
+    // Propagation prunes most of the tree the plain backtracker walks.
+    EXPECT_LT(propagation.nodes, backTracking.nodes);
+    if (GetCpuFeatures().avx2)
+    {
+        const SearchStats band = SolveAndGetStats<BandSolver>(puzzle);
+        EXPECT_GT(band.nodes, 0u);
+        EXPECT_GT(band.eliminations, 0u);
+    }
+
+    // Givens plus propagation alone solve the classic puzzle.
+    static constexpr std::array<SudokuMatrix<3>::DataType, 81> easyGame = {
+        5, 3, 0, 0, 7, 0, 0, 0, 0,
+        6, 0, 0, 1, 9, 5, 0, 0, 0,
+        0, 9, 8, 0, 0, 0, 0, 6, 0,
+        8, 0, 0, 0, 6, 0, 0, 0, 3,
+        4, 0, 0, 8, 0, 3, 0, 0, 1,
+        7, 0, 0, 0, 2, 0, 0, 0, 6,
+        0, 6, 0, 0, 0, 0, 2, 8, 0,
+        0, 0, 0, 4, 1, 9, 0, 0, 5,
+        0, 0, 0, 0, 8, 0, 0, 7, 9};
+    const SearchStats easy = SolveAndGetStats<PropagationSolver>(SudokuMatrix<3>{easyGame});
+    EXPECT_EQ(easy.nodes, 0u);
+    EXPECT_EQ(easy.backtracks, 0u);
+    EXPECT_GT(easy.eliminations, 0u);
+}
+
+TEST(SudokuMatrix, DynamicSolveStopsOnLimits)
+{
+    DynamicBackTrackingSolver solver{3};
+    std::stop_source stopSource;
+    stopSource.request_stop();
+    const SolveResult cancelled = solver.Solve(SolveLimits{NoStepLimit, NoDeadline, stopSource.get_token()});
+    EXPECT_EQ(cancelled.status, SolveStatus::Cancelled);
+    EXPECT_EQ(cancelled.steps, 0);
+    const SolveResult expired = solver.Solve(SolveLimits{NoStepLimit, std::chrono::steady_clock::now()});
+    EXPECT_EQ(expired.status, SolveStatus::DeadlineExceeded);
+    EXPECT_EQ(solver.Solve().status, SolveStatus::Solved);
+    EXPECT_TRUE(IsValidSudoku(solver.GetBoard()));
+}
+
+// Valid solved grid for any box size, with every `stride`-th cell erased.
+static std::vector<AnySolver::DataType> CreatePatternBoard(std::size_t size, std::size_t stride)
+{
+    const std::size_t rowSize = size * size;
+    std::vector<AnySolver::DataType> cells(rowSize * rowSize);
+    for (std::size_t row = 0; row < rowSize; ++row)
+    {
+        for (std::size_t col = 0; col < rowSize; ++col)
+        {
+            const std::size_t index = row * rowSize + col;
+            const std::size_t value = (row * size + row / size + col) % rowSize + 1;
+            cells[index] = index % stride == 0 ? 0 : static_cast<AnySolver::DataType>(value);
+        }
+    }
+    return cells;
+}
+
+TEST(AnySolver, DispatchesToStaticSolvers)
+{
+    for (std::size_t size = MinStaticBoardSize; size <= 4; ++size)
+    {
+        const std::vector<AnySolver::DataType> cells = CreatePatternBoard(size, 3);
+        for (SolverKind kind : {SolverKind::BackTracking, SolverKind::Dlx, SolverKind::Propagation})
+        {
+            std::optional<AnySolver> solver = AnySolver::Create(size, kind, cells);
+            ASSERT_TRUE(solver.has_value());
+            EXPECT_TRUE(solver->IsStatic());
+            EXPECT_EQ(solver->Solve(10'000'000).status, SolveStatus::Solved);
+            EXPECT_TRUE(solver->IsSolved());
+            EXPECT_EQ(solver->GetValue(0, 1), cells[1]);
+        }
+    }
+    static constexpr std::array<AnySolver::DataType, 81> blockedGame = {
+        0, 1, 2, 3, 4, 5, 6, 7, 8,
+        9, 0, 0, 0, 0, 0, 0, 0, 0};
+    std::optional<AnySolver> band = AnySolver::Create(3, SolverKind::Band, blockedGame);
+    ASSERT_EQ(band.has_value(), GetSimdLevel() >= SimdLevel::Avx2);
+    if (band.has_value())
+    {
+        EXPECT_EQ(band->Solve(1'000).status, SolveStatus::Unsolvable);
+    }
+    EXPECT_FALSE(AnySolver::Create(4, SolverKind::Band, CreatePatternBoard(4, 3)).has_value());
+}
+
+TEST(AnySolver, FallsBackToDynamicSolver)
+{
+    const std::vector<AnySolver::DataType> cells = CreatePatternBoard(8, 7);
+    std::optional<AnySolver> solver = AnySolver::Create(8, SolverKind::Dlx, cells);
+    ASSERT_TRUE(solver.has_value());
+    EXPECT_FALSE(solver->IsStatic());
+    EXPECT_EQ(solver->GetSize(), 8);
+    EXPECT_EQ(solver->Solve(10'000'000).status, SolveStatus::Solved);
+    EXPECT_EQ(solver->GetValue(0, 0), 1);
+}
+
+TEST(AnySolver, SolvesBoardsAtTheDynamicLimit)
+{
+    static_assert(MaxDynamicBoardSize == 15);
+    const std::size_t size = MaxDynamicBoardSize;
+    const std::vector<AnySolver::DataType> cells = CreatePatternBoard(size, 11);
+    std::optional<AnySolver> solver = AnySolver::Create(size, SolverKind::Dlx, cells);
+    ASSERT_TRUE(solver.has_value());
+    EXPECT_FALSE(solver->IsStatic());
+    EXPECT_EQ(solver->Solve(10'000'000).status, SolveStatus::Solved);
+    const std::size_t rowSize = size * size;
+    for (std::size_t row = 0; row < rowSize; ++row)
+    {
+        for (std::size_t col = 0; col < rowSize; ++col)
+        {
+            const std::size_t expected = (row * size + row / size + col) % rowSize + 1;
+            ASSERT_EQ(solver->GetValue(row, col), expected);
+        }
+    }
+    EXPECT_FALSE(AnySolver::Create(size + 1, SolverKind::Dlx, CreatePatternBoard(size + 1, 11)).has_value());
+}
+
+TEST(AnySolver, RejectsInvalidInput)
+{
+    EXPECT_FALSE(AnySolver::Create(0, SolverKind::Dlx, {}).has_value());
+    EXPECT_FALSE(AnySolver::Create(3, SolverKind::Dlx, CreatePatternBoard(2, 3)).has_value());
+    EXPECT_FALSE(AnySolver::Create(MaxDynamicBoardSize + 1, SolverKind::Dlx, {}).has_value());
+    // Values above size^2, on a static and on a dynamic board.
+    for (const std::size_t size : {std::size_t{3}, std::size_t{8}})
+    {
+        std::vector<AnySolver::DataType> cells = CreatePatternBoard(size, 3);
+        cells[0] = static_cast<AnySolver::DataType>(size * size + 1);
+        EXPECT_FALSE(AnySolver::Create(size, SolverKind::Dlx, cells).has_value());
+        cells[0] = 255;
+        EXPECT_FALSE(AnySolver::Create(size, SolverKind::BackTracking, cells).has_value());
+    }
+    EXPECT_EQ(ParseSolverKind("dlx"), SolverKind::Dlx);
+    EXPECT_FALSE(ParseSolverKind("simplex").has_value());
+}
+
+TEST(AnySolver, VisitBoardSize)
+{
+    for (std::size_t size = 0; size < 10; ++size)
+    {
+        const std::size_t visited = VisitBoardSize(
+            size,
+            []<std::size_t N>(std::integral_constant<std::size_t, N>)
+            { return SudokuMatrix<N>::MatrixIndex(N * N - 1, N * N - 1) + 1; },
+            []
+            { return std::size_t{0}; });
+        const bool isStatic = size >= MinStaticBoardSize && size <= MaxStaticBoardSize;
+        EXPECT_EQ(visited, isStatic ? size * size * size * size : 0);
+    }
+}
+
+TEST(FastBitset, FindLSBAcrossWords)
+{
+    FastBitset<300> bits;
+    EXPECT_EQ(bits.findLSB(), 300);
+    bits.set(200);
+    EXPECT_EQ(bits.findLSB(), 200);
+    bits.set(70);
+    EXPECT_EQ(bits.findLSB(), 70);
+    bits.set(5);
+    EXPECT_EQ(bits.findLSB(), 5);
+    EXPECT_EQ(bits.count(), 3);
+    EXPECT_EQ((~FastBitset<300>{}).count(), 300);
+}
+
+// The AVX2 level enables every extension the AVX2 target attribute does.
+TEST(CpuFeatures, Avx2ImpliesTargetExtensions)
+{
+    const CpuFeatures &features = GetCpuFeatures();
+    if (features.avx2)
+    {
+        EXPECT_TRUE(features.bmi1);
+        EXPECT_TRUE(features.bmi2);
+        EXPECT_TRUE(features.popcnt);
+        EXPECT_TRUE(features.lzcnt);
+    }
+    EXPECT_TRUE(!features.avx512 || features.avx2);
+}
+
+TEST(BitKernels, VariantsMatchScalar)
+{
+    pcg64 rng(3);
+    std::vector<std::uint64_t> words(37);
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512})
+    {
+        if (!IsSupported(level, GetCpuFeatures()))
+        {
+            continue;
+        }
+        const BitKernels::KernelTable kernels = BitKernels::GetKernels(level);
+        EXPECT_EQ(kernels.level, level);
+        for (std::size_t count = 0; count <= words.size(); ++count)
+        {
+            std::fill(words.begin(), words.end(), 0);
+            EXPECT_EQ(kernels.findFirstSet(words.data(), count), count * 64);
+            EXPECT_EQ(kernels.popCount(words.data(), count), 0);
+            for (std::size_t i = count / 2; i < count; ++i)
+            {
+                words[i] = rng() & rng();
+            }
+            EXPECT_EQ(kernels.findFirstSet(words.data(), count), BitKernels::FindFirstSetScalar(words.data(), count));
+            EXPECT_EQ(kernels.popCount(words.data(), count), BitKernels::PopCountScalar(words.data(), count));
+        }
+    }
+}
+
+TEST(PuzzleIO, ParsesPuzzleLines)
+{
+    const std::string line = "1....7.9..3..2...8..96..5....53..9...1..8...26....4...3......1..4......7..7...3..";
+    const auto puzzle = ParsePuzzle<3>(line);
+    ASSERT_TRUE(puzzle.has_value());
+    EXPECT_EQ(puzzle->GetValue(0, 0), 1);
+    EXPECT_EQ(puzzle->GetValue(0, 1), 0);
+    EXPECT_EQ(puzzle->GetValue(0, 5), 7);
+    EXPECT_EQ(puzzle->GetValue(8, 6), 3);
+    EXPECT_EQ(FormatPuzzle(*puzzle), line);
+
+    std::string zeros = line;
+    std::replace(zeros.begin(), zeros.end(), '.', '0');
+    EXPECT_TRUE(ParsePuzzle<3>(zeros) == puzzle);
+    EXPECT_TRUE(ParsePuzzle<3>(line + ",solution") == puzzle);
+    EXPECT_TRUE(ParsePuzzle<3>(line + " 4.5") == puzzle);
+    EXPECT_FALSE(ParsePuzzle<3>(line.substr(1)).has_value());
+    EXPECT_FALSE(ParsePuzzle<3>(line + "1").has_value());
+    EXPECT_FALSE(ParsePuzzle<3>("A" + line.substr(1)).has_value());
+    EXPECT_FALSE(ParsePuzzle<3>("x" + line.substr(1)).has_value());
+
+    // 16x16 digits go on with letters.
+    std::string large(256, '.');
+    large[0] = 'G';
+    large[1] = 'a';
+    const auto largePuzzle = ParsePuzzle<4>(large);
+    ASSERT_TRUE(largePuzzle.has_value());
+    EXPECT_EQ(largePuzzle->GetValue(0, 0), 16);
+    EXPECT_EQ(largePuzzle->GetValue(0, 1), 10);
+    EXPECT_EQ(FormatPuzzle(*largePuzzle).substr(0, 3), "GA.");
+    large[2] = 'H';
+    EXPECT_FALSE(ParsePuzzle<4>(large).has_value());
+}
+
+TEST(PuzzleIO, LoadsPuzzleStreams)
+{
+    std::istringstream corpus("# comment\n"
+                              "\n"
+                              "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..\r\n"
+                              "  1.......2.9.4...5...6...7...5.9.3.......7.......85..4.7.....6...3...9.8...2.....1\n");
+    const auto puzzles = LoadPuzzles<3>(corpus);
+    ASSERT_TRUE(puzzles.has_value());
+    ASSERT_EQ(puzzles->size(), 2);
+    EXPECT_EQ((*puzzles)[0].GetValue(0, 0), 8);
+    EXPECT_EQ((*puzzles)[1].GetValue(8, 8), 1);
+    for (const SudokuMatrix<3> &puzzle : *puzzles)
+    {
+        DLXSolver<3> solver{puzzle};
+        EXPECT_EQ(solver.CountSolutions(2), 1);
+    }
+
+    std::istringstream broken("8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..\n"
+                              "not a puzzle\n");
+    EXPECT_FALSE(LoadPuzzles<3>(broken).has_value());
+    EXPECT_FALSE(LoadPuzzleFile<3>("does/not/exist.txt").has_value());
+}
+
+TEST(PuzzleIO, SimdParserMatchesParseCell)
+{
+    if (!GetCpuFeatures().avx2)
+    {
+        GTEST_SKIP() << "AVX2 not supported";
+    }
+    const std::string alphabet = "0123456789.ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz:/@[`{ #\xff";
+    pcg64 rng(21);
+    for (std::size_t count : {32, 81, 256})
+    {
+        for (std::size_t trial = 0; trial < 2000; ++trial)
+        {
+            std::string text(count, '.');
+            // Mostly clean lines, so that the valid path is exercised too.
+            const std::size_t dirty = trial % 4 == 0 ? alphabet.size() : 37;
+            for (char &cell : text)
+            {
+                cell = alphabet[rng() % dirty];
+            }
+            const std::uint8_t maxValue = count == 81 ? 9 : count == 256 ? 16 : 36;
+            std::vector<std::uint8_t> cells(count);
+            const bool valid = ParseCellsAvx2(text.data(), count, cells.data(), maxValue);
+            bool expected = true;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const auto value = maxValue == 9 ? ParseCell<3>(text[i]) : maxValue == 16 ? ParseCell<4>(text[i]) : ParseCell<6>(text[i]);
+                if (!value.has_value())
+                {
+                    expected = false;
+                    continue;
+                }
+                ASSERT_EQ(cells[i], *value) << text << " at " << i;
+            }
+            ASSERT_EQ(valid, expected) << text;
+        }
+    }
+}
+
+TEST(PuzzleIO, ReadsAndWritesMappedFiles)
+{
+    const std::string first = "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..";
+    const std::string second = "1.......2.9.4...5...6...7...5.9.3.......7.......85..4.7.....6...3...9.8...2.....1";
+    const std::vector<SudokuMatrix<3>> puzzles = {*ParsePuzzle<3>(first), *ParsePuzzle<3>(second)};
+    DLXSolver<3> solver{puzzles[1]};
+    ASSERT_EQ(solver.Solve().status, SolveStatus::Solved);
+    std::ostringstream text;
+    {
+        PuzzleWriter<3> writer(text, 100);
+        writer.Write(puzzles[0]);
+        EXPECT_TRUE(text.str().empty());
+        writer.Write(puzzles[1], solver.GetBoard());
+        // Past 100 bytes the buffer goes out.
+        EXPECT_EQ(text.str().size(), 82 + 164);
+    }
+    EXPECT_EQ(text.str(), first + "\n" + second + "," + FormatPuzzle(solver.GetBoard()) + "\n");
+    std::ostringstream noted;
+    {
+        PuzzleWriter<3> writer(noted);
+        writer.Write(puzzles[0], "unsolvable");
+    }
+    EXPECT_EQ(noted.str(), first + " unsolvable\n");
+    EXPECT_TRUE(*ParsePuzzle<3>(std::string_view(noted.str()).substr(0, noted.str().size() - 1)) == puzzles[0]);
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "sudoku_puzzle_io_test.txt";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "# header\r\n\r\n"
+             << text.str();
+    }
+    const auto loaded = LoadPuzzleFile<3>(path);
+    ASSERT_TRUE(loaded.has_value());
+    ASSERT_EQ(loaded->size(), 2);
+    EXPECT_TRUE((*loaded)[0] == puzzles[0]);
+    EXPECT_TRUE((*loaded)[1] == puzzles[1]);
+
+    const std::optional<MappedFile> file = MappedFile::Open(path);
+    ASSERT_TRUE(file.has_value());
+    EXPECT_EQ(file->GetView().substr(0, 8), "# header");
+    // The reader stops at the short fifth line.
+    const std::string broken = std::string(file->GetView()) + "12345\n" + first;
+    PuzzleReader<3> reader(broken);
+    EXPECT_TRUE(reader.Next().has_value());
+    EXPECT_TRUE(reader.Next().has_value());
+    EXPECT_FALSE(reader.Next().has_value());
+    EXPECT_TRUE(reader.Failed());
+    EXPECT_EQ(reader.GetLineNumber(), 5);
+    EXPECT_FALSE(reader.Next().has_value());
+
+    {
+        std::ofstream empty(path, std::ios::trunc);
+    }
+    const std::optional<MappedFile> emptyFile = MappedFile::Open(path);
+    ASSERT_TRUE(emptyFile.has_value());
+    EXPECT_TRUE(emptyFile->GetView().empty());
+    std::filesystem::remove(path);
+    EXPECT_FALSE(MappedFile::Open(path).has_value());
+}
+
+TEST(CommandLine, SplitsAndParsesOptions)
+{
+    static_assert(SplitOption("--size=4").name == "--size");
+    static_assert(SplitOption("--size=4").value == "4");
+    static_assert(SplitOption("--output=a=b").value == "a=b");
+    static_assert(SplitOption("puzzles.txt").name == "puzzles.txt");
+    static_assert(SplitOption("puzzles.txt").value.empty());
+    EXPECT_EQ(ParseNumber<std::size_t>("42"), 42);
+    EXPECT_FALSE(ParseNumber<std::size_t>("").has_value());
+    EXPECT_FALSE(ParseNumber<std::size_t>("4x").has_value());
+    EXPECT_FALSE(ParseNumber<std::uint8_t>("256").has_value());
+    char program[] = "cli";
+    char help[] = "--help";
+    char *argv[] = {program, help};
+    EXPECT_TRUE(HasArgument(2, argv, "--help"));
+    EXPECT_FALSE(HasArgument(1, argv, "--help"));
+    EXPECT_FALSE(HasArgument(2, argv, "cli"));
+}
+
+template <std::size_t N>
+static void ExpectPackRoundTrip(pcg64 &rng)
+{
+    std::uniform_real_distribution<float> keep(0.0f, 1.0f);
+    std::vector<SudokuMatrix<N>> boards;
+    for (std::size_t i = 0; i < 8; ++i)
+    {
+        std::array<typename SudokuMatrix<N>::DataType, N * N * N * N> cells = CreateRandomGrid<N>(rng).GetData();
+        for (auto &value : cells)
+        {
+            value = keep(rng) < 0.5f ? value : 0;
+        }
+        boards.emplace_back(cells);
+    }
+    std::vector<std::uint8_t> packed(boards.size() * PackedBoard<N>::Bytes);
+    PackBoards<N>(boards, packed.data());
+    const auto unpacked = UnpackBoards<N>(packed.data(), boards.size());
+    ASSERT_TRUE(unpacked.has_value());
+    EXPECT_TRUE(*unpacked == boards);
+}
+
+TEST(PuzzleArchive, PacksCells)
+{
+    static_assert(PackedBoard<3>::Bytes == 41);
+    static_assert(PackedBoard<4>::BitsPerCell == 5);
+    static_assert(PackedBoard<5>::Bytes == 391);
+    pcg64 rng(31);
+    ExpectPackRoundTrip<2>(rng);
+    ExpectPackRoundTrip<3>(rng);
+    ExpectPackRoundTrip<4>(rng);
+    ExpectPackRoundTrip<5>(rng);
+
+    // Four bits can hold values a 9x9 board cannot.
+    std::array<std::uint8_t, PackedBoard<3>::Bytes> packed{};
+    EXPECT_TRUE(UnpackBoard<3>(packed.data()).has_value());
+    packed[7] = 0xA0;
+    EXPECT_FALSE(UnpackBoard<3>(packed.data()).has_value());
+}
+
+TEST(PuzzleArchive, ReadsRecordsInPlace)
+{
+    pcg64 rng(32);
+    std::vector<SudokuMatrix<3>> puzzles;
+    std::vector<SudokuMatrix<3>> solutions;
+    for (std::size_t i = 0; i < 5000; ++i)
+    {
+        solutions.push_back(CreateRandomGrid<3>(rng));
+        puzzles.push_back(CreateBoard<3>(0.3f, rng));
+    }
+    std::ostringstream bare;
+    ASSERT_TRUE(WritePuzzleArchive<3>(bare, puzzles));
+    EXPECT_EQ(bare.str().size(), PuzzleArchiveFormat::HeaderSize + 5000 * 41);
+    const std::string bytes = bare.str();
+    const auto archive = PuzzleArchive<3>::Parse(bytes);
+    ASSERT_TRUE(archive.has_value());
+    EXPECT_EQ(archive->GetCount(), 5000);
+    EXPECT_FALSE(archive->HasSolutions());
+    EXPECT_TRUE(archive->GetPuzzle(4321) == puzzles[4321]);
+    EXPECT_TRUE(archive->GetPuzzles() == puzzles);
+
+    // Other box sizes, versions, flags and truncated files are refused.
+    EXPECT_FALSE(PuzzleArchive<4>::Parse(bytes).has_value());
+    EXPECT_FALSE(PuzzleArchive<3>::Parse(std::string_view(bytes).substr(0, bytes.size() - 1)).has_value());
+    for (const std::size_t offset : {0, 4, 8, 12})
+    {
+        std::string corrupt = bytes;
+        corrupt[offset] ^= 0x40;
+        EXPECT_FALSE(PuzzleArchive<3>::Parse(corrupt).has_value()) << offset;
+    }
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "sudoku_puzzle_archive_test.sdkp";
+    ASSERT_TRUE(SavePuzzleArchive<3>(path, puzzles, solutions));
+    {
+        const auto mapped = PuzzleArchive<3>::Open(path);
+        ASSERT_TRUE(mapped.has_value());
+        ASSERT_TRUE(mapped->HasSolutions());
+        EXPECT_TRUE(mapped->GetPuzzle(17) == puzzles[17]);
+        EXPECT_TRUE(mapped->GetSolution(4999) == solutions[4999]);
+    }
+    EXPECT_TRUE(LoadPuzzleArchive<3>(path) == puzzles);
+    std::filesystem::remove(path);
+    EXPECT_FALSE(LoadPuzzleArchive<3>(path).has_value());
+}
+
+static std::size_t CountClues(const SudokuMatrix<3> &puzzle)
+{
+    return static_cast<std::size_t>(std::count_if(puzzle.GetData().begin(), puzzle.GetData().end(), [](auto value)
+                                                  { return value != 0; }));
+}
+
+TEST(PuzzleGenerator, CreatesRandomGrids)
+{
+    pcg64 rng(11);
+    const SudokuMatrix<3> first = CreateRandomGrid<3>(rng);
+    EXPECT_EQ(CountClues(first), 81);
+    EXPECT_TRUE(IsValidSudoku(first));
+    EXPECT_FALSE(CreateRandomGrid<3>(rng) == first);
+    const SudokuMatrix<5> large = CreateRandomGrid<5>(rng);
+    EXPECT_TRUE(std::none_of(large.GetData().begin(), large.GetData().end(), [](auto value)
+                             { return value == 0; }));
+    EXPECT_TRUE(IsValidSudoku(large));
+}
+
+TEST(PuzzleGenerator, GeneratesMinimalUniquePuzzles)
+{
+    pcg64 rng(12);
+    for (std::size_t i = 0; i < 20; ++i)
+    {
+        const auto puzzle = GeneratePuzzle<3>(rng);
+        ASSERT_TRUE(puzzle.has_value());
+        DLXSolver<3> solver{*puzzle};
+        ASSERT_EQ(solver.CountSolutions(2), 1);
+        // Every remaining clue is needed.
+        for (std::size_t cell = 0; cell < 81; ++cell)
+        {
+            if (puzzle->GetValue(cell) == 0)
+            {
+                continue;
+            }
+            SudokuMatrix<3> loosened = *puzzle;
+            loosened.RemoveValue(cell / 9, cell % 9);
+            DLXSolver<3> check{loosened};
+            EXPECT_EQ(check.CountSolutions(2), 2);
+        }
+    }
+}
+
+TEST(PuzzleGenerator, MeetsTargets)
+{
+    pcg64 rng(13);
+    GeneratorOptions options;
+    options.targetClues = 40;
+    const auto puzzle = GeneratePuzzle<3>(rng, options);
+    ASSERT_TRUE(puzzle.has_value());
+    EXPECT_EQ(CountClues(*puzzle), 40);
+    DLXSolver<3> solver{*puzzle};
+    EXPECT_EQ(solver.CountSolutions(2), 1);
+
+    options.targetClues = 0;
+    for (const PuzzleDifficulty difficulty : {PuzzleDifficulty::Singles, PuzzleDifficulty::Guesses})
+    {
+        options.difficulty = difficulty;
+        const auto rated = GeneratePuzzle<3>(rng, options);
+        ASSERT_TRUE(rated.has_value());
+        EXPECT_EQ(RateDifficulty<3>(*rated), difficulty);
+    }
+
+    pcg64 same(13);
+    options.targetClues = 40;
+    options.difficulty.reset();
+    EXPECT_TRUE(GeneratePuzzle<3>(same, options) == puzzle);
+}
+
+TEST(LatencyHistogram, BucketsKeepRelativePrecision)
+{
+    pcg64 rng(7);
+    for (std::size_t i = 0; i < 100000; ++i)
+    {
+        const std::uint64_t value = rng() >> (rng() % 64);
+        const std::size_t index = LatencyHistogram::BucketIndex(value);
+        ASSERT_LT(index, LatencyHistogram::BucketCount);
+        const std::uint64_t upper = LatencyHistogram::BucketUpperBound(index);
+        EXPECT_GE(upper, value);
+        EXPECT_LE(static_cast<double>(upper - value), static_cast<double>(value) / 64.0);
+        if (index != 0)
+        {
+            EXPECT_LT(LatencyHistogram::BucketUpperBound(index - 1), value);
+        }
+    }
+    EXPECT_EQ(LatencyHistogram::BucketIndex(std::numeric_limits<std::uint64_t>::max()), LatencyHistogram::BucketCount - 1);
+}
+
+TEST(LatencyHistogram, ReportsPercentiles)
+{
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.ValueAtPercentile(50.0), 0);
+    for (std::uint64_t value = 1; value <= 10000; ++value)
+    {
+        histogram.Record(value);
+    }
+    EXPECT_EQ(histogram.GetCount(), 10000);
+    EXPECT_EQ(histogram.GetMin(), 1);
+    EXPECT_EQ(histogram.GetMax(), 10000);
+    EXPECT_DOUBLE_EQ(histogram.GetMean(), 5000.5);
+    EXPECT_EQ(histogram.ValueAtPercentile(0.0), 1);
+    EXPECT_EQ(histogram.ValueAtPercentile(100.0), 10000);
+    for (double percentile : {50.0, 90.0, 99.0, 99.9})
+    {
+        const double exact = percentile * 100.0;
+        EXPECT_NEAR(static_cast<double>(histogram.ValueAtPercentile(percentile)), exact, exact / 64.0);
+    }
+
+    // A heavy tail only moves the top percentiles.
+    LatencyHistogram tail;
+    for (std::size_t i = 0; i < 999; ++i)
+    {
+        tail.Record(100);
+    }
+    tail.Record(1'000'000);
+    EXPECT_EQ(tail.ValueAtPercentile(99.0), 100);
+    EXPECT_EQ(tail.ValueAtPercentile(100.0), 1'000'000);
+    histogram.Merge(tail);
+    EXPECT_EQ(histogram.GetCount(), 11000);
+    EXPECT_EQ(histogram.GetMax(), 1'000'000);
+    histogram.Reset();
+    EXPECT_EQ(histogram.GetCount(), 0);
+    EXPECT_EQ(histogram.GetMax(), 0);
 }
\ No newline at end of file